@@ -0,0 +1,99 @@
+#pragma once
+#include <wrl/client.h>
+#include <d3d11.h>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+using Microsoft::WRL::ComPtr;
+
+// HLSL cbuffer packing: a member starts a new 16-byte register unless it fits in what is left of the current one, and
+// matrices, arrays and structs always start one. A C++ member that satisfies this lands where the shader reads it.
+constexpr bool IsHlslPacked(size_t anOffset, size_t aSize)
+{
+    return anOffset % 16 == 0 || anOffset % 16 + aSize <= 16;
+}
+
+// Checks one member of a constant buffer struct against the packing rules, next to the struct definition
+#define CHECK_HLSL_PACKING(Type, member) \
+    static_assert(IsHlslPacked(offsetof(Type, member), sizeof(Type::member)), #Type "::" #member " straddles a 16-byte register, HLSL would move it")
+
+// Size of a cbuffer holding T, registers are always whole
+template <class T>
+constexpr UINT GetConstantBufferSize() { return static_cast<UINT>((sizeof(T) + 15) & ~size_t(15)); }
+
+// A constant buffer with a CPU copy of its contents. Set() only marks it dirty when the bytes differ from the copy,
+// and Upload() skips the map until something has, so data that rarely changes costs a compare per frame.
+template <class T>
+class ConstantBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Constant buffer contents are copied and compared bytewise");
+    static_assert(alignof(T) <= 16, "Constant buffer contents can't need more than register alignment");
+    static_assert(GetConstantBufferSize<T>() <= D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16, "Larger than a cbuffer can be");
+
+public:
+    bool Init(ID3D11Device* aDevice, const T& someInitialData = T())
+    {
+        myShadow = someInitialData;
+        myIsDirty = false;
+
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.ByteWidth = GetConstantBufferSize<T>();
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        // Starts out with the shadow's contents so nothing has to be uploaded until they change
+        unsigned char initialBytes[GetConstantBufferSize<T>()] = {};
+        std::memcpy(initialBytes, &myShadow, sizeof(T));
+        D3D11_SUBRESOURCE_DATA initialData = {};
+        initialData.pSysMem = initialBytes;
+
+        myBuffer.Reset();
+        return SUCCEEDED(aDevice->CreateBuffer(&bufferDesc, &initialData, &myBuffer));
+    }
+    void Reset() { myBuffer.Reset(); }
+
+    // True when someData differs from what the buffer holds and the next Upload() will write it
+    bool Set(const T& someData)
+    {
+        if (std::memcmp(&someData, &myShadow, sizeof(T)) != 0)
+        {
+            myShadow = someData;
+            myIsDirty = true;
+        }
+        return myIsDirty;
+    }
+    const T& Get() const { return myShadow; }
+
+    // Writes the shadow copy with a discard if it changed since the last upload, false when it didn't
+    bool Upload(ID3D11DeviceContext* aContext)
+    {
+        if (!myIsDirty || !myBuffer)
+        {
+            return false;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        if (FAILED(aContext->Map(myBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+        {
+            return false;
+        }
+        std::memcpy(mappedResource.pData, &myShadow, sizeof(T));
+        aContext->Unmap(myBuffer.Get(), 0);
+
+        myIsDirty = false;
+        ++myUploadCount;
+        return true;
+    }
+
+    ID3D11Buffer* GetBuffer() const { return myBuffer.Get(); }
+    ID3D11Buffer* const* GetAddressOf() const { return myBuffer.GetAddressOf(); }
+    unsigned int GetUploadCount() const { return myUploadCount; }
+
+private:
+    ComPtr<ID3D11Buffer> myBuffer;
+    T myShadow = {};
+    bool myIsDirty = false;
+    unsigned int myUploadCount = 0;
+};
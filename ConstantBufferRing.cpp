@@ -0,0 +1,239 @@
+#include "ConstantBufferRing.h"
+
+#include <iostream>
+
+bool ConstantBufferRing::Init(ID3D11Device* aDevice, ID3D11DeviceContext* aContext, UINT aCapacity)
+{
+    myDevice = aDevice;
+    myContext = aContext;
+    myContext1.Reset();
+
+    // Both have to be there: binding at an offset, and appending to a constant buffer that is still in use
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    const bool hasOptions = SUCCEEDED(aDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)));
+    if (!hasOptions || !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer ||
+        FAILED(myContext.As(&myContext1)))
+    {
+        myContext1.Reset();
+        std::cout << "Constant buffer offsets not supported, constants are uploaded with discard" << std::endl;
+        return true;
+    }
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.ByteWidth = aCapacity & ~(ourAlignment - 1);
+    HRESULT hr = aDevice->CreateBuffer(&bufferDesc, nullptr, &myBuffer);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create constant buffer ring. Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    myAllocator.Init(bufferDesc.ByteWidth, ourAlignment);
+    return true;
+}
+bool ConstantBufferRing::SetConstants(RenderContext& aContext, UINT aSlot, UINT aStages, const void* someData, UINT aSize)
+{
+    if (!SupportsOffsets())
+    {
+        return SetDiscardConstants(aContext, aSlot, aStages, someData, aSize);
+    }
+
+    ConstantRingAllocation allocation;
+    unsigned char* destination = nullptr;
+    if (!MapRange(aSize, allocation, destination))
+    {
+        return false;
+    }
+    std::memcpy(destination, someData, aSize);
+    myContext->Unmap(myBuffer.Get(), 0);
+
+    const UINT constantCount = (aSize + ourAlignment - 1) / ourAlignment * (ourAlignment / ourConstantSize);
+    Bind(aContext, aSlot, aStages, allocation.offset / ourConstantSize, constantCount);
+    return true;
+}
+void ConstantBufferRing::BindBlock(RenderContext& aContext, UINT aSlot, UINT aStages, UINT aBlockIndex)
+{
+    if (!SupportsOffsets())
+    {
+        // Plain bindings go through the filter, consecutive draws of one block don't rebind it
+        if (aStages & ConstantStageVertex)
+        {
+            aContext.VSSetConstantBuffers(aSlot, 1, myBlockBuffers[aBlockIndex].GetAddressOf());
+        }
+        if (aStages & ConstantStagePixel)
+        {
+            aContext.PSSetConstantBuffers(aSlot, 1, myBlockBuffers[aBlockIndex].GetAddressOf());
+        }
+        return;
+    }
+    Bind(aContext, aSlot, aStages, (myBlockOffset + aBlockIndex * myBlockSize) / ourConstantSize, myBlockSize / ourConstantSize);
+}
+void ConstantBufferRing::EndFrame()
+{
+    if (!SupportsOffsets())
+    {
+        return;
+    }
+
+    // The query completes once the GPU has run everything issued before it
+    ++myFrameFence;
+    ComPtr<ID3D11Query> query;
+    if (!myFreeQueries.empty())
+    {
+        query = myFreeQueries.back();
+        myFreeQueries.pop_back();
+    }
+    else
+    {
+        D3D11_QUERY_DESC queryDesc = {};
+        queryDesc.Query = D3D11_QUERY_EVENT;
+        myDevice->CreateQuery(&queryDesc, &query);
+    }
+    if (query)
+    {
+        myContext->End(query.Get());
+        myPendingFrames.push_back({ query, myFrameFence });
+    }
+    myAllocator.EndFrame(myFrameFence);
+
+    // Frames complete in order, stop at the first one that isn't done
+    uint64_t completedFence = 0;
+    size_t completedCount = 0;
+    for (const PendingFrame& frame : myPendingFrames)
+    {
+        BOOL isDone = FALSE;
+        if (myContext->GetData(frame.query.Get(), &isDone, sizeof(isDone), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK || !isDone)
+        {
+            break;
+        }
+        completedFence = frame.fence;
+        ++completedCount;
+    }
+    for (size_t i = 0; i < completedCount; ++i)
+    {
+        myFreeQueries.push_back(myPendingFrames[i].query);
+    }
+    myPendingFrames.erase(myPendingFrames.begin(), myPendingFrames.begin() + completedCount);
+    myAllocator.Retire(completedFence);
+}
+bool ConstantBufferRing::MapRange(UINT aSize, ConstantRingAllocation& anAllocation, unsigned char*& aDestination)
+{
+    if (!myAllocator.Allocate(aSize, anAllocation))
+    {
+        std::cerr << "Constant upload of " << aSize << " bytes doesn't fit the ring" << std::endl;
+        return false;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    if (FAILED(myContext->Map(myBuffer.Get(), 0, anAllocation.isDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource)))
+    {
+        return false;
+    }
+    aDestination = static_cast<unsigned char*>(mappedResource.pData) + anAllocation.offset;
+    return true;
+}
+void ConstantBufferRing::Bind(RenderContext& aContext, UINT aSlot, UINT aStages, UINT aFirstConstant, UINT aConstantCount)
+{
+    // Offset bindings bypass the filter, it has to forget what it had in the slot
+    aContext.ForgetConstantBuffers(aSlot, 1);
+    ID3D11Buffer* buffer = myBuffer.Get();
+    if (aStages & ConstantStageVertex)
+    {
+        myContext1->VSSetConstantBuffers1(aSlot, 1, &buffer, &aFirstConstant, &aConstantCount);
+    }
+    if (aStages & ConstantStagePixel)
+    {
+        myContext1->PSSetConstantBuffers1(aSlot, 1, &buffer, &aFirstConstant, &aConstantCount);
+    }
+}
+bool ConstantBufferRing::SetDiscardConstants(RenderContext& aContext, UINT aSlot, UINT aStages, const void* someData, UINT aSize)
+{
+    if (aSlot >= myDiscardBuffers.size())
+    {
+        myDiscardBuffers.resize(aSlot + 1);
+        myDiscardSizes.resize(aSlot + 1, 0);
+    }
+
+    ComPtr<ID3D11Buffer>& buffer = myDiscardBuffers[aSlot];
+    if (!buffer || myDiscardSizes[aSlot] < aSize)
+    {
+        D3D11_BUFFER_DESC bufferDesc = {};
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bufferDesc.ByteWidth = (aSize + 15) & ~15u;
+        buffer.Reset();
+        if (FAILED(myDevice->CreateBuffer(&bufferDesc, nullptr, &buffer)))
+        {
+            return false;
+        }
+        myDiscardSizes[aSlot] = bufferDesc.ByteWidth;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    if (FAILED(myContext->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+    {
+        return false;
+    }
+    std::memcpy(mappedResource.pData, someData, aSize);
+    myContext->Unmap(buffer.Get(), 0);
+
+    if (aStages & ConstantStageVertex)
+    {
+        aContext.VSSetConstantBuffers(aSlot, 1, buffer.GetAddressOf());
+    }
+    if (aStages & ConstantStagePixel)
+    {
+        aContext.PSSetConstantBuffers(aSlot, 1, buffer.GetAddressOf());
+    }
+    return true;
+}
+bool ConstantBufferRing::ReserveBlockBuffers(UINT aBlockSize, UINT aBlockCount)
+{
+    if (aBlockSize != myBlockSize)
+    {
+        myBlockBuffers.clear();
+        myBlockContents.clear();
+        myBlockScratch.assign(aBlockSize, 0);
+        myBlockSize = aBlockSize;
+    }
+
+    // New buffers start zeroed so their recorded contents are known without an upload
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.ByteWidth = aBlockSize;
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = myBlockScratch.data();
+    std::memset(myBlockScratch.data(), 0, aBlockSize);
+
+    while (myBlockBuffers.size() < aBlockCount)
+    {
+        ComPtr<ID3D11Buffer> buffer;
+        HRESULT hr = myDevice->CreateBuffer(&bufferDesc, &initData, &buffer);
+        if (FAILED(hr))
+        {
+            std::cerr << "Failed to create constant block buffer. Error: " << std::hex << hr << std::endl;
+            return false;
+        }
+        myBlockBuffers.push_back(buffer);
+    }
+    myBlockContents.resize(myBlockBuffers.size() * aBlockSize, 0);
+    return true;
+}
+bool ConstantBufferRing::UploadBlock(UINT aBlockIndex)
+{
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    ID3D11Buffer* buffer = myBlockBuffers[aBlockIndex].Get();
+    if (FAILED(myContext->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+    {
+        return false;
+    }
+    std::memcpy(mappedResource.pData, myBlockContents.data() + static_cast<size_t>(aBlockIndex) * myBlockSize, myBlockSize);
+    myContext->Unmap(buffer, 0);
+    return true;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <wrl/client.h>
+#include <d3d11_1.h>
+#include <cstring>
+#include <vector>
+
+#include "ConstantRingAllocator.h"
+#include "StateFilteringContext.h"
+
+using Microsoft::WRL::ComPtr;
+
+enum ConstantStage : unsigned int
+{
+    ConstantStageVertex = 1 << 0,
+    ConstantStagePixel = 1 << 1
+};
+
+// Per-frame constants out of one large dynamic buffer. Uploads are appended with MAP_WRITE_NO_OVERWRITE and bound
+// at their offset with VSSetConstantBuffers1/PSSetConstantBuffers1, event queries tell when the GPU is done with a
+// frame so its part of the ring can be reused. Devices without D3D11.1 constant buffer offsetting fall back to one
+// WRITE_DISCARD buffer per slot, the way every constant buffer used to be updated, and to one buffer per block.
+class ConstantBufferRing
+{
+public:
+    bool Init(ID3D11Device* aDevice, ID3D11DeviceContext* aContext, UINT aCapacity);
+    bool SupportsOffsets() const { return myContext1 != nullptr; }
+
+    // Copies someData into the ring and binds it to aSlot of aStages
+    bool SetConstants(RenderContext& aContext, UINT aSlot, UINT aStages, const void* someData, UINT aSize);
+
+    // Writes aBlockCount blocks of aBlockSize bytes with one map, aWrite(index, destination) fills each. Binding one
+    // with BindBlock is then all a draw costs. Without offsets each block has a buffer of its own that is kept across
+    // frames, only the blocks whose bytes changed since the last frame are mapped
+    template <class Write>
+    bool WriteBlocks(UINT aBlockSize, UINT aBlockCount, const Write& aWrite);
+    void BindBlock(RenderContext& aContext, UINT aSlot, UINT aStages, UINT aBlockIndex);
+
+    // Closes the frame's allocations behind a query and frees the frames the GPU has finished
+    void EndFrame();
+
+private:
+    static constexpr UINT ourConstantSize = 16;   // One float4, the unit offsets are given in
+    static constexpr UINT ourAlignment = 256;     // Offsets have to be multiples of 16 constants
+
+    struct PendingFrame
+    {
+        ComPtr<ID3D11Query> query;
+        uint64_t fence;
+    };
+
+    bool MapRange(UINT aSize, ConstantRingAllocation& anAllocation, unsigned char*& aDestination);
+    void Bind(RenderContext& aContext, UINT aSlot, UINT aStages, UINT aFirstConstant, UINT aConstantCount);
+    bool SetDiscardConstants(RenderContext& aContext, UINT aSlot, UINT aStages, const void* someData, UINT aSize);
+    bool ReserveBlockBuffers(UINT aBlockSize, UINT aBlockCount);
+    bool UploadBlock(UINT aBlockIndex);
+
+    ComPtr<ID3D11Device> myDevice;
+    ComPtr<ID3D11DeviceContext> myContext;
+    ComPtr<ID3D11DeviceContext1> myContext1;
+    ComPtr<ID3D11Buffer> myBuffer;
+    ConstantRingAllocator myAllocator;
+    std::vector<PendingFrame> myPendingFrames;
+    std::vector<ComPtr<ID3D11Query>> myFreeQueries;
+    uint64_t myFrameFence = 0;
+
+    UINT myBlockOffset = 0;
+    UINT myBlockSize = 0;
+
+    std::vector<ComPtr<ID3D11Buffer>> myDiscardBuffers; // Fallback, one per slot sized for the largest upload
+    std::vector<UINT> myDiscardSizes;
+    std::vector<ComPtr<ID3D11Buffer>> myBlockBuffers;   // Fallback for blocks, one per block index
+    std::vector<unsigned char> myBlockContents;         // What each block buffer holds, to skip unchanged ones
+    std::vector<unsigned char> myBlockScratch;
+};
+
+template <class Write>
+bool ConstantBufferRing::WriteBlocks(UINT aBlockSize, UINT aBlockCount, const Write& aWrite)
+{
+    if (aBlockCount == 0)
+    {
+        return false;
+    }
+
+    if (!SupportsOffsets())
+    {
+        // Static objects record the same constants frame after frame, their buffers are left alone
+        const UINT fallbackBlockSize = (aBlockSize + ourConstantSize - 1) & ~(ourConstantSize - 1);
+        if (!ReserveBlockBuffers(fallbackBlockSize, aBlockCount))
+        {
+            return false;
+        }
+        for (UINT i = 0; i < aBlockCount; ++i)
+        {
+            std::memset(myBlockScratch.data(), 0, fallbackBlockSize);
+            aWrite(i, myBlockScratch.data());
+            unsigned char* contents = myBlockContents.data() + static_cast<size_t>(i) * fallbackBlockSize;
+            if (std::memcmp(contents, myBlockScratch.data(), fallbackBlockSize) != 0)
+            {
+                std::memcpy(contents, myBlockScratch.data(), fallbackBlockSize);
+                if (!UploadBlock(i))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const UINT blockSize = (aBlockSize + ourAlignment - 1) & ~(ourAlignment - 1);
+    ConstantRingAllocation allocation;
+    unsigned char* destination = nullptr;
+    if (!MapRange(blockSize * aBlockCount, allocation, destination))
+    {
+        return false;
+    }
+    for (UINT i = 0; i < aBlockCount; ++i)
+    {
+        aWrite(i, destination + i * blockSize);
+    }
+    myContext->Unmap(myBuffer.Get(), 0);
+
+    myBlockOffset = allocation.offset;
+    myBlockSize = blockSize;
+    return true;
+}
@@ -0,0 +1,68 @@
+#include "ConstantRingAllocator.h"
+
+void ConstantRingAllocator::Init(uint32_t aCapacity, uint32_t anAlignment)
+{
+    myAlignment = anAlignment;
+    myCapacity = aCapacity & ~(anAlignment - 1);
+    myFrames.clear();
+    myHead = 0;
+    myUsedBytes = 0;
+    myFrameBytes = 0;
+    myDiscardCount = 0;
+    myNeedsDiscard = true;
+}
+
+bool ConstantRingAllocator::Allocate(uint32_t aSize, ConstantRingAllocation& anAllocation)
+{
+    const uint32_t size = Align(aSize);
+    if (size == 0 || size > myCapacity)
+    {
+        return false;
+    }
+
+    // Allocations never straddle the end, the tail of the ring is skipped and counted as used
+    uint32_t offset = myHead;
+    uint32_t skipped = 0;
+    if (offset + size > myCapacity)
+    {
+        skipped = myCapacity - offset;
+        offset = 0;
+    }
+
+    anAllocation.isDiscard = myNeedsDiscard || myUsedBytes + skipped + size > myCapacity;
+    if (anAllocation.isDiscard)
+    {
+        // Everything written so far, this frame's allocations included, went to the memory the discard replaces
+        myDiscardCount += myNeedsDiscard ? 0 : 1;
+        myNeedsDiscard = false;
+        myFrames.clear();
+        myUsedBytes = 0;
+        myFrameBytes = 0;
+        offset = 0;
+        skipped = 0;
+    }
+
+    anAllocation.offset = offset;
+    myHead = offset + size;
+    myUsedBytes += skipped + size;
+    myFrameBytes += skipped + size;
+    return true;
+}
+
+void ConstantRingAllocator::EndFrame(uint64_t aFence)
+{
+    if (myFrameBytes > 0)
+    {
+        myFrames.push_back({ aFence, myFrameBytes });
+        myFrameBytes = 0;
+    }
+}
+
+void ConstantRingAllocator::Retire(uint64_t aCompletedFence)
+{
+    while (!myFrames.empty() && myFrames.front().fence <= aCompletedFence)
+    {
+        myUsedBytes -= myFrames.front().byteCount;
+        myFrames.pop_front();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Offsets handed out by ConstantRingAllocator::Allocate
+struct ConstantRingAllocation
+{
+    uint32_t offset = 0;
+    bool isDiscard = false; // Map this one with WRITE_DISCARD, the earlier contents may still be in use
+};
+
+// Sub-allocates one ring buffer front to back for constants that live for a frame. Each frame is closed with the
+// fence value the GPU signals when it is done with it, and its bytes come back once that fence is retired. When an
+// allocation doesn't fit next to the frames still in flight, the whole ring is discarded and allocation restarts at
+// zero: the driver gives the buffer fresh memory, so nothing the GPU reads gets overwritten either way.
+// Pure bookkeeping, the GPU side lives in ConstantBufferRing.
+class ConstantRingAllocator
+{
+public:
+    // anAlignment has to be a power of two, 256 bytes for constant buffer offsets
+    void Init(uint32_t aCapacity, uint32_t anAlignment);
+
+    // False only when aSize is larger than the whole ring
+    bool Allocate(uint32_t aSize, ConstantRingAllocation& anAllocation);
+    // Closes the current frame, its allocations are in use until aFence is retired
+    void EndFrame(uint64_t aFence);
+    // Frees every frame whose fence is aCompletedFence or older
+    void Retire(uint64_t aCompletedFence);
+
+    uint32_t GetCapacity() const { return myCapacity; }
+    uint32_t GetUsedBytes() const { return myUsedBytes; }
+    size_t GetFramesInFlight() const { return myFrames.size(); }
+    unsigned int GetDiscardCount() const { return myDiscardCount; }
+
+private:
+    struct Frame
+    {
+        uint64_t fence;
+        uint32_t byteCount; // Including the padding skipped at the end when it wrapped
+    };
+
+    uint32_t Align(uint32_t aSize) const { return (aSize + myAlignment - 1) & ~(myAlignment - 1); }
+
+    std::deque<Frame> myFrames;
+    uint32_t myCapacity = 0;
+    uint32_t myAlignment = 256;
+    uint32_t myHead = 0;
+    uint32_t myUsedBytes = 0;       // From the oldest frame in flight up to myHead
+    uint32_t myFrameBytes = 0;      // Allocated by the frame that isn't closed yet
+    unsigned int myDiscardCount = 0;
+    bool myNeedsDiscard = true;     // Dynamic buffers start with a discard
+};
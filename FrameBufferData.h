@@ -1,5 +1,6 @@
 #pragma once
 #include "Includes/Matrix4x4.h"
+#include "ConstantBuffer.h"
 
 struct FrameBufferData
 {
@@ -13,5 +14,14 @@ struct FrameBufferData
 
 	CommonUtilities::Vector2<float> resolution;
 	float waterHeight;
-	float padding;
-};
\ No newline at end of file
+	float hasTerrainNormals; // 1 when the baked terrain normal map is bound, a flat texel can't tell
+};
+CHECK_HLSL_PACKING(FrameBufferData, worldToCamera);
+CHECK_HLSL_PACKING(FrameBufferData, cameraToProjection);
+CHECK_HLSL_PACKING(FrameBufferData, worldToClip);
+CHECK_HLSL_PACKING(FrameBufferData, worldToClipReflected);
+CHECK_HLSL_PACKING(FrameBufferData, cameraPosition);
+CHECK_HLSL_PACKING(FrameBufferData, time);
+CHECK_HLSL_PACKING(FrameBufferData, resolution);
+CHECK_HLSL_PACKING(FrameBufferData, waterHeight);
+CHECK_HLSL_PACKING(FrameBufferData, hasTerrainNormals);
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <iostream>
+
+FrameGraphResource FrameGraphPassBuilder::Create(const std::string& aName, const FrameGraphTextureDesc& aDesc)
+{
+    FrameGraph::Resource resource;
+    resource.name = aName;
+    resource.desc = aDesc;
+    myGraph.myResources.push_back(resource);
+    return Write(static_cast<FrameGraphResource>(myGraph.myResources.size() - 1));
+}
+FrameGraphResource FrameGraphPassBuilder::Read(FrameGraphResource aResource)
+{
+    myGraph.myPasses[myPass].reads.push_back(aResource);
+    return aResource;
+}
+FrameGraphResource FrameGraphPassBuilder::Write(FrameGraphResource aResource)
+{
+    myGraph.myPasses[myPass].writes.push_back(aResource);
+    myGraph.myResources[aResource].writers.push_back(myPass);
+    return aResource;
+}
+void FrameGraphPassBuilder::SetExecute(std::function<void()> anExecute)
+{
+    myGraph.myPasses[myPass].execute = std::move(anExecute);
+}
+
+void FrameGraph::Reset()
+{
+    myPasses.clear();
+    myResources.clear();
+    myPhysicalTextures.clear();
+}
+FrameGraphResource FrameGraph::ImportTexture(const std::string& aName)
+{
+    Resource resource;
+    resource.name = aName;
+    resource.isImported = true;
+    myResources.push_back(resource);
+    return static_cast<FrameGraphResource>(myResources.size() - 1);
+}
+FrameGraphPassBuilder FrameGraph::AddPass(const std::string& aName)
+{
+    Pass pass;
+    pass.name = aName;
+    myPasses.push_back(pass);
+    return FrameGraphPassBuilder(*this, static_cast<uint32_t>(myPasses.size() - 1));
+}
+bool FrameGraph::Compile()
+{
+    // Passes run in declaration order, so a transient texture has to be written before anything reads it
+    std::vector<bool> isWritten(myResources.size(), false);
+    for (const Pass& pass : myPasses)
+    {
+        for (FrameGraphResource read : pass.reads)
+        {
+            if (!myResources[read].isImported && !isWritten[read])
+            {
+                std::cerr << "Frame graph pass " << pass.name << " reads " << myResources[read].name << " before anything writes it" << std::endl;
+                return false;
+            }
+        }
+        for (FrameGraphResource write : pass.writes)
+        {
+            isWritten[write] = true;
+        }
+    }
+
+    for (Resource& resource : myResources)
+    {
+        resource.refCount = 0;
+        resource.firstUse = UINT32_MAX;
+        resource.lastUse = 0;
+        resource.physicalTexture = locNoPhysicalTexture;
+    }
+    myPhysicalTextures.clear();
+
+    CullPasses();
+    AssignPhysicalTextures();
+    return true;
+}
+void FrameGraph::Execute() const
+{
+    for (const Pass& pass : myPasses)
+    {
+        if (!pass.isCulled && pass.execute)
+        {
+            pass.execute();
+        }
+    }
+}
+size_t FrameGraph::GetCulledPassCount() const
+{
+    return static_cast<size_t>(std::count_if(myPasses.begin(), myPasses.end(), [](const Pass& aPass) { return aPass.isCulled; }));
+}
+void FrameGraph::CullPasses()
+{
+    // A pass is referenced once per texture it writes and a texture once per pass reading it. Unread textures drop
+    // the reference they hold on their writers, writers left without any drop theirs on what they read, and so on
+    for (Pass& pass : myPasses)
+    {
+        pass.refCount = static_cast<uint32_t>(pass.writes.size());
+        pass.isCulled = false;
+        pass.hasSideEffects = std::any_of(pass.writes.begin(), pass.writes.end(),
+            [this](FrameGraphResource aResource) { return myResources[aResource].isImported; });
+        for (FrameGraphResource read : pass.reads)
+        {
+            ++myResources[read].refCount;
+        }
+    }
+
+    std::vector<FrameGraphResource> unreferenced;
+    for (FrameGraphResource resource = 0; resource < myResources.size(); ++resource)
+    {
+        if (myResources[resource].refCount == 0 && !myResources[resource].isImported)
+        {
+            unreferenced.push_back(resource);
+        }
+    }
+
+    while (!unreferenced.empty())
+    {
+        const FrameGraphResource resource = unreferenced.back();
+        unreferenced.pop_back();
+        for (uint32_t writer : myResources[resource].writers)
+        {
+            Pass& pass = myPasses[writer];
+            if (pass.refCount == 0 || --pass.refCount > 0 || pass.hasSideEffects)
+            {
+                continue;
+            }
+
+            pass.isCulled = true;
+            for (FrameGraphResource read : pass.reads)
+            {
+                if (--myResources[read].refCount == 0 && !myResources[read].isImported)
+                {
+                    unreferenced.push_back(read);
+                }
+            }
+        }
+    }
+}
+void FrameGraph::AssignPhysicalTextures()
+{
+    for (uint32_t passIndex = 0; passIndex < myPasses.size(); ++passIndex)
+    {
+        const Pass& pass = myPasses[passIndex];
+        if (pass.isCulled)
+        {
+            continue;
+        }
+        for (const std::vector<FrameGraphResource>* uses : { &pass.reads, &pass.writes })
+        {
+            for (FrameGraphResource used : *uses)
+            {
+                Resource& resource = myResources[used];
+                resource.firstUse = std::min(resource.firstUse, passIndex);
+                resource.lastUse = std::max(resource.lastUse, passIndex);
+            }
+        }
+    }
+
+    // Textures come up in the order their first user runs, each takes the first physical texture with its desc
+    // whose previous owner is done by then
+    std::vector<uint32_t> physicalLastUse;
+    for (uint32_t passIndex = 0; passIndex < myPasses.size(); ++passIndex)
+    {
+        for (Resource& resource : myResources)
+        {
+            if (resource.isImported || resource.firstUse != passIndex)
+            {
+                continue;
+            }
+
+            uint32_t physical = 0;
+            while (physical < myPhysicalTextures.size() &&
+                (myPhysicalTextures[physical] != resource.desc || physicalLastUse[physical] >= passIndex))
+            {
+                ++physical;
+            }
+            if (physical == myPhysicalTextures.size())
+            {
+                myPhysicalTextures.push_back(resource.desc);
+                physicalLastUse.push_back(0);
+            }
+            resource.physicalTexture = physical;
+            physicalLastUse[physical] = resource.lastUse;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Handle to a virtual texture of one frame's graph
+using FrameGraphResource = uint32_t;
+constexpr uint32_t locNoPhysicalTexture = UINT32_MAX;
+
+enum FrameGraphTextureUsage : uint32_t
+{
+    FrameGraphUsageRenderTarget = 1 << 0,
+    FrameGraphUsageDepthStencil = 1 << 1,
+    FrameGraphUsageShaderResource = 1 << 2
+};
+
+// Transient textures with equal descs can share memory when their lifetimes don't overlap
+struct FrameGraphTextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;    // DXGI_FORMAT, kept as a number so the graph builds without D3D
+    uint32_t usage = 0;     // FrameGraphTextureUsage flags
+
+    bool operator==(const FrameGraphTextureDesc& anOther) const
+    {
+        return width == anOther.width && height == anOther.height && format == anOther.format && usage == anOther.usage;
+    }
+    bool operator!=(const FrameGraphTextureDesc& anOther) const { return !(*this == anOther); }
+};
+
+class FrameGraph;
+
+// Declares what one pass reads and writes, returned by FrameGraph::AddPass
+class FrameGraphPassBuilder
+{
+public:
+    FrameGraphPassBuilder(FrameGraph& aGraph, uint32_t aPass) : myGraph(aGraph), myPass(aPass) {}
+
+    // A transient texture this pass writes first
+    FrameGraphResource Create(const std::string& aName, const FrameGraphTextureDesc& aDesc);
+    FrameGraphResource Read(FrameGraphResource aResource);
+    FrameGraphResource Write(FrameGraphResource aResource);
+    void SetExecute(std::function<void()> anExecute);
+
+private:
+    FrameGraph& myGraph;
+    uint32_t myPass;
+};
+
+// Passes are declared in the order they run, each with the virtual textures it reads and writes. Compile() culls
+// passes nothing downstream reads, then packs the transient textures of the remaining ones into as few physical
+// textures as lifetimes allow: a texture whose last reader has run hands its memory to the next one with the same
+// desc. Imported textures (the back buffer) live outside the graph and writing one keeps a pass alive.
+// Only bookkeeping, a FrameGraphTexturePool turns GetPhysicalTextures() into D3D textures.
+class FrameGraph
+{
+public:
+    // Forgets every pass and resource, the graph is declared again each frame
+    void Reset();
+
+    FrameGraphResource ImportTexture(const std::string& aName);
+    FrameGraphPassBuilder AddPass(const std::string& aName);
+
+    // False when a pass reads a transient texture no earlier pass wrote
+    bool Compile();
+    // Runs the passes that weren't culled, in declaration order
+    void Execute() const;
+
+    size_t GetPassCount() const { return myPasses.size(); }
+    const std::string& GetPassName(uint32_t aPass) const { return myPasses[aPass].name; }
+    bool IsPassCulled(uint32_t aPass) const { return myPasses[aPass].isCulled; }
+    size_t GetCulledPassCount() const;
+
+    size_t GetResourceCount() const { return myResources.size(); }
+    // Index into GetPhysicalTextures(), locNoPhysicalTexture for imported and unused textures
+    uint32_t GetPhysicalTexture(FrameGraphResource aResource) const { return myResources[aResource].physicalTexture; }
+    const std::vector<FrameGraphTextureDesc>& GetPhysicalTextures() const { return myPhysicalTextures; }
+
+private:
+    friend class FrameGraphPassBuilder;
+
+    struct Pass
+    {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<FrameGraphResource> reads;
+        std::vector<FrameGraphResource> writes;
+        uint32_t refCount = 0;
+        bool hasSideEffects = false; // Writes an imported texture
+        bool isCulled = false;
+    };
+    struct Resource
+    {
+        std::string name;
+        FrameGraphTextureDesc desc;
+        bool isImported = false;
+        std::vector<uint32_t> writers;
+        uint32_t refCount = 0;
+        uint32_t firstUse = UINT32_MAX;
+        uint32_t lastUse = 0;
+        uint32_t physicalTexture = locNoPhysicalTexture;
+    };
+
+    void CullPasses();
+    void AssignPhysicalTextures();
+
+    std::vector<Pass> myPasses;
+    std::vector<Resource> myResources;
+    std::vector<FrameGraphTextureDesc> myPhysicalTextures;
+};
@@ -0,0 +1,104 @@
+#include "FrameGraphTexturePool.h"
+
+#include <iostream>
+
+namespace
+{
+    // Depth that is also sampled needs a typeless texture with a depth view and a color view onto it
+    struct DepthFormats
+    {
+        DXGI_FORMAT texture;
+        DXGI_FORMAT shaderResource;
+    };
+    bool GetSampledDepthFormats(DXGI_FORMAT aDepthFormat, DepthFormats& someFormats)
+    {
+        switch (aDepthFormat)
+        {
+        case DXGI_FORMAT_D32_FLOAT:
+            someFormats = { DXGI_FORMAT_R32_TYPELESS, DXGI_FORMAT_R32_FLOAT };
+            return true;
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+            someFormats = { DXGI_FORMAT_R24G8_TYPELESS, DXGI_FORMAT_R24_UNORM_X8_TYPELESS };
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+bool FrameGraphTexturePool::Realize(ID3D11Device* aDevice, const std::vector<FrameGraphTextureDesc>& someDescs)
+{
+    myTextures.resize(someDescs.size());
+    for (size_t i = 0; i < someDescs.size(); ++i)
+    {
+        Texture& texture = myTextures[i];
+        if (texture.texture && texture.desc == someDescs[i])
+        {
+            continue;
+        }
+
+        texture = Texture();
+        if (!Create(aDevice, someDescs[i], texture))
+        {
+            texture = Texture();
+            return false;
+        }
+    }
+    return true;
+}
+bool FrameGraphTexturePool::Create(ID3D11Device* aDevice, const FrameGraphTextureDesc& aDesc, Texture& aTexture) const
+{
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = aDesc.width;
+    textureDesc.Height = aDesc.height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = static_cast<DXGI_FORMAT>(aDesc.format);
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.BindFlags =
+        ((aDesc.usage & FrameGraphUsageRenderTarget) ? D3D11_BIND_RENDER_TARGET : 0) |
+        ((aDesc.usage & FrameGraphUsageDepthStencil) ? D3D11_BIND_DEPTH_STENCIL : 0) |
+        ((aDesc.usage & FrameGraphUsageShaderResource) ? D3D11_BIND_SHADER_RESOURCE : 0);
+
+    const bool isSampledDepth = (aDesc.usage & FrameGraphUsageDepthStencil) && (aDesc.usage & FrameGraphUsageShaderResource);
+    DepthFormats depthFormats = {};
+    if (isSampledDepth)
+    {
+        if (!GetSampledDepthFormats(textureDesc.Format, depthFormats))
+        {
+            std::cerr << "Depth format " << aDesc.format << " can't be sampled" << std::endl;
+            return false;
+        }
+        textureDesc.Format = depthFormats.texture;
+    }
+
+    HRESULT hr = aDevice->CreateTexture2D(&textureDesc, nullptr, &aTexture.texture);
+    if (SUCCEEDED(hr) && (aDesc.usage & FrameGraphUsageRenderTarget))
+    {
+        hr = aDevice->CreateRenderTargetView(aTexture.texture.Get(), nullptr, &aTexture.renderTarget);
+    }
+    if (SUCCEEDED(hr) && (aDesc.usage & FrameGraphUsageDepthStencil))
+    {
+        D3D11_DEPTH_STENCIL_VIEW_DESC depthDesc = {};
+        depthDesc.Format = static_cast<DXGI_FORMAT>(aDesc.format);
+        depthDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+        hr = aDevice->CreateDepthStencilView(aTexture.texture.Get(), &depthDesc, &aTexture.depthStencil);
+    }
+    if (SUCCEEDED(hr) && (aDesc.usage & FrameGraphUsageShaderResource))
+    {
+        D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceDesc = {};
+        shaderResourceDesc.Format = isSampledDepth ? depthFormats.shaderResource : textureDesc.Format;
+        shaderResourceDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        shaderResourceDesc.Texture2D.MipLevels = 1;
+        hr = aDevice->CreateShaderResourceView(aTexture.texture.Get(), &shaderResourceDesc, &aTexture.shaderResource);
+    }
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create frame graph texture " << aDesc.width << "x" << aDesc.height << ". Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    aTexture.desc = aDesc;
+    return true;
+}
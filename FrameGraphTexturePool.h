@@ -0,0 +1,37 @@
+#pragma once
+#include <wrl/client.h>
+#include <d3d11.h>
+#include <vector>
+
+#include "FrameGraph.h"
+
+using Microsoft::WRL::ComPtr;
+
+// The D3D textures behind a compiled FrameGraph's physical textures. Kept from frame to frame, a slot is only
+// recreated when the desc the graph packed into it changes (resize, quality settings).
+class FrameGraphTexturePool
+{
+public:
+    bool Realize(ID3D11Device* aDevice, const std::vector<FrameGraphTextureDesc>& someDescs);
+    void Reset() { myTextures.clear(); }
+
+    ID3D11RenderTargetView* GetRenderTarget(uint32_t aPhysicalTexture) const { return myTextures[aPhysicalTexture].renderTarget.Get(); }
+    ID3D11DepthStencilView* GetDepthStencil(uint32_t aPhysicalTexture) const { return myTextures[aPhysicalTexture].depthStencil.Get(); }
+    ID3D11ShaderResourceView* GetShaderResource(uint32_t aPhysicalTexture) const { return myTextures[aPhysicalTexture].shaderResource.Get(); }
+    const FrameGraphTextureDesc& GetDesc(uint32_t aPhysicalTexture) const { return myTextures[aPhysicalTexture].desc; }
+    size_t GetTextureCount() const { return myTextures.size(); }
+
+private:
+    struct Texture
+    {
+        FrameGraphTextureDesc desc;
+        ComPtr<ID3D11Texture2D> texture;
+        ComPtr<ID3D11RenderTargetView> renderTarget;
+        ComPtr<ID3D11DepthStencilView> depthStencil;
+        ComPtr<ID3D11ShaderResourceView> shaderResource;
+    };
+
+    bool Create(ID3D11Device* aDevice, const FrameGraphTextureDesc& aDesc, Texture& aTexture) const;
+
+    std::vector<Texture> myTextures;
+};
@@ -0,0 +1,89 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+namespace
+{
+    // Column aColumn of a row vector matrix, the clip coordinate it produces
+    CommonUtilities::Vector4<float> GetColumn(const CommonUtilities::Matrix4x4<float>& aMatrix, int aColumn)
+    {
+        return CommonUtilities::Vector4<float>(aMatrix(1, aColumn), aMatrix(2, aColumn), aMatrix(3, aColumn), aMatrix(4, aColumn));
+    }
+
+    FrustumPlane MakePlane(const CommonUtilities::Vector4<float>& aPlane)
+    {
+        const float length = std::sqrt(aPlane.x * aPlane.x + aPlane.y * aPlane.y + aPlane.z * aPlane.z);
+        FrustumPlane plane;
+        plane.normal = CommonUtilities::Vector3<float>(aPlane.x / length, aPlane.y / length, aPlane.z / length);
+        plane.distance = aPlane.w / length;
+        return plane;
+    }
+
+    float Sign(float aValue)
+    {
+        return aValue > 0.0f ? 1.0f : (aValue < 0.0f ? -1.0f : 0.0f);
+    }
+}
+
+Frustum Frustum::FromWorldToClip(const CommonUtilities::Matrix4x4<float>& aWorldToClip)
+{
+    // Inside is -w <= x <= w, -w <= y <= w and 0 <= z <= w
+    const CommonUtilities::Vector4<float> x = GetColumn(aWorldToClip, 1);
+    const CommonUtilities::Vector4<float> y = GetColumn(aWorldToClip, 2);
+    const CommonUtilities::Vector4<float> z = GetColumn(aWorldToClip, 3);
+    const CommonUtilities::Vector4<float> w = GetColumn(aWorldToClip, 4);
+
+    Frustum frustum;
+    frustum.myPlanes[Left] = MakePlane(w + x);
+    frustum.myPlanes[Right] = MakePlane(w - x);
+    frustum.myPlanes[Bottom] = MakePlane(w + y);
+    frustum.myPlanes[Top] = MakePlane(w - y);
+    frustum.myPlanes[Near] = MakePlane(z);
+    frustum.myPlanes[Far] = MakePlane(w - z);
+    return frustum;
+}
+bool Frustum::IntersectsSphere(const CommonUtilities::Vector3<float>& aCenter, float aRadius) const
+{
+    for (const FrustumPlane& plane : myPlanes)
+    {
+        if (plane.GetSignedDistance(aCenter) < -aRadius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+CommonUtilities::Vector4<float> TransformPlaneToView(const CommonUtilities::Vector4<float>& aWorldPlane, const CommonUtilities::Matrix4x4<float>& aWorldToView)
+{
+    // A view point p is the world point p * viewToWorld, so the plane in view space is viewToWorld * plane
+    const CommonUtilities::Matrix4x4<float> viewToWorld = CommonUtilities::Matrix4x4<float>::GetFastInverse(aWorldToView);
+    const float plane[4] = { aWorldPlane.x, aWorldPlane.y, aWorldPlane.z, aWorldPlane.w };
+    float result[4] = {};
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result[row] += viewToWorld(row + 1, column + 1) * plane[column];
+        }
+    }
+    return CommonUtilities::Vector4<float>(result[0], result[1], result[2], result[3]);
+}
+CommonUtilities::Matrix4x4<float> MakeObliqueProjection(const CommonUtilities::Matrix4x4<float>& aProjection, const CommonUtilities::Vector4<float>& aViewPlane)
+{
+    // The view space corner of the frustum opposite the plane, in clip space (sign x, sign y, 1, 1)
+    const float cornerX = Sign(aViewPlane.x) / aProjection(1, 1);
+    const float cornerY = Sign(aViewPlane.y) / aProjection(2, 2);
+    const float cornerZ = 1.0f;
+    const float cornerW = (1.0f - aProjection(3, 3)) / aProjection(4, 3);
+
+    // Clip z becomes the scaled plane, the scale puts that corner on the new far plane (z = w)
+    const float scale = cornerZ / (aViewPlane.x * cornerX + aViewPlane.y * cornerY + aViewPlane.z * cornerZ + aViewPlane.w * cornerW);
+
+    CommonUtilities::Matrix4x4<float> projection = aProjection;
+    projection(1, 3) = aViewPlane.x * scale;
+    projection(2, 3) = aViewPlane.y * scale;
+    projection(3, 3) = aViewPlane.z * scale;
+    projection(4, 3) = aViewPlane.w * scale;
+    return projection;
+}
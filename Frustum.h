@@ -0,0 +1,42 @@
+#pragma once
+#include "Includes/Matrix4x4.h"
+#include "Includes/MeehanVector3.hpp"
+#include "Includes/MeehanVector4.hpp"
+
+// normal . p + distance, positive on the side that is kept
+struct FrustumPlane
+{
+    CommonUtilities::Vector3<float> normal;
+    float distance = 0.0f;
+
+    float GetSignedDistance(const CommonUtilities::Vector3<float>& aPoint) const
+    {
+        return normal.x * aPoint.x + normal.y * aPoint.y + normal.z * aPoint.z + distance;
+    }
+};
+
+// The six planes of a view, taken from its world to clip matrix so whatever the projection clips (an oblique near
+// plane included) is what gets culled
+class Frustum
+{
+public:
+    enum Side { Left, Right, Bottom, Top, Near, Far, SideCount };
+
+    // aWorldToClip multiplies row vectors and maps depth to [0, 1] like D3D
+    static Frustum FromWorldToClip(const CommonUtilities::Matrix4x4<float>& aWorldToClip);
+
+    // Conservative, spheres near a corner can pass without touching the frustum
+    bool IntersectsSphere(const CommonUtilities::Vector3<float>& aCenter, float aRadius) const;
+    const FrustumPlane& GetPlane(Side aSide) const { return myPlanes[aSide]; }
+
+private:
+    FrustumPlane myPlanes[SideCount];
+};
+
+// aWorldPlane as (normal, distance) moved into the space of aWorldToView, which has to be orthonormal (mirrored is fine)
+CommonUtilities::Vector4<float> TransformPlaneToView(const CommonUtilities::Vector4<float>& aWorldPlane, const CommonUtilities::Matrix4x4<float>& aWorldToView);
+
+// Swaps the near plane of a D3D perspective projection for aViewPlane (view space, the positive side is kept) so the
+// rasterizer clips against it. The far plane is tilted as little as possible to keep depth precision [Lengyel 2005].
+// The camera has to be on the negative side of the plane
+CommonUtilities::Matrix4x4<float> MakeObliqueProjection(const CommonUtilities::Matrix4x4<float>& aProjection, const CommonUtilities::Vector4<float>& aViewPlane);
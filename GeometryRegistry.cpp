@@ -0,0 +1,321 @@
+#include "GeometryRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static_assert(MeshElementFloat2 == DXGI_FORMAT_R32G32_FLOAT && MeshElementFloat3 == DXGI_FORMAT_R32G32B32_FLOAT &&
+    MeshElementFloat4 == DXGI_FORMAT_R32G32B32A32_FLOAT && MeshElementUnorm16x4 == DXGI_FORMAT_R16G16B16A16_UNORM &&
+    MeshElementUnorm1010102 == DXGI_FORMAT_R10G10B10A2_UNORM && MeshElementUnorm8x4 == DXGI_FORMAT_R8G8B8A8_UNORM &&
+    MeshElementHalf2 == DXGI_FORMAT_R16G16_FLOAT, "Mesh file formats are stored as their DXGI values");
+
+namespace
+{
+    // FNV-1a over the uploaded data, enough to tell meshes apart within one run
+    std::string HashGeometry(const std::vector<unsigned char>& someVertexBytes, UINT aStride, const std::vector<UINT>& someIndices)
+    {
+        unsigned long long hash = 14695981039346656037ull;
+        auto addBytes = [&hash](const void* someData, size_t aSize)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(someData);
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        addBytes(someVertexBytes.data(), someVertexBytes.size());
+        addBytes(someIndices.data(), someIndices.size() * sizeof(UINT));
+        return "Hash:" + std::to_string(hash) + ":" + std::to_string(aStride) + ":" + std::to_string(someIndices.size());
+    }
+
+    // Shaders are cached per path and layout, the same file can be fed by more than one format
+    std::string GetVertexShaderKey(const std::string& aPath, const VertexFormatDesc& aFormat, bool anIsInstanced)
+    {
+        std::string key = aPath;
+        for (UINT i = 0; i < aFormat.elementCount; ++i)
+        {
+            const D3D11_INPUT_ELEMENT_DESC& element = aFormat.elements[i];
+            key += "|" + std::string(element.SemanticName) + std::to_string(element.SemanticIndex) + ":" + std::to_string(element.Format) +
+                "@" + std::to_string(element.AlignedByteOffset);
+        }
+        return anIsInstanced ? key + "|Instanced" : key;
+    }
+
+    bool ReadShaderFile(const std::string& aPath, std::string& someData)
+    {
+        std::ifstream file(aPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        someData = { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        return true;
+    }
+}
+
+bool GeometryRegistry::Init(ID3D11Device* aDevice)
+{
+    myDevice = aDevice;
+    return myDevice != nullptr;
+}
+
+std::shared_ptr<const SharedGeometry> GeometryRegistry::Find(const std::string& aKey)
+{
+    auto it = myGeometries.find(aKey);
+    if (aKey.empty() || it == myGeometries.end())
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<const SharedGeometry> geometry = it->second.lock();
+    if (geometry)
+    {
+        ++myRequestCount;
+        ++mySharedRequestCount;
+        mySavedBytes += geometry->byteSize;
+    }
+    return geometry;
+}
+
+std::shared_ptr<const SharedGeometry> GeometryRegistry::Acquire(const std::string& aKey, const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices,
+    const VertexFormatDesc& aFormat, const std::vector<MeshLod>& someLods)
+{
+    std::vector<unsigned char> vertexBytes;
+    const PositionQuantization quantization = aFormat.pack(someVertices, vertexBytes);
+
+    const std::string key = aKey.empty() ? HashGeometry(vertexBytes, aFormat.stride, someIndices) : aKey;
+    if (std::shared_ptr<const SharedGeometry> existing = Find(key))
+    {
+        return existing;
+    }
+
+    ++myRequestCount;
+    auto geometry = std::make_shared<SharedGeometry>();
+
+    // Levels add baseVertex on the GPU, 16 bit indices only have to reach the largest index any level uses
+    const UINT maxIndex = someIndices.empty() ? 0 : *std::max_element(someIndices.begin(), someIndices.end());
+    if (maxIndex <= 0xFFFF)
+    {
+        const std::vector<uint16_t> shortIndices(someIndices.begin(), someIndices.end());
+        geometry->indexFormat = DXGI_FORMAT_R16_UINT;
+        if (!CreateGeometryBuffers(*geometry, vertexBytes.data(), vertexBytes.size(), shortIndices.data(), sizeof(uint16_t) * shortIndices.size()))
+        {
+            return nullptr;
+        }
+    }
+    else if (!CreateGeometryBuffers(*geometry, vertexBytes.data(), vertexBytes.size(), someIndices.data(), sizeof(UINT) * someIndices.size()))
+    {
+        return nullptr;
+    }
+
+    geometry->vertexCount = static_cast<unsigned int>(someVertices.size());
+    geometry->indexCount = static_cast<unsigned int>(someIndices.size());
+    geometry->vertexStride = aFormat.stride;
+    geometry->vertexFormat = aFormat;
+    geometry->positionQuantization = quantization;
+    geometry->lods = someLods;
+    if (geometry->lods.empty())
+    {
+        MeshLod wholeMesh;
+        wholeMesh.indexCount = geometry->indexCount;
+        geometry->lods.push_back(wholeMesh);
+    }
+    for (const Vertex& vertex : someVertices)
+    {
+        geometry->boundingRadius = std::max(geometry->boundingRadius, std::sqrt(vertex.x * vertex.x + vertex.y * vertex.y + vertex.z * vertex.z));
+    }
+
+    myGeometries[key] = geometry;
+    return geometry;
+}
+
+std::shared_ptr<const SharedGeometry> GeometryRegistry::AcquireFile(const std::string& aPath)
+{
+    const std::string key = "File:" + aPath;
+    if (std::shared_ptr<const SharedGeometry> existing = Find(key))
+    {
+        return existing;
+    }
+
+    MappedMeshFile file;
+    if (!file.Open(aPath))
+    {
+        return nullptr;
+    }
+
+    ++myRequestCount;
+    auto geometry = std::make_shared<SharedGeometry>();
+
+    // The driver copies out of the mapped pages, the file is unmapped again when this returns
+    if (!CreateGeometryBuffers(*geometry, file.GetVertexData(), file.GetVertexDataSize(), file.GetIndexData(), file.GetIndexDataSize()))
+    {
+        return nullptr;
+    }
+
+    const MeshFileHeader& header = file.GetHeader();
+    geometry->vertexCount = header.vertexCount;
+    geometry->indexCount = header.indexCount;
+    geometry->vertexStride = header.vertexStride;
+    geometry->indexFormat = header.indexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    geometry->boundingRadius = header.boundingRadius;
+
+    geometry->fileElements.assign(file.GetElements(), file.GetElements() + header.elementCount);
+    for (const MeshFileElement& element : geometry->fileElements)
+    {
+        geometry->fileLayout.push_back({ element.semantic, element.semanticIndex, static_cast<DXGI_FORMAT>(element.format), 0, element.offset,
+            D3D11_INPUT_PER_VERTEX_DATA, 0 });
+
+        // The converter quantizes to the bounds it writes into the header
+        if (std::strcmp(element.semantic, "POSITION") == 0 && element.format == MeshElementUnorm16x4)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float extent = header.boundsMax[axis] - header.boundsMin[axis];
+                geometry->positionQuantization.offset[axis] = header.boundsMin[axis];
+                geometry->positionQuantization.scale[axis] = extent > 0.0f ? extent : 1.0f;
+            }
+        }
+    }
+    geometry->vertexFormat = { geometry->fileLayout.data(), header.elementCount, header.vertexStride, nullptr };
+
+    const MeshFileLod* lods = file.GetLods();
+    for (uint32_t i = 0; i < header.lodCount; ++i)
+    {
+        geometry->lods.push_back({ lods[i].startIndex, lods[i].indexCount, lods[i].baseVertex, lods[i].vertexCount, lods[i].maxScreenSize });
+    }
+
+    std::cout << "Loaded mesh file " << aPath << ": " << header.vertexCount << " vertices, " << header.indexCount / 3 << " triangles, "
+        << header.lodCount << " detail levels" << std::endl;
+    myGeometries[key] = geometry;
+    return geometry;
+}
+
+bool GeometryRegistry::GetVertexShader(const std::string& aPath, const VertexFormatDesc& aFormat, ComPtr<ID3D11VertexShader>& aShader,
+    ComPtr<ID3D11InputLayout>& anInputLayout, bool anIsInstanced)
+{
+    const std::string key = GetVertexShaderKey(aPath, aFormat, anIsInstanced);
+    auto it = myVertexShaders.find(key);
+    if (it != myVertexShaders.end())
+    {
+        aShader = it->second.shader;
+        anInputLayout = it->second.inputLayout;
+        return true;
+    }
+
+    std::string vsData;
+    if (!ReadShaderFile(aPath, vsData))
+    {
+        std::cerr << "Failed to open vertex shader file: " << aPath << std::endl;
+        return false;
+    }
+
+    VertexShaderEntry entry;
+    HRESULT hr = myDevice->CreateVertexShader(vsData.data(), vsData.size(), nullptr, &entry.shader);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create vertex shader: " << aPath << " Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout(aFormat.elements, aFormat.elements + aFormat.elementCount);
+    if (anIsInstanced)
+    {
+        for (UINT row = 0; row < 4; ++row)
+        {
+            layout.push_back({ "INSTANCE_TRANSFORM", row, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, row == 0 ? 0 : D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+        }
+    }
+
+    hr = myDevice->CreateInputLayout(layout.data(), static_cast<UINT>(layout.size()), vsData.data(), vsData.size(), &entry.inputLayout);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create input layout for vertex shader: " << aPath << " Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    aShader = entry.shader;
+    anInputLayout = entry.inputLayout;
+    myVertexShaders[key] = entry;
+    return true;
+}
+
+bool GeometryRegistry::GetPixelShader(const std::string& aPath, ComPtr<ID3D11PixelShader>& aShader)
+{
+    auto it = myPixelShaders.find(aPath);
+    if (it != myPixelShaders.end())
+    {
+        aShader = it->second;
+        return true;
+    }
+
+    std::string psData;
+    if (!ReadShaderFile(aPath, psData))
+    {
+        std::cerr << "Failed to open pixel shader file: " << aPath << std::endl;
+        return false;
+    }
+
+    HRESULT hr = myDevice->CreatePixelShader(psData.data(), psData.size(), nullptr, &aShader);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create pixel shader: " << aPath << " Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    myPixelShaders[aPath] = aShader;
+    return true;
+}
+
+bool GeometryRegistry::CreateGeometryBuffers(SharedGeometry& aGeometry, const void* someVertexData, size_t aVertexSize, const void* someIndexData, size_t anIndexSize)
+{
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.CPUAccessFlags = 0;
+    D3D11_SUBRESOURCE_DATA initData = {};
+
+    // Vertex buffer
+    bufferDesc.ByteWidth = static_cast<UINT>(aVertexSize);
+    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    initData.pSysMem = someVertexData;
+    HRESULT hr = myDevice->CreateBuffer(&bufferDesc, &initData, aGeometry.vertexBuffer.GetAddressOf());
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create vertex buffer. Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    // Index buffer
+    bufferDesc.ByteWidth = static_cast<UINT>(anIndexSize);
+    bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    initData.pSysMem = someIndexData;
+    hr = myDevice->CreateBuffer(&bufferDesc, &initData, aGeometry.indexBuffer.GetAddressOf());
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create index buffer. Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    aGeometry.byteSize = aVertexSize + anIndexSize;
+    return true;
+}
+
+GeometryRegistryStats GeometryRegistry::GetStats() const
+{
+    GeometryRegistryStats stats;
+    for (const auto& [key, weakGeometry] : myGeometries)
+    {
+        if (std::shared_ptr<const SharedGeometry> geometry = weakGeometry.lock())
+        {
+            ++stats.liveMeshes;
+            stats.liveBytes += geometry->byteSize;
+        }
+    }
+    stats.requests = myRequestCount;
+    stats.sharedRequests = mySharedRequestCount;
+    stats.savedBytes = mySavedBytes;
+    stats.vertexShaders = myVertexShaders.size();
+    stats.pixelShaders = myPixelShaders.size();
+    return stats;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wrl/client.h>
+#include <d3d11.h>
+
+#include "MeshFile.h"
+#include "MeshLod.h"
+#include "Vertex.h"
+#include "VertexFormat.h"
+
+using Microsoft::WRL::ComPtr;
+
+// GPU buffers for one unique mesh, shared by every object that generates the same geometry
+struct SharedGeometry
+{
+    ComPtr<ID3D11Buffer> vertexBuffer;
+    ComPtr<ID3D11Buffer> indexBuffer;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int vertexStride = 0;
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+    size_t byteSize = 0;
+    std::vector<MeshLod> lods;  // At least one, the whole buffer when the mesh has no detail levels
+    float boundingRadius = 0.0f; // Around the mesh origin, for screen size estimates
+    VertexFormatDesc vertexFormat; // Layout of the vertex buffer, without a pack function for loaded meshes
+    PositionQuantization positionQuantization; // How the shader decodes quantized positions, identity for float ones
+    std::vector<MeshFileElement> fileElements;          // Loaded meshes only, own the semantic names
+    std::vector<D3D11_INPUT_ELEMENT_DESC> fileLayout;   // vertexFormat's elements for loaded meshes
+};
+
+struct GeometryRegistryStats
+{
+    size_t liveMeshes = 0;       // Unique meshes still referenced by an object
+    size_t liveBytes = 0;        // Vertex and index memory of those meshes
+    size_t requests = 0;         // Meshes asked for, shared or not
+    size_t sharedRequests = 0;   // Requests answered with an existing mesh
+    size_t savedBytes = 0;       // Uploads avoided by sharing
+    size_t vertexShaders = 0;
+    size_t pixelShaders = 0;
+};
+
+// Hands out ref-counted vertex/index buffers keyed by generator type and parameters, or by a hash of the
+// uploaded data when an object has no key. Compiled shaders and input layouts are shared by path and format.
+class GeometryRegistry
+{
+public:
+    bool Init(ID3D11Device* aDevice);
+
+    // Existing mesh for aKey, nullptr when no object is currently holding one
+    std::shared_ptr<const SharedGeometry> Find(const std::string& aKey);
+    // Existing mesh for aKey (or the content hash when aKey is empty) or a freshly uploaded one in aFormat
+    std::shared_ptr<const SharedGeometry> Acquire(const std::string& aKey, const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices,
+        const VertexFormatDesc& aFormat, const std::vector<MeshLod>& someLods = {});
+    // Mesh file written by the converter, uploaded straight from the mapped file without staging copies
+    std::shared_ptr<const SharedGeometry> AcquireFile(const std::string& aPath);
+
+    // The input layout declares aFormat's elements, anIsInstanced adds a per-instance float4x4 in slot 1 (INSTANCE_TRANSFORM0-3)
+    bool GetVertexShader(const std::string& aPath, const VertexFormatDesc& aFormat, ComPtr<ID3D11VertexShader>& aShader,
+        ComPtr<ID3D11InputLayout>& anInputLayout, bool anIsInstanced = false);
+    bool GetPixelShader(const std::string& aPath, ComPtr<ID3D11PixelShader>& aShader);
+
+    GeometryRegistryStats GetStats() const;
+
+private:
+    struct VertexShaderEntry
+    {
+        ComPtr<ID3D11VertexShader> shader;
+        ComPtr<ID3D11InputLayout> inputLayout;
+    };
+
+    bool CreateGeometryBuffers(SharedGeometry& aGeometry, const void* someVertexData, size_t aVertexSize, const void* someIndexData, size_t anIndexSize);
+
+    ID3D11Device* myDevice = nullptr;
+    std::map<std::string, std::weak_ptr<const SharedGeometry>> myGeometries;
+    std::map<std::string, VertexShaderEntry> myVertexShaders;
+    std::map<std::string, ComPtr<ID3D11PixelShader>> myPixelShaders;
+    size_t myRequestCount = 0;
+    size_t mySharedRequestCount = 0;
+    size_t mySavedBytes = 0;
+};
@@ -1,5 +1,6 @@
 #include <d3dcompiler.h>
 #include "GraphicsEngine.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -11,17 +12,31 @@
 
 #include "Engine.h"
 #include "FrameBufferData.h"
+#include "InstanceSubmission.h"
 #include "LightBufferData.hpp"
 #include "ObjectBufferData.h"
 #include "Plane.h"
 #include "StringConversion.hpp"
 #include "Terrain.h"
+#include "TerrainImpostor.h"
 #include "Includes/External/stb_image.h"
 
 #define REPORT_DX_WARNINGS
 
 #pragma comment(lib, "d3dcompiler.lib")
 
+namespace
+{
+	// 256 bytes per draw, room for a few frames of several thousand draws before the ring has to discard
+	constexpr UINT locConstantRingCapacity = 4 * 1024 * 1024;
+	// The reflection clips slightly below the water so the shoreline doesn't open a gap
+	constexpr float locReflectionClipOffset = 0.099f;
+	// Queued objects recorded per job, passes with fewer are recorded without starting threads
+	constexpr size_t locObjectsPerCommandJob = 256;
+	// Seconds between the frame stats printed to the console
+	constexpr float locFrameStatsInterval = 5.0f;
+}
+
 bool GraphicsEngine::Init(int aHeight, int aWidth, HWND aWindowHandle)
 {
 	if (aWindowHandle == nullptr || aHeight <= 0 || aWidth <= 0)
@@ -32,6 +47,7 @@ bool GraphicsEngine::Init(int aHeight, int aWidth, HWND aWindowHandle)
 	myWindowHandle = &aWindowHandle;
 	myWindowSize = CommonUtilities::Vector2<unsigned int>(aHeight, aWidth);
 	myTextureManager = std::make_unique<TextureManager>();
+	myGeometryRegistry = std::make_unique<GeometryRegistry>();
 
     std::wstring solutionDir = StringToWString(SOLUTION_DIR);
     std::wstring shaderFolder = L"TGP\\Shaders\\";
@@ -46,12 +62,11 @@ bool GraphicsEngine::Init(int aHeight, int aWidth, HWND aWindowHandle)
 	}
 
 	if (!myTextureManager->Init(GetDevice(), GetContext()) ||
+		!myGeometryRegistry->Init(GetDevice()) ||
 		!CreateRenderTarget(myHResult) ||
-		!CreateReflectionRenderTarget(myHResult) ||
 		!CreateDepthStencilState(myHResult) ||
-		!CreateDepthBuffer(myHResult) ||
 		!CreateLightBuffer(myHResult) ||
-		!CreateFrameAndObjectBuffer(myHResult) ||
+		!CreateConstantBufferRing() ||
 		!CreateTextureSamplerState(myHResult) ||
 		!CreateRasterizerState(myHResult) ||
 		!CreateBlendState(myHResult))
@@ -60,31 +75,63 @@ bool GraphicsEngine::Init(int aHeight, int aWidth, HWND aWindowHandle)
 		return false;
 	}
 
-	SetupViewport();
+	SetupViewport(myBackBufferTextureWidth, myBackBufferTextureHeight);
 	CreateCamera(static_cast<float>(aWidth), static_cast<float>(aHeight));
 	myCamera->SetPosition({ 0.0f, 100.0f, -100.0f });
 	mySavedCamera = std::make_unique<Camera>(*myCamera);
 	myReflectionPlaneHeight = 50.0f;
 
 	myTerrain = std::make_shared<Terrain>();
+	myTerrain->SetPosition(myTerrainPosition);
+	if (!myTerrain->Initialize(myDevice.Get()) || !myTerrain->BakeSunVisibility(mySunAzimuth) || !myTerrain->BakeNormalMap(myTerrainNormalMapResolution))
+	{
+		return false;
+	}
+
+	// Water only gets geometry where the terrain actually dips below it
+	std::vector<WaterBody> waterBodies = DetectWaterBodies(myTerrain->GetHeightfield(), myTerrainPosition, myReflectionPlaneHeight);
+	if (!waterBodies.empty())
+	{
+		myWaterPlane = std::make_shared<Plane>();
+		myWaterPlane->SetWaterBodies(std::move(waterBodies));
+	}
 
     myObjectsToRender.push_back(myTerrain);
-    myObjectsToRender.push_back(std::make_shared<Plane>());
+	if (myWaterPlane)
+	{
+		myObjectsToRender.push_back(myWaterPlane);
+	}
+	if (myUseTerrainImpostor)
+	{
+		// Everything past the meshed grid comes from a baked panorama on a ring around the camera
+		TerrainImpostorSettings impostorSettings;
+		impostorSettings.meshedSize = myTerrain->GetSize();
+		myTerrainImpostor = std::make_shared<TerrainImpostor>(myTerrain->GetHeightSettings(), myTerrainPosition, impostorSettings);
+		myTerrainImpostor->SetPosition(myCamera->GetPosition());
+		myObjectsToRender.push_back(myTerrainImpostor);
+	}
     //myObjectsToRender.push_back(std::make_shared<Sphere>());
 
 	for (auto& object : myObjectsToRender)
 	{
-		if (!object->Initialize(myDevice.Get()))
+		if (object != myTerrain && !object->Initialize(myDevice.Get()))
 			return false;
 	}
 
+	const GeometryRegistryStats geometryStats = myGeometryRegistry->GetStats();
+	std::cout << "Geometry: " << geometryStats.liveMeshes << " unique meshes (" << geometryStats.liveBytes / 1024 << " KB) for "
+		<< geometryStats.requests << " objects, " << geometryStats.savedBytes / 1024 << " KB of uploads shared" << std::endl;
+
 	return true;
 }
 void GraphicsEngine::Update(float aDeltaTime, CommonUtilities::InputHandler& anInputHandler)
 {
 	//myObjectsToRender[0]->SetPosition({5.0f + (0.001f * time) * 2.0f,0,10.0f});
-	myObjectsToRender[0]->SetPosition({ 0.0f, -25.0f,100.0f });
-	myObjectsToRender[1]->SetPosition({ 100.0f, myReflectionPlaneHeight,0.0f });
+	myTerrain->SetPosition(myTerrainPosition);
+	if (myWaterPlane)
+	{
+		myWaterPlane->SetPosition({ 0.0f, myReflectionPlaneHeight, 0.0f });
+	}
 
 	UpdateTimeOfDay();
 
@@ -107,31 +154,31 @@ void GraphicsEngine::Update(float aDeltaTime, CommonUtilities::InputHandler& anI
 		return;
 	}
 	myCamera->Update(aDeltaTime, anInputHandler);
+	if (myTerrainImpostor)
+	{
+		myTerrainImpostor->Update(myCamera->GetPosition());
+	}
 
 	UpdateLightBuffer();
-	UpdateFrameBuffer(aDeltaTime);
+	UpdateFrameBuffer(aDeltaTime, myCamera->GetProjection());
 }
-void GraphicsEngine::UpdateFrameBuffer(float aDeltaTime = 0.0f)
+void GraphicsEngine::UpdateFrameBuffer(float aDeltaTime, const CommonUtilities::Matrix4x4<float>& aProjection)
 {
 	if (aDeltaTime != 0.0f)
 		myElapsedTime += aDeltaTime;
 
 	FrameBufferData frameBufferData = {};
 	frameBufferData.worldToCamera = myCamera->GetView();
-	frameBufferData.cameraToProjection = myCamera->GetProjection();
-	frameBufferData.worldToClip = myCamera->GetView() * myCamera->GetProjection();
+	frameBufferData.cameraToProjection = aProjection;
+	frameBufferData.worldToClip = myCamera->GetView() * aProjection;
 	frameBufferData.worldToClipReflected = mySavedCamera->GetView() * mySavedCamera->GetProjection();
 	frameBufferData.time = myElapsedTime;
 	frameBufferData.cameraPosition = myCamera->GetPosition();
 	frameBufferData.waterHeight = myReflectionPlaneHeight;
+	frameBufferData.hasTerrainNormals = myTextureManager->GetTexture("TerrainNormals") ? 1.0f : 0.0f;
 	frameBufferData.resolution = CommonUtilities::Vector2<float>(static_cast<float>(myBackBufferTextureWidth), static_cast<float>(myBackBufferTextureHeight));
 
-	D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
-	myContext->Map(myFrameBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer);
-	memcpy(mappedBuffer.pData, &frameBufferData, sizeof(FrameBufferData));
-	myContext->Unmap(myFrameBuffer.Get(), 0);
-
-	myContext->VSSetConstantBuffers(0, 1, myFrameBuffer.GetAddressOf());
+	myConstantBufferRing.SetConstants(myRenderContext, 0, ConstantStageVertex | ConstantStagePixel, &frameBufferData, sizeof(FrameBufferData));
 }
 void GraphicsEngine::UpdateFrameBufferForReflection()
 {
@@ -143,42 +190,43 @@ void GraphicsEngine::UpdateFrameBufferForReflection()
 	frameBufferData.time = myElapsedTime;
 	frameBufferData.cameraPosition = mySavedCamera->GetPosition();
 	frameBufferData.waterHeight = myReflectionPlaneHeight;
+	frameBufferData.hasTerrainNormals = myTextureManager->GetTexture("TerrainNormals") ? 1.0f : 0.0f;
 	frameBufferData.resolution = CommonUtilities::Vector2<float>(static_cast<float>(myWindowSize.x), static_cast<float>(myWindowSize.y));
 
-	D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
-	myContext->Map(myFrameBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer);
-	memcpy(mappedBuffer.pData, &frameBufferData, sizeof(FrameBufferData));
-	myContext->Unmap(myFrameBuffer.Get(), 0);
-
-	myContext->VSSetConstantBuffers(0, 1, myFrameBuffer.GetAddressOf());
+	myConstantBufferRing.SetConstants(myRenderContext, 0, ConstantStageVertex | ConstantStagePixel, &frameBufferData, sizeof(FrameBufferData));
 }
-void GraphicsEngine::UpdateObjectBuffer(const std::shared_ptr<Object3D>& anObject) const
+void GraphicsEngine::UpdateObjectBuffer(const std::shared_ptr<Object3D>& anObject)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	myContext->Map(myObjectBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-
-	ObjectBufferData* objectData = reinterpret_cast<ObjectBufferData*>(mappedResource.pData);
-	objectData->modelToWorldMatrix = anObject->GetWorldMatrix();
-
-	myContext->Unmap(myObjectBuffer.Get(), 0);
+	ObjectBufferData objectData;
+	FillObjectBufferData(*anObject, objectData);
+	myConstantBufferRing.SetConstants(myRenderContext, 1, ConstantStageVertex, &objectData, sizeof(ObjectBufferData));
+}
+void GraphicsEngine::FillObjectBufferData(const Object3D& anObject, ObjectBufferData& someData) const
+{
+	someData.modelToWorldMatrix = anObject.GetWorldMatrix();
 
-	myContext->VSSetConstantBuffers(1, 1, myObjectBuffer.GetAddressOf());
+	const SharedGeometry* geometry = anObject.GetGeometry();
+	const PositionQuantization quantization = geometry ? geometry->positionQuantization : PositionQuantization();
+	someData.positionScale = CommonUtilities::Vector4<float>(quantization.scale[0], quantization.scale[1], quantization.scale[2], 0.0f);
+	someData.positionOffset = CommonUtilities::Vector4<float>(quantization.offset[0], quantization.offset[1], quantization.offset[2], 0.0f);
 }
 void GraphicsEngine::UpdateLightBuffer()
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	myContext->Map(myLightBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	LightBuffer* lightData = (LightBuffer*)mappedResource.pData;
+	LightBuffer lightData = {};
 
 	double timeOfDay = GetTimeOfDay();
 	float dirLightIntensity = 0.0f;
 	float ambientIntensity1 = 0.0f;
 	float ambientIntensity2 = 0.0f;
 
-	lightData->directionalLightDirection = CommonUtilities::Vector3(-0.5f, 1.0f, -0.5f);
-	lightData->directionalLightColor = CommonUtilities::Vector4(1.0f, 1.0f, 0.8f, 1.0f); // Light yellow
-	lightData->ambientColor1 = CommonUtilities::Vector4(1.0f, 0.0f, 0.0f, 1.0f); // Red
-	lightData->ambientColor2 = CommonUtilities::Vector4(0.0f, 0.0f, 1.0f, 1.0f); // Blue
+	// The sun travels in the vertical plane through mySunAzimuth, kept just above the horizon at night
+	const float sunElevation = GetSunElevation();
+	const float lightElevation = std::clamp(sunElevation, 0.05f, 3.14159265f - 0.05f);
+	lightData.directionalLightDirection = mySunAzimuth * std::cos(lightElevation) + CommonUtilities::Vector3(0.0f, std::sin(lightElevation), 0.0f);
+	lightData.sunElevation = sunElevation;
+	lightData.directionalLightColor = CommonUtilities::Vector4(1.0f, 1.0f, 0.8f, 1.0f); // Light yellow
+	lightData.ambientColor1 = CommonUtilities::Vector4(1.0f, 0.0f, 0.0f, 1.0f); // Red
+	lightData.ambientColor2 = CommonUtilities::Vector4(0.0f, 0.0f, 1.0f, 1.0f); // Blue
 
 	if (timeOfDay < 6.0)
 	{
@@ -195,10 +243,10 @@ void GraphicsEngine::UpdateLightBuffer()
 		dirLightIntensity = static_cast<float>((24.0 - timeOfDay) / 6.0);
 
 		ambientIntensity1 = 0.5f;
-		lightData->ambientColor1 = CommonUtilities::Vector4(1.0f, 0.0f, 0.0f, 1.0f); // Red
+		lightData.ambientColor1 = CommonUtilities::Vector4(1.0f, 0.0f, 0.0f, 1.0f); // Red
 		// Increase intensity from 0.5f - 1.0f hours 18 to 24
 		ambientIntensity2 = static_cast<float>(0.5 + ((timeOfDay - 18.0) / 6.0) * 0.5f);
-		lightData->ambientColor2 = CommonUtilities::Vector4(0.0f, 0.0f, 1.0f, 1.0f); // Blue
+		lightData.ambientColor2 = CommonUtilities::Vector4(0.0f, 0.0f, 1.0f, 1.0f); // Blue
         //ambientIntensity2 = 0.1f + static_cast<float>((timeOfDay - 18.0) / 6.0) * 0.9f; // Increase intensity from 0.1f to 1.0f hours 18 to 24
     }
 	else if (timeOfDay >= 6.0 && timeOfDay <= 18.0)
@@ -208,14 +256,16 @@ void GraphicsEngine::UpdateLightBuffer()
 		ambientIntensity1 = 0.5f;
 
 		ambientIntensity2 = 1.0f;
-		lightData->ambientColor2 = CommonUtilities::Vector4(1.0f, 0.8f, 0.8f, 1.0f); // White
+		lightData.ambientColor2 = CommonUtilities::Vector4(1.0f, 0.8f, 0.8f, 1.0f); // White
 	}
-	lightData->directionalLightIntensity = dirLightIntensity;
-	lightData->ambientIntensity1 = ambientIntensity1;
-	lightData->ambientIntensity2 = ambientIntensity2;
-	lightData->renderMode = myRenderMode;
-
-	myContext->Unmap(myLightBuffer.Get(), 0);
+	lightData.directionalLightIntensity = dirLightIntensity;
+	lightData.ambientIntensity1 = ambientIntensity1;
+	lightData.ambientIntensity2 = ambientIntensity2;
+	lightData.renderMode = static_cast<float>(myRenderMode);
+
+	// Written every frame, but only reaches the GPU when a value actually moved
+	myLightBuffer.Set(lightData);
+	myLightBuffer.Upload(myContext.Get());
 }
 void GraphicsEngine::UpdateTimeOfDay()
 {
@@ -225,56 +275,204 @@ void GraphicsEngine::UpdateTimeOfDay()
     std::string debugMessage = "Time of day: " + std::to_string(myTimeOfDay);
     OutputDebugString(debugMessage);
 }
+float GraphicsEngine::GetSunElevation() const
+{
+	// Sunrise at 06:00, zenith at 12:00, sunset at 18:00
+	constexpr double pi = 3.14159265358979323846;
+	return static_cast<float>((myTimeOfDay - 6.0) / 12.0 * pi);
+}
 void GraphicsEngine::Render(float aDeltaTime)
 {
-	myContext->OMSetRenderTargets(1, myReflectionRTV[myCurrentReflectionBufferIndex].GetAddressOf(), myDepthBuffer.Get());
-	myContext->ClearRenderTargetView(myReflectionRTV[myCurrentReflectionBufferIndex].Get(), myClearColor);
-	myContext->ClearDepthStencilView(myDepthBuffer.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	myContext->RSSetState(myRasterizerStateFrontFaceCulling.Get());
-
-	SetBlendState();
-	RenderScene(aDeltaTime, true);
-
-	myContext->OMSetRenderTargets(1, myBackBuffer.GetAddressOf(), myDepthBuffer.Get());
-	myContext->ClearRenderTargetView(myBackBuffer.Get(), myClearColor);
-	myContext->ClearDepthStencilView(myDepthBuffer.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	myContext->RSSetState(nullptr);
+	// The main pass draws from the camera as it is before the reflection pass mirrors it
+	mySavedCamera = std::make_unique<Camera>(*myCamera);
+	if (myTerrainImpostor)
+	{
+		myTerrainImpostor->UploadFinishedBake(myContext.Get());
+	}
 
-	SetBlendState();
-	RenderScene(aDeltaTime, false);
+	DeclareFrameGraph(aDeltaTime);
+	if (myFrameGraph.Compile() && myFrameGraphTextures.Realize(myDevice.Get(), myFrameGraph.GetPhysicalTextures()))
+	{
+		myFrameGraph.Execute();
+	}
 
 	// Present the back buffer to the screen
 	mySwapChain->Present(1, 0);
+	myConstantBufferRing.EndFrame();
+
+	myStateFilterStats = myRenderContext.GetStats();
+	myRenderContext.ResetStats();
+	ReportFrameStats(aDeltaTime);
 }
-void GraphicsEngine::RenderScene(float aDeltaTime, bool isReflection)
+void GraphicsEngine::ReportFrameStats(float aDeltaTime)
 {
-	if (isReflection)
+	myFrameStatsTime += aDeltaTime;
+	if (myFrameStatsTime < locFrameStatsInterval)
 	{
-		mySavedCamera = std::make_unique<Camera>(*myCamera);
+		return;
+	}
+	myFrameStatsTime = 0.0f;
+
+	std::cout << "State calls: " << myStateFilterStats.issuedCalls << " issued, " << myStateFilterStats.filteredCalls << " filtered as redundant" << std::endl;
 
+	const ReflectionStats& reflectionStats = myReflectionScheduler.GetStats();
+	auto reasonCount = [&reflectionStats](ReflectionUpdateReason aReason) { return reflectionStats.reasonCounts[static_cast<int>(aReason)]; };
+	std::cout << "Reflection: drawn " << reflectionStats.renderedFrames << ", reused " << reflectionStats.reusedFrames << " frames (interval "
+		<< reasonCount(ReflectionUpdateReason::Interval) << ", moved " << reasonCount(ReflectionUpdateReason::CameraMoved) << ", rotated "
+		<< reasonCount(ReflectionUpdateReason::CameraRotated) << ", time of day " << reasonCount(ReflectionUpdateReason::TimeOfDay) << ")" << std::endl;
+}
+void GraphicsEngine::DeclareFrameGraph(float aDeltaTime)
+{
+	myFrameGraph.Reset();
+	const FrameGraphResource backBuffer = myFrameGraph.ImportTexture("BackBuffer");
+
+	FrameGraphTextureDesc colorDesc;
+	colorDesc.width = myBackBufferTextureWidth;
+	colorDesc.height = myBackBufferTextureHeight;
+	colorDesc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	colorDesc.usage = FrameGraphUsageRenderTarget | FrameGraphUsageShaderResource;
+
+	FrameGraphTextureDesc depthDesc = colorDesc;
+	depthDesc.format = DXGI_FORMAT_D32_FLOAT;
+	depthDesc.usage = FrameGraphUsageDepthStencil;
+
+	// Drawn at a fraction of the screen, its depth is sampled to upsample it without bleeding across edges
+	const UINT reflectionDivisor = static_cast<UINT>(myReflectionQuality);
+	FrameGraphTextureDesc reflectionDesc = colorDesc;
+	reflectionDesc.width = std::max(1u, colorDesc.width / reflectionDivisor);
+	reflectionDesc.height = std::max(1u, colorDesc.height / reflectionDivisor);
+	FrameGraphTextureDesc reflectionDepthDesc = depthDesc;
+	reflectionDepthDesc.width = reflectionDesc.width;
+	reflectionDepthDesc.height = reflectionDesc.height;
+	reflectionDepthDesc.usage = FrameGraphUsageDepthStencil | FrameGraphUsageShaderResource;
+
+	// The reflection outlives the frame so later frames can reuse it, it is imported rather than transient. The oblique
+	// near plane only clips away what is under the water while the camera is above it, from below the water goes
+	// without a reflection instead of showing the underwater geometry in it
+	const bool isCameraAboveWater = myCamera->GetPosition().y > myReflectionPlaneHeight + locReflectionClipOffset;
+	if (!isCameraAboveWater)
+	{
+		myReflectionScheduler.Invalidate();
+	}
+	const bool hasReflection = myWaterPlane && isCameraAboveWater && UpdateReflectionTextures(reflectionDesc, reflectionDepthDesc);
+	const FrameGraphResource reflection = myFrameGraph.ImportTexture("Reflection");
+	const FrameGraphResource reflectionDepth = myFrameGraph.ImportTexture("ReflectionDepth");
+	if (hasReflection && myReflectionScheduler.Update(GetReflectionView()) != ReflectionUpdateReason::None)
+	{
+		FrameGraphPassBuilder reflectionPass = myFrameGraph.AddPass("Reflection");
+		reflectionPass.Write(reflection);
+		reflectionPass.Write(reflectionDepth);
+		reflectionPass.SetExecute([this, aDeltaTime, reflectionDesc]
+		{
+			SetupViewport(reflectionDesc.width, reflectionDesc.height);
+			RenderReflection(aDeltaTime, myReflectionTextures.GetRenderTarget(0), myReflectionTextures.GetDepthStencil(1));
+		});
+	}
+
+	FrameGraphPassBuilder mainPass = myFrameGraph.AddPass("Main");
+	if (hasReflection)
+	{
+		mainPass.Read(reflection);
+		mainPass.Read(reflectionDepth);
+	}
+	const FrameGraphResource depth = mainPass.Create("Depth", depthDesc);
+	mainPass.Write(backBuffer);
+	mainPass.SetExecute([this, aDeltaTime, hasReflection, depth]
+	{
+		SetupViewport(myBackBufferTextureWidth, myBackBufferTextureHeight);
+		myRenderContext.OMSetRenderTargets(1, myBackBuffer.GetAddressOf(), GetFrameGraphDepthStencil(depth));
+		myContext->ClearRenderTargetView(myBackBuffer.Get(), myClearColor);
+		myContext->ClearDepthStencilView(GetFrameGraphDepthStencil(depth), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		myRenderContext.RSSetState(nullptr);
+
+		SetBlendState();
+		RenderScene(aDeltaTime, false,
+			hasReflection ? myReflectionTextures.GetShaderResource(0) : nullptr,
+			hasReflection ? myReflectionTextures.GetShaderResource(1) : nullptr);
+	});
+}
+bool GraphicsEngine::UpdateReflectionTextures(const FrameGraphTextureDesc& aColorDesc, const FrameGraphTextureDesc& aDepthDesc)
+{
+	// New textures have nothing in them to reuse
+	const bool isRecreated = myReflectionTextures.GetTextureCount() != 2 ||
+		myReflectionTextures.GetDesc(0) != aColorDesc || myReflectionTextures.GetDesc(1) != aDepthDesc;
+	if (isRecreated)
+	{
+		myReflectionScheduler.Invalidate();
+	}
+	return myReflectionTextures.Realize(myDevice.Get(), { aColorDesc, aDepthDesc });
+}
+ReflectionView GraphicsEngine::GetReflectionView() const
+{
+	// The view matrix's third column is the camera's forward direction
+	const CommonUtilities::Matrix4x4<float>& view = myCamera->GetView();
+	ReflectionView reflectionView;
+	reflectionView.position = myCamera->GetPosition();
+	reflectionView.forward = CommonUtilities::Vector3<float>(view(1, 3), view(2, 3), view(3, 3)).GetNormalized();
+	reflectionView.timeOfDay = myTimeOfDay;
+	return reflectionView;
+}
+ID3D11RenderTargetView* GraphicsEngine::GetFrameGraphRenderTarget(FrameGraphResource aResource) const
+{
+	const uint32_t physical = myFrameGraph.GetPhysicalTexture(aResource);
+	return physical != locNoPhysicalTexture ? myFrameGraphTextures.GetRenderTarget(physical) : nullptr;
+}
+ID3D11DepthStencilView* GraphicsEngine::GetFrameGraphDepthStencil(FrameGraphResource aResource) const
+{
+	const uint32_t physical = myFrameGraph.GetPhysicalTexture(aResource);
+	return physical != locNoPhysicalTexture ? myFrameGraphTextures.GetDepthStencil(physical) : nullptr;
+}
+ID3D11ShaderResourceView* GraphicsEngine::GetFrameGraphShaderResource(FrameGraphResource aResource) const
+{
+	const uint32_t physical = myFrameGraph.GetPhysicalTexture(aResource);
+	return physical != locNoPhysicalTexture ? myFrameGraphTextures.GetShaderResource(physical) : nullptr;
+}
+void GraphicsEngine::RenderReflection(float aDeltaTime, ID3D11RenderTargetView* aTarget, ID3D11DepthStencilView* aDepth)
+{
+	myRenderContext.OMSetRenderTargets(1, &aTarget, aDepth);
+	myContext->ClearRenderTargetView(aTarget, myClearColor);
+	myContext->ClearDepthStencilView(aDepth, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	myRenderContext.RSSetState(myRasterizerStateFrontFaceCulling.Get());
+
+	SetBlendState();
+	RenderScene(aDeltaTime, true);
+}
+void GraphicsEngine::RenderScene(float aDeltaTime, bool isReflection, ID3D11ShaderResourceView* aReflection, ID3D11ShaderResourceView* aReflectionDepth)
+{
+	if (isReflection)
+	{
 		// Update reflected camera
 		auto reflectionTransform = myCamera->GetTransform().Reflect(myReflectionPlaneHeight);
 		myCamera->SetTransform(reflectionTransform);
 		myCamera->CalculateView();
-		UpdateFrameBuffer();
+
+		// Geometry below the water has no business in the reflection. Moving the near plane onto the water lets the
+		// rasterizer clip it, which only works while the reflected camera is below the water, i.e. the real one above.
+		// DeclareFrameGraph skips the pass otherwise, the plain projection only guards against a degenerate plane
+		const CommonUtilities::Vector4<float> waterPlane(0.0f, 1.0f, 0.0f, -(myReflectionPlaneHeight - locReflectionClipOffset));
+		const CommonUtilities::Vector4<float> viewWaterPlane = TransformPlaneToView(waterPlane, myCamera->GetView());
+		const CommonUtilities::Matrix4x4<float> projection = viewWaterPlane.w < 0.0f ?
+			MakeObliqueProjection(myCamera->GetProjection(), viewWaterPlane) : myCamera->GetProjection();
+		myReflectionFrustum = Frustum::FromWorldToClip(myCamera->GetView() * projection);
+		UpdateFrameBuffer(0.0f, projection);
 
 		// Turn on front face culling for reflection rendering
-		myContext->RSSetState(myRasterizerStateFrontFaceCulling.Get());
+		myRenderContext.RSSetState(myRasterizerStateFrontFaceCulling.Get());
 
 		RenderObjects(true);
 	}
 	else
 	{
 		// Bind textures for the main scene, including the reflection texture
-		BindTextures(myReflectionSRV[myCurrentReflectionBufferIndex].Get());
+		BindTextures(aReflection, aReflectionDepth);
 
 		// Use the main camera
 		myCamera = std::make_unique<Camera>(*mySavedCamera);
 		myCamera->CalculateView();
-		UpdateFrameBuffer(aDeltaTime);
+		UpdateFrameBuffer(aDeltaTime, myCamera->GetProjection());
 
 		// Turn on back face culling for main scene rendering
-		myContext->RSSetState(myRasterizerState.Get());
+		myRenderContext.RSSetState(myRasterizerState.Get());
 
 		RenderObjects(false);
 	}
@@ -283,46 +481,181 @@ void GraphicsEngine::RenderObjects(bool isReflection)
 {
 	int textureSlot = 0;
 
-	if (isReflection)
-	{
-		PrintTransform(myCamera->GetTransform());
-		PrintTransform(mySavedCamera->GetTransform());
-	}
+	// Screen height in pixels of one unit at distance one, for LOD selection. The reflection target is a fraction of the screen
+	const UINT targetHeight = isReflection ? std::max(1u, myBackBufferTextureHeight / static_cast<UINT>(myReflectionQuality)) : myBackBufferTextureHeight;
+	const float pixelsPerUnit = myCamera->GetProjection()(2, 2) * 0.5f * static_cast<float>(targetHeight) * myLodBias;
 
-	for (auto& object : myObjectsToRender)
+	myInstanceBatcher.Clear();
+	myRenderQueue.Clear();
+	for (size_t objectIndex = 0; objectIndex < myObjectsToRender.size(); ++objectIndex)
 	{
+		auto& object = myObjectsToRender[objectIndex];
 		//ID3D11ShaderResourceView* srv = Engine::GetInstance().GetGraphicsEngine().GetTextureManager().GetTexture("Pyramid");
 
-		if (object->GetPixelShaderPath().find("Plane_PS.cso") != std::string::npos && isReflection)
+		if (!object->HasPass(isReflection ? PassMaskReflection : PassMaskMain))
 		{
 			continue;
 		}
 
-		UpdateObjectBuffer(object);
-		if(myRenderMode == 0)
+		CommonUtilities::Vector3<float> boundsCenter;
+		float boundsRadius = 0.0f;
+		if (isReflection && object->GetBoundingSphere(boundsCenter, boundsRadius) && !myReflectionFrustum.IntersectsSphere(boundsCenter, boundsRadius))
+		{
+			continue;
+		}
+
+		object->SelectLod(myCamera->GetPosition(), pixelsPerUnit, myForcedLod);
+
+		// Repeated meshes are collected and drawn once per mesh/material after the loop
+		if (myRenderMode == 0 && object->SupportsInstancing())
 		{
-			object->Render(myContext.Get());
+			myInstanceBatcher.Add(object->GetInstanceKey(), object->GetWorldMatrix(), objectIndex);
+			continue;
+		}
+
+		// Everything else is sorted by pass and state and drawn after the loop
+		if (myRenderMode == 0)
+		{
+			const float viewDepth = (object->GetPosition() - myCamera->GetPosition()).Length();
+			myRenderQueue.Add(object->GetRenderPass(), object->GetRenderStateIds(), viewDepth, objectIndex);
+			continue;
 		}
-		else if (myRenderMode == 1)
+
+		UpdateObjectBuffer(object);
+		if (myRenderMode == 1)
 		{
-			if (object->GetVertexShaderPath().find("Terrain_VS.cso") != std::string::npos)
+			if (object->HasPass(PassMaskDiffuseDebug))
 			{
-				myTerrain->RenderDiffuse(myContext.Get());
+				myTerrain->RenderDiffuse(myRenderContext);
 			}
 		}
 		else if (myRenderMode == -1)
 		{
-			if (object->GetVertexShaderPath().find("Terrain_VS.cso") != std::string::npos)
+			if (object->HasPass(PassMaskSpecularDebug))
 			{
-				myTerrain->RenderSpecular(myContext.Get());
+				myTerrain->RenderSpecular(myRenderContext);
 			}
 		}
 		textureSlot++;
 	}
+
+	myRenderQueue.Sort();
+	RenderQueuedObjects(RenderPass::Opaque);
+	RenderInstanceBatches();
+	RenderQueuedObjects(RenderPass::Blended);
+}
+void GraphicsEngine::RenderQueuedObjects(RenderPass aPass)
+{
+	myQueuedPassObjects.clear();
+	for (const RenderItem& item : myRenderQueue.GetItems())
+	{
+		if (myObjectsToRender[item.objectIndex]->GetRenderPass() == aPass)
+		{
+			myQueuedPassObjects.push_back(item.objectIndex);
+		}
+	}
+
+	// Worker threads pack the constants and record the draws of a range of objects each. Consecutive draws share
+	// most of their state after sorting, so each one only rebinds what differs from the previous one of its job
+	myRenderCommands.Record(myWorkerPool, myQueuedPassObjects.size(), locObjectsPerCommandJob, [this](RenderCommandBuffer& aCommands, size_t aFirst, size_t aLast)
+	{
+		RenderState boundState;
+		for (size_t i = aFirst; i < aLast; ++i)
+		{
+			const Object3D& object = *myObjectsToRender[myQueuedPassObjects[i]];
+			ObjectBufferData objectData;
+			FillObjectBufferData(object, objectData);
+			aCommands.UpdateConstants(1, ConstantStageVertex, &objectData, sizeof(ObjectBufferData));
+			object.Record(aCommands, i == aFirst ? nullptr : &boundState);
+			if (i == aFirst)
+			{
+				boundState = object.GetRenderState();
+			}
+		}
+	});
+	ReplayRenderCommands();
 }
-void GraphicsEngine::BindTextures(ID3D11ShaderResourceView* reflectionSRV)
+void GraphicsEngine::ReplayRenderCommands()
 {
-	myContext->PSSetSamplers(0, 1, mySamplerState.GetAddressOf());
+	// Every recorded constant update goes into the ring with one map, replaying it then only binds its offset.
+	// Without offsets each update has a block buffer of its own that is only mapped when its bytes changed
+	myRecordedConstants.clear();
+	myRenderCommands.ForEachConstants([this](const UpdateConstantsCommand& aCommand, const void* someData)
+	{
+		myRecordedConstants.emplace_back(someData, aCommand.size);
+	});
+	const bool hasConstantBlocks = myConstantBufferRing.WriteBlocks(myRenderCommands.GetLargestConstants(), static_cast<UINT>(myRecordedConstants.size()),
+		[this](UINT anIndex, unsigned char* aDestination)
+	{
+		memcpy(aDestination, myRecordedConstants[anIndex].first, myRecordedConstants[anIndex].second);
+	});
+
+	UINT constantsIndex = 0;
+	myRenderCommands.Replay(myRenderContext, [&](const UpdateConstantsCommand& aCommand, const void* someData)
+	{
+		if (hasConstantBlocks)
+		{
+			myConstantBufferRing.BindBlock(myRenderContext, aCommand.slot, aCommand.stages, constantsIndex++);
+		}
+		else
+		{
+			myConstantBufferRing.SetConstants(myRenderContext, aCommand.slot, aCommand.stages, someData, aCommand.size);
+		}
+	});
+}
+void GraphicsEngine::RenderInstanceBatches()
+{
+	if (myInstanceBatcher.IsEmpty())
+	{
+		return;
+	}
+
+	myInstanceBatcher.Build();
+	if (!EnsureInstanceBuffer(static_cast<UINT>(myInstanceBatcher.GetInstanceCount())))
+	{
+		return;
+	}
+
+	SubmitInstanceBatches(*myContext.Get(), myInstanceBuffer.Get(), myInstanceBatcher, [this](const InstanceBatch& aBatch)
+	{
+		myObjectsToRender[aBatch.objectIndex]->RenderInstanced(myRenderContext, myInstanceBuffer.Get(), aBatch.firstInstance, aBatch.instanceCount);
+	});
+}
+bool GraphicsEngine::EnsureInstanceBuffer(UINT anInstanceCount)
+{
+	if (myInstanceBuffer && anInstanceCount <= myInstanceCapacity)
+	{
+		return true;
+	}
+
+	// Grows by doubling so a scene that keeps adding objects only reallocates a handful of times
+	UINT capacity = std::max(myInstanceCapacity, 256u);
+	while (capacity < anInstanceCount)
+	{
+		capacity *= 2;
+	}
+
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.ByteWidth = capacity * sizeof(CommonUtilities::Matrix4x4<float>);
+
+	myInstanceBuffer.Reset();
+	HRESULT hr = myDevice->CreateBuffer(&bufferDesc, nullptr, &myInstanceBuffer);
+	if (FAILED(hr))
+	{
+		std::cerr << "Failed to create instance buffer. Error: " << std::hex << hr << std::endl;
+		myInstanceCapacity = 0;
+		return false;
+	}
+
+	myInstanceCapacity = capacity;
+	return true;
+}
+void GraphicsEngine::BindTextures(ID3D11ShaderResourceView* reflectionSRV, ID3D11ShaderResourceView* aReflectionDepth)
+{
+	myRenderContext.PSSetSamplers(0, 1, mySamplerState.GetAddressOf());
 
 	// Bind textures to shader resource slots
 	ID3D11ShaderResourceView* textures[] = {
@@ -338,7 +671,11 @@ void GraphicsEngine::BindTextures(ID3D11ShaderResourceView* reflectionSRV)
 		myTextureManager->GetTexture("Snow_m"),
 		myTextureManager->GetTexture("Noise"),
 		myTextureManager->GetTexture("Cubemap"),
-		reflectionSRV // Reflection texture bound here if available
+		reflectionSRV, // Reflection texture bound here if available
+		nullptr,
+		myTextureManager->GetTexture("TerrainSunHorizon"),
+		myTextureManager->GetTexture("TerrainNormals"),
+		aReflectionDepth
 	};
 
 	// Ensure reflection SRV is bound only when valid
@@ -347,7 +684,7 @@ void GraphicsEngine::BindTextures(ID3D11ShaderResourceView* reflectionSRV)
 		textures[12] = nullptr;
 	}
 
-	myContext->PSSetShaderResources(0, _countof(textures), textures);
+	myRenderContext.PSSetShaderResources(0, _countof(textures), textures);
 }
 bool GraphicsEngine::CreateDeviceAndSwapChain()
 {
@@ -383,6 +720,7 @@ bool GraphicsEngine::CreateDeviceAndSwapChain()
 		return false;
 	}
 
+	myRenderContext.SetContext(myContext.Get());
 	return true;
 }
 bool GraphicsEngine::CreateRenderTarget(HRESULT& aHresult)
@@ -399,7 +737,7 @@ bool GraphicsEngine::CreateRenderTarget(HRESULT& aHresult)
 	{
 		return false;
 	}
-	myContext->OMSetRenderTargets(1, myBackBuffer.GetAddressOf(), myDepthBuffer.Get());
+	myRenderContext.OMSetRenderTargets(1, myBackBuffer.GetAddressOf(), nullptr);
 
 	D3D11_TEXTURE2D_DESC textureDesc;
 	backBufferTexture->GetDesc(&textureDesc);
@@ -408,39 +746,7 @@ bool GraphicsEngine::CreateRenderTarget(HRESULT& aHresult)
 	myBackBufferTextureWidth = textureDesc.Width;
 	return true;
 }
-bool GraphicsEngine::CreateReflectionRenderTarget(HRESULT& aHresult)
-{
-	for (int i = 0; i < 2; i++) 
-	{
-		D3D11_TEXTURE2D_DESC textureDesc = {};
-		textureDesc.Width = myBackBufferTextureWidth;
-		textureDesc.Height = myBackBufferTextureHeight;
-		textureDesc.MipLevels = 1;
-		textureDesc.ArraySize = 1;
-		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		textureDesc.SampleDesc.Count = 1;
-		textureDesc.Usage = D3D11_USAGE_DEFAULT;
-		textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-
-		aHresult = myDevice->CreateTexture2D(&textureDesc, nullptr, &myReflectionTexture[i]);
-		if (FAILED(aHresult))
-		{
-			return false;
-		}
-		aHresult = myDevice->CreateRenderTargetView(myReflectionTexture[i].Get(), nullptr, &myReflectionRTV[i]);
-		if (FAILED(aHresult))
-		{
-			return false;
-		}
-		aHresult = myDevice->CreateShaderResourceView(myReflectionTexture[i].Get(), nullptr, &myReflectionSRV[i]);
-		if (FAILED(aHresult))
-		{
-			return false;
-		}
-	}
-	return true;
-}
-bool GraphicsEngine::CreateDepthStencilState(HRESULT& aHresult) const
+bool GraphicsEngine::CreateDepthStencilState(HRESULT& aHresult)
 {
 	D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
 	depthStencilDesc.DepthEnable = TRUE;
@@ -455,87 +761,26 @@ bool GraphicsEngine::CreateDepthStencilState(HRESULT& aHresult) const
 		return false;
 	}
 
-	myContext->OMSetDepthStencilState(depthStencilState, 0);
+	myRenderContext.OMSetDepthStencilState(depthStencilState, 0);
 
 	depthStencilState->Release();
 	return true;
 }
-bool GraphicsEngine::CreateDepthBuffer(HRESULT& aHresult)
-{
-	// Create depth buffer texture
-	ID3D11Texture2D* depthBufferTexture;
-	D3D11_TEXTURE2D_DESC depthBufferDesc = {};
-	depthBufferDesc.Width = static_cast<unsigned int>(myBackBufferTextureWidth);
-	depthBufferDesc.Height = static_cast<unsigned int>(myBackBufferTextureHeight);
-	depthBufferDesc.ArraySize = 1;
-	depthBufferDesc.Format = DXGI_FORMAT_D32_FLOAT;
-	depthBufferDesc.SampleDesc.Count = 1;
-	depthBufferDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-
-	aHresult = myDevice->CreateTexture2D(&depthBufferDesc, nullptr, &depthBufferTexture);
-	if (FAILED(aHresult))
-	{
-		return false;
-	}
-
-	// Create depth stencil view
-	aHresult = myDevice->CreateDepthStencilView(depthBufferTexture, nullptr, &myDepthBuffer);
-	if (FAILED(aHresult))
-	{
-		depthBufferTexture->Release();
-		return false;
-	}
-
-	// Release depth buffer texture (optional, depends on usage)
-	//depthBufferTexture->Release();
-
-	return true;
-}
-bool GraphicsEngine::CreateFrameAndObjectBuffer(HRESULT& aHresult)
+bool GraphicsEngine::CreateConstantBufferRing()
 {
-	{ // constant buffers, framebuffer & objectbuffer
-		D3D11_BUFFER_DESC bufferDesc = { 0 };
-		bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-		bufferDesc.ByteWidth = sizeof(FrameBufferData);
-		aHresult = myDevice->CreateBuffer(&bufferDesc, nullptr, &myFrameBuffer);
-		if (FAILED(aHresult))
-		{
-			return false;
-		}
-
-		bufferDesc.ByteWidth = sizeof(ObjectBufferData);
-		aHresult = myDevice->CreateBuffer(&bufferDesc, nullptr, &myObjectBuffer);
-		if (FAILED(aHresult))
-		{
-			return false;
-		}
-
-		// assuming the layout doesn't change
-		myContext->VSSetConstantBuffers(0, 1, myFrameBuffer.GetAddressOf());
-		myContext->PSSetConstantBuffers(0, 1, myFrameBuffer.GetAddressOf());
-		myContext->VSSetConstantBuffers(1, 1, myObjectBuffer.GetAddressOf());
-	}
-	return true;
+	// Frame and object constants are written to the ring and bound where they landed, nothing to bind up front
+	return myConstantBufferRing.Init(myDevice.Get(), myContext.Get(), locConstantRingCapacity);
 }
 bool GraphicsEngine::CreateLightBuffer(HRESULT& aHresult)
 {
-	D3D11_BUFFER_DESC lightBufferDesc = {};
-	lightBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	lightBufferDesc.ByteWidth = sizeof(LightBuffer);
-	lightBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	lightBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-	aHresult = myDevice->CreateBuffer(&lightBufferDesc, nullptr, &myLightBuffer);
-	if (FAILED(aHresult))
+	if (!myLightBuffer.Init(myDevice.Get()))
 	{
+		aHresult = E_FAIL;
 		return false;
 	}
 
-	myContext->VSSetConstantBuffers(2, 1, myLightBuffer.GetAddressOf());
-	myContext->PSSetConstantBuffers(2, 1, myLightBuffer.GetAddressOf());
+	myRenderContext.VSSetConstantBuffers(2, 1, myLightBuffer.GetAddressOf());
+	myRenderContext.PSSetConstantBuffers(2, 1, myLightBuffer.GetAddressOf());
 
 	return true;
 }
@@ -562,7 +807,7 @@ bool GraphicsEngine::CreateTextureSamplerState(HRESULT& aHresult)
 		{
 			return false;
 		}
-		myContext->PSSetSamplers(0, 1, mySamplerState.GetAddressOf()); // Assuming slot 0
+		myRenderContext.PSSetSamplers(0, 1, mySamplerState.GetAddressOf()); // Assuming slot 0
 
 	}
 	return true;
@@ -602,7 +847,7 @@ bool GraphicsEngine::CreateRasterizerState(HRESULT& aHresult)
 		return false;
 	}
 
-	myContext->RSSetState(myRasterizerState.Get());
+	myRenderContext.RSSetState(myRasterizerState.Get());
 	return true;
 }
 bool GraphicsEngine::CreateBlendState(HRESULT& aHresult)
@@ -629,7 +874,7 @@ void GraphicsEngine::SetBlendState()
 {
 	float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 	UINT sampleMask = 0xffffffff;
-	myContext->OMSetBlendState(myBlendState.Get(), blendFactor, sampleMask);
+	myRenderContext.OMSetBlendState(myBlendState.Get(), blendFactor, sampleMask);
 }
 bool GraphicsEngine::CreateCamera(float aWidth, float aHeight)
 {
@@ -645,13 +890,13 @@ bool GraphicsEngine::CreateCamera(float aWidth, float aHeight)
 
 	return true;
 }
-void GraphicsEngine::SetupViewport() const
+void GraphicsEngine::SetupViewport(UINT aWidth, UINT aHeight) const
 {
 	D3D11_VIEWPORT viewport{};
 	viewport.TopLeftX = 0.0f;
 	viewport.TopLeftY = 0.0f;
-	viewport.Width = static_cast<float>(myBackBufferTextureWidth);
-	viewport.Height = static_cast<float>(myBackBufferTextureHeight);
+	viewport.Width = static_cast<float>(aWidth);
+	viewport.Height = static_cast<float>(aHeight);
 	viewport.MinDepth = 0.0f;
 	viewport.MaxDepth = 1.0f;
 
@@ -766,34 +1011,40 @@ void GraphicsEngine::PrintDebugMessages()
 void GraphicsEngine::CleanupAllExceptDevice()
 {
 	myObjectsToRender.clear();
+	myWaterPlane.reset();
+	myTerrainImpostor.reset();
 
 	if (myTextureManager)
 	{
 		myTextureManager.reset();
 	}
 
+	if (myGeometryRegistry)
+	{
+		myGeometryRegistry.reset();
+	}
+
 	if (myCamera)
 	{
 		myCamera.reset();
 	}
 
+	if (myInstanceBuffer) myInstanceBuffer.Reset();
+	myInstanceCapacity = 0;
 	if (mySamplerState) mySamplerState.Reset();
-	if (myObjectBuffer) myObjectBuffer.Reset();
-	if (myFrameBuffer) myFrameBuffer.Reset();
-	if (myDepthBuffer) myDepthBuffer.Reset();
+	myLightBuffer.Reset();
+	myConstantBufferRing = ConstantBufferRing();
+	myFrameGraph.Reset();
+	myFrameGraphTextures.Reset();
+	myReflectionTextures.Reset();
 	if (myBackBuffer) myBackBuffer.Reset();
-	for (int i = 0; i < 2; i++) 
-	{
-		if (myReflectionTexture[i]) myReflectionTexture[i].Reset();
-		if (myReflectionRTV[i]) myReflectionRTV[i].Reset();
-		if (myReflectionSRV[i]) myReflectionSRV[i].Reset();
-	}
 	if (mySwapChain) mySwapChain.Reset();
 	if (myContext)
 	{
 		myContext->ClearState(); // Clear all bound resources
 		myContext->Flush(); // Ensure all commands are finished
 		myContext.Reset();
+		myRenderContext.SetContext(nullptr);
 	}
 }
 void GraphicsEngine::ReportLiveObjects()
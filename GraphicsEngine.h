@@ -7,7 +7,20 @@
 #include "Sphere.h"
 #include "Pyramid.h"
 #include "Terrain.h"
+#include "Plane.h"
+#include "TerrainImpostor.h"
 #include "TextureManager.h"
+#include "GeometryRegistry.h"
+#include "InstanceBatcher.h"
+#include "RenderQueue.h"
+#include "RenderCommandBuffer.h"
+#include "StateFilteringContext.h"
+#include "ConstantBufferRing.h"
+#include "ConstantBuffer.h"
+#include "FrameGraph.h"
+#include "FrameGraphTexturePool.h"
+#include "ReflectionScheduler.h"
+#include "Frustum.h"
 #include "Includes/Camera.h"
 
 using Microsoft::WRL::ComPtr;
@@ -15,6 +28,15 @@ struct ID3D11Device;
 struct ID3D11DeviceContext;
 struct IDXGISwapChain;
 struct ID3D11RenderTargetView;
+struct ObjectBufferData;
+
+// Planar reflection resolution as a divisor of the back buffer size
+enum class ReflectionQuality : unsigned int
+{
+	Full = 1,
+	Half = 2,
+	Quarter = 4
+};
 
 class GraphicsEngine
 {
@@ -29,73 +51,101 @@ public:
 	bool Init(int aHeight, int aWidth, HWND aWindowHandle);
 	void Update(float aDeltaTime, CommonUtilities::InputHandler& anInputHandler);
 	void Render(float aDeltaTime);
-	void RenderScene(float aDeltaTime, bool isReflection);
-	void BindTextures(ID3D11ShaderResourceView* reflectionSRV);
+	void DeclareFrameGraph(float aDeltaTime);
+	bool UpdateReflectionTextures(const FrameGraphTextureDesc& aColorDesc, const FrameGraphTextureDesc& aDepthDesc);
+	ReflectionView GetReflectionView() const;
+	ID3D11RenderTargetView* GetFrameGraphRenderTarget(FrameGraphResource aResource) const;
+	ID3D11DepthStencilView* GetFrameGraphDepthStencil(FrameGraphResource aResource) const;
+	ID3D11ShaderResourceView* GetFrameGraphShaderResource(FrameGraphResource aResource) const;
+	void RenderReflection(float aDeltaTime, ID3D11RenderTargetView* aTarget, ID3D11DepthStencilView* aDepth);
+	void RenderScene(float aDeltaTime, bool isReflection, ID3D11ShaderResourceView* aReflection = nullptr, ID3D11ShaderResourceView* aReflectionDepth = nullptr);
+	void BindTextures(ID3D11ShaderResourceView* reflectionSRV, ID3D11ShaderResourceView* aReflectionDepth);
 	bool CreateDeviceAndSwapChain();
 	bool CreateRenderTarget(HRESULT& aHresult);
-	bool CreateDepthStencilState(HRESULT& aHresult) const;
-	bool CreateDepthBuffer(HRESULT& aHresult);
-	bool CreateFrameAndObjectBuffer(HRESULT& aHresult);
+	bool CreateDepthStencilState(HRESULT& aHresult);
+	bool CreateConstantBufferRing();
 	bool CreateLightBuffer(HRESULT& aHresult);
 	bool CreateTextureSamplerState(HRESULT& aHresult);
 	bool CreateRasterizerState(HRESULT& aHresult);
 	bool CreateBlendState(HRESULT& aHresult);
 	void SetBlendState();
-	bool CreateReflectionRenderTarget(HRESULT& aHresult);
 	bool CreateCamera(float aWidth, float aHeight);
-	void SetupViewport() const;
-	void UpdateFrameBuffer(float aDeltaTime);
+	void SetupViewport(UINT aWidth, UINT aHeight) const;
+	void UpdateFrameBuffer(float aDeltaTime, const CommonUtilities::Matrix4x4<float>& aProjection);
 	void UpdateFrameBufferForReflection();
-	void UpdateObjectBuffer(const std::shared_ptr<Object3D>& anObject) const;
+	void UpdateObjectBuffer(const std::shared_ptr<Object3D>& anObject);
+	void FillObjectBufferData(const Object3D& anObject, ObjectBufferData& someData) const;
 	void UpdateLightBuffer();
 	void UpdateTimeOfDay();
+	float GetSunElevation() const;
 	void RenderObjects(bool isReflection);
+	void RenderQueuedObjects(RenderPass aPass);
+	void ReplayRenderCommands();
+	void RenderInstanceBatches();
+	bool EnsureInstanceBuffer(UINT anInstanceCount);
 	bool CompileShaders(const std::wstring& shaderFolder);
 	void PrintDebugMessages();
+	void ReportFrameStats(float aDeltaTime);
 	void CleanupAllExceptDevice();
 	void ReportLiveObjects();
 	void CleanupDevice();
 	void CleanupInfoQueue();
 	CommonUtilities::Vector2<unsigned int> GetWindowSize() const { return myWindowSize; }
 	CommonUtilities::Vector2<float> GetRenderSize() const { return myRenderSize; }
-	unsigned int Align16(unsigned int aSize) { return ((aSize + 15) / 16) * 16; } // Aligns the size to 16 bytes
 
 	ID3D11Device* GetDevice() const { return myDevice.Get(); }
 	ID3D11DeviceContext* GetContext() const { return myContext.Get(); }
+	RenderQueue& GetRenderQueue() { return myRenderQueue; }
+	// State calls of the last frame that reached the context and the ones dropped as redundant
+	const StateFilterStats& GetStateFilterStats() const { return myStateFilterStats; }
 	IDXGISwapChain* GetSwapChain() const { return mySwapChain.Get(); }
 	ID3D11RenderTargetView* GetBackBuffer() const { return myBackBuffer.Get(); }
-	ID3D11DepthStencilView* GetDepthBuffer() const { return myDepthBuffer.Get(); }
-	ID3D11Buffer* GetFrameBuffer() const { return myFrameBuffer.Get(); }
-	ID3D11Buffer* GetObjectBuffer() const { return myObjectBuffer.Get(); }
+	// Passes of the last frame, which were culled and how many textures their transient resources took
+	const FrameGraph& GetFrameGraph() const { return myFrameGraph; }
 	Camera& GetCamera() { return *myCamera; }
 	Sphere& GetSphere() { return *mySphere; }
 	TextureManager& GetTextureManager() const { return *myTextureManager; }
+	GeometryRegistry& GetGeometryRegistry() const { return *myGeometryRegistry; }
 	const double& GetTimeOfDay() const { return myTimeOfDay; }
+	// Scales the projected size LODs are picked from, above 1 keeps finer levels further away
+	void SetLodBias(float aBias) { myLodBias = aBias; }
+	// Draws every mesh at this level for debugging, -1 picks by screen size again
+	void SetForcedLod(int aLod) { myForcedLod = aLod; }
+	// The water samples it with an edge-aware upsample below full resolution
+	void SetReflectionQuality(ReflectionQuality aQuality) { myReflectionQuality = aQuality; }
+	ReflectionQuality GetReflectionQuality() const { return myReflectionQuality; }
+	// How often the reflection is drawn again rather than reused from an earlier frame
+	void SetReflectionUpdatePolicy(const ReflectionUpdatePolicy& aPolicy) { myReflectionScheduler.SetPolicy(aPolicy); }
+	// Frames that drew the reflection and frames that reused it, with why each was drawn
+	const ReflectionStats& GetReflectionStats() const { return myReflectionScheduler.GetStats(); }
 
 
 private:
 	std::unique_ptr<TextureManager> myTextureManager;
+	std::unique_ptr<GeometryRegistry> myGeometryRegistry;
 
 	HRESULT myHResult;
 	float myElapsedTime = 0.0f;
 	ComPtr<ID3D11InfoQueue> myDebugInfoQueue;
 	ComPtr<ID3D11Device> myDevice;
 	ComPtr<ID3D11DeviceContext> myContext;
+	RenderContext myRenderContext; // Render code sets state through this, it drops calls that change nothing
+	StateFilterStats myStateFilterStats;
+	float myFrameStatsTime = 0.0f; // Since the frame stats were last printed
 	ComPtr<IDXGISwapChain> mySwapChain;
 	ComPtr<ID3D11RenderTargetView> myBackBuffer;
-	ComPtr<ID3D11DepthStencilView> myDepthBuffer;
-	ComPtr<ID3D11Buffer> myFrameBuffer;
-	ComPtr<ID3D11Buffer> myObjectBuffer;
-	ComPtr<ID3D11Buffer> myLightBuffer;
+	ConstantBufferRing myConstantBufferRing; // Frame and object constants, appended per draw
+	ConstantBuffer<LightBuffer> myLightBuffer; // Only uploaded on the frames lighting changes
 	ComPtr<ID3D11SamplerState> mySamplerState;
 	ComPtr<ID3D11RasterizerState> myRasterizerState;
 	ComPtr<ID3D11RasterizerState> myRasterizerStateWireframe;
 	ComPtr<ID3D11RasterizerState> myRasterizerStateFrontFaceCulling;
 	ComPtr<ID3D11BlendState> myBlendState;
-	int myCurrentReflectionBufferIndex;
-    ComPtr<ID3D11Texture2D> myReflectionTexture[2];
-	ComPtr<ID3D11RenderTargetView> myReflectionRTV[2];
-	ComPtr<ID3D11ShaderResourceView> myReflectionSRV[2];
+	FrameGraph myFrameGraph; // Declared again every frame
+	FrameGraphTexturePool myFrameGraphTextures;
+	FrameGraphTexturePool myReflectionTextures; // Color and depth, kept while the scheduler reuses them
+	ReflectionScheduler myReflectionScheduler;
+	Frustum myReflectionFrustum; // Of the reflected camera, objects outside it aren't drawn into the reflection
 	std::unique_ptr<Camera> myCamera;
 	std::unique_ptr<Camera> mySavedCamera;
 	std::shared_ptr<Sphere> mySphere;
@@ -107,8 +157,25 @@ private:
 
 	float myClearColor[4] = { 0.68f, 0.85f, 0.90f, 1.0f }; // Light blue
 	std::vector<std::shared_ptr<Object3D>> myObjectsToRender;
+	InstanceBatcher myInstanceBatcher;
+	RenderQueue myRenderQueue;
+	std::vector<size_t> myQueuedPassObjects;
+	WorkerPool myWorkerPool; // Started with the engine, records the pass commands every frame
+	ParallelRenderCommands myRenderCommands;
+	std::vector<std::pair<const void*, UINT>> myRecordedConstants; // Data and size of each constant update being replayed
+	ComPtr<ID3D11Buffer> myInstanceBuffer;
+	UINT myInstanceCapacity = 0;
 	double myTimeOfDay = {};
 	int myRenderMode = 0;
+	float myLodBias = 1.0f;
+	int myForcedLod = -1;
 	std::shared_ptr<Terrain> myTerrain;
+	std::shared_ptr<Plane> myWaterPlane;
+	std::shared_ptr<TerrainImpostor> myTerrainImpostor;
+	bool myUseTerrainImpostor = true;
+	CommonUtilities::Vector3<float> myTerrainPosition = { 0.0f, -25.0f, 100.0f };
+	int myTerrainNormalMapResolution = 1024; // Four texels per terrain tile
 	float myReflectionPlaneHeight;
+	ReflectionQuality myReflectionQuality = ReflectionQuality::Half;
+	CommonUtilities::Vector3<float> mySunAzimuth = { -0.70710678f, 0.0f, -0.70710678f }; // Horizontal direction towards the rising sun
 };
\ No newline at end of file
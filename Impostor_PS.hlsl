@@ -0,0 +1,22 @@
+#include "Common.hlsli"
+
+PixelOutput main(PixelInputType input)
+{
+    PixelOutput result;
+
+    // Baked terrain panorama, alpha 0 is sky and otherwise how much of the color made it through the haze
+    float4 panorama = defaultTexture.Sample(defaultSampler, input.uv);
+    clip(panorama.a - 0.5f / 255.0f);
+
+    float3 ambient = ambientColor2.rgb * ambientIntensity2 * 0.5f;
+    float3 sun = directionalLightColor.rgb * directionalLightIntensity * saturate(directionalLightDirection.y);
+    float3 litColor = panorama.rgb * (ambient + sun);
+
+    // Define the clear color
+    float3 clearColor = float3(0.68f, 0.85f, 0.90f);
+    float transmittance = (panorama.a * 255.0f - 1.0f) / 254.0f;
+
+    result.color.rgb = lerp(clearColor, litColor, transmittance);
+    result.color.a = 1.0f;
+    return result;
+}
@@ -0,0 +1,19 @@
+#include "Common.hlsli"
+
+PixelInputType main(PositionTexCoordVertexInputType input)
+{
+    PixelInputType output;
+
+    float4 vertexWorldPos = mul(modelToWorld, input.position);
+
+    output.position = mul(worldToClip, vertexWorldPos);
+    output.worldPosition = vertexWorldPos;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    output.uv = input.uv;
+    output.normal = float3(0.0f, 0.0f, 0.0f); // Shading is baked into the panorama
+    output.tangent = float3(0.0f, 0.0f, 0.0f);
+    output.bitangent = float3(0.0f, 0.0f, 0.0f);
+    output.depth = 0.0f;
+
+    return output;
+}
@@ -0,0 +1,52 @@
+#include "InstanceBatcher.h"
+
+#include <algorithm>
+#include <tuple>
+
+bool InstanceKey::operator<(const InstanceKey& anOther) const
+{
+    return std::tie(geometry, lod, vertexShader, pixelShader, texture) < std::tie(anOther.geometry, anOther.lod, anOther.vertexShader, anOther.pixelShader, anOther.texture);
+}
+
+bool InstanceKey::operator==(const InstanceKey& anOther) const
+{
+    return geometry == anOther.geometry && lod == anOther.lod && vertexShader == anOther.vertexShader && pixelShader == anOther.pixelShader && texture == anOther.texture;
+}
+
+void InstanceBatcher::Clear()
+{
+    myInstances.clear();
+    myBatches.clear();
+    myTransforms.clear();
+}
+
+void InstanceBatcher::Add(const InstanceKey& aKey, const CommonUtilities::Matrix4x4<float>& aTransform, size_t anObjectIndex)
+{
+    myInstances.push_back({ aKey, aTransform, anObjectIndex });
+}
+
+void InstanceBatcher::Build(unsigned int aMaxInstancesPerBatch)
+{
+    myBatches.clear();
+    myTransforms.clear();
+    myTransforms.reserve(myInstances.size());
+
+    // Stable so instances keep submission order inside their batch
+    std::stable_sort(myInstances.begin(), myInstances.end(), [](const Instance& aLeft, const Instance& aRight) { return aLeft.key < aRight.key; });
+
+    for (const Instance& instance : myInstances)
+    {
+        const bool isFull = aMaxInstancesPerBatch > 0 && !myBatches.empty() && myBatches.back().instanceCount >= aMaxInstancesPerBatch;
+        if (myBatches.empty() || !(myBatches.back().key == instance.key) || isFull)
+        {
+            InstanceBatch batch;
+            batch.key = instance.key;
+            batch.objectIndex = instance.objectIndex;
+            batch.firstInstance = static_cast<unsigned int>(myTransforms.size());
+            myBatches.push_back(batch);
+        }
+
+        myTransforms.push_back(instance.transform);
+        ++myBatches.back().instanceCount;
+    }
+}
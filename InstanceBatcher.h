@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "Includes/Matrix4x4.h"
+
+// Everything that has to match for two objects to be drawn in one instanced call, as opaque handles
+struct InstanceKey
+{
+    const void* geometry = nullptr;
+    const void* vertexShader = nullptr;
+    const void* pixelShader = nullptr;
+    const void* texture = nullptr;
+    size_t lod = 0;
+
+    bool operator<(const InstanceKey& anOther) const;
+    bool operator==(const InstanceKey& anOther) const;
+};
+
+struct InstanceBatch
+{
+    InstanceKey key;
+    size_t objectIndex = 0;         // First object of the batch, used to bind the shared mesh and material
+    unsigned int firstInstance = 0; // Offset into GetTransforms()
+    unsigned int instanceCount = 0;
+};
+
+// Groups objects by mesh and material and packs their transforms so every group is one contiguous range.
+// The batching only looks at opaque handles, the GPU side uploads GetTransforms() and draws each batch.
+class InstanceBatcher
+{
+public:
+    void Clear();
+    void Add(const InstanceKey& aKey, const CommonUtilities::Matrix4x4<float>& aTransform, size_t anObjectIndex);
+    // Batches are split at aMaxInstancesPerBatch, 0 means no limit
+    void Build(unsigned int aMaxInstancesPerBatch = 0);
+
+    bool IsEmpty() const { return myInstances.empty(); }
+    size_t GetInstanceCount() const { return myInstances.size(); }
+    const std::vector<InstanceBatch>& GetBatches() const { return myBatches; }
+    const std::vector<CommonUtilities::Matrix4x4<float>>& GetTransforms() const { return myTransforms; }
+
+private:
+    struct Instance
+    {
+        InstanceKey key;
+        CommonUtilities::Matrix4x4<float> transform;
+        size_t objectIndex;
+    };
+
+    std::vector<Instance> myInstances;
+    std::vector<InstanceBatch> myBatches;
+    std::vector<CommonUtilities::Matrix4x4<float>> myTransforms;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstring>
+
+#include "D3D11Types.h"
+#include "InstanceBatcher.h"
+
+// Uploads every transform with one discard map and hands each batch to aDrawBatch. Context only needs
+// ID3D11DeviceContext's Map/Unmap, so a recording stand-in can be used to check the calls without a device.
+template <class Context, class Buffer, class DrawBatch>
+bool SubmitInstanceBatches(Context& aContext, Buffer* anInstanceBuffer, const InstanceBatcher& aBatcher, const DrawBatch& aDrawBatch)
+{
+    const auto& transforms = aBatcher.GetTransforms();
+    if (transforms.empty())
+    {
+        return true;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    if (FAILED(aContext.Map(anInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+    {
+        return false;
+    }
+    std::memcpy(mappedResource.pData, transforms.data(), transforms.size() * sizeof(transforms[0]));
+    aContext.Unmap(anInstanceBuffer, 0);
+
+    for (const InstanceBatch& batch : aBatcher.GetBatches())
+    {
+        aDrawBatch(batch);
+    }
+    return true;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Includes/MeehanVector3.hpp"
 #include "Includes/MeehanVector4.hpp"
+#include "ConstantBuffer.h"
 
 struct LightBuffer
 {
@@ -12,5 +13,14 @@ struct LightBuffer
     float ambientIntensity1;
     float ambientIntensity2;
     float renderMode;
-    float padding1;
+    float sunElevation; // Radians above the sunrise horizon, past PI / 2 the sun is on the sunset side
 };
+CHECK_HLSL_PACKING(LightBuffer, directionalLightDirection);
+CHECK_HLSL_PACKING(LightBuffer, directionalLightIntensity);
+CHECK_HLSL_PACKING(LightBuffer, directionalLightColor);
+CHECK_HLSL_PACKING(LightBuffer, ambientColor1);
+CHECK_HLSL_PACKING(LightBuffer, ambientColor2);
+CHECK_HLSL_PACKING(LightBuffer, ambientIntensity1);
+CHECK_HLSL_PACKING(LightBuffer, ambientIntensity2);
+CHECK_HLSL_PACKING(LightBuffer, renderMode);
+CHECK_HLSL_PACKING(LightBuffer, sunElevation);
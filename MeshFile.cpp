@@ -0,0 +1,288 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    uint64_t AlignOffset(uint64_t anOffset)
+    {
+        return (anOffset + locMeshFileAlignment - 1) & ~(locMeshFileAlignment - 1);
+    }
+
+    bool IsSectionInside(uint64_t anOffset, uint64_t aSize, uint64_t aFileSize)
+    {
+        return anOffset <= aFileSize && aSize <= aFileSize - anOffset;
+    }
+
+    uint32_t GetFormatSize(uint32_t aFormat)
+    {
+        switch (aFormat)
+        {
+        case MeshElementFloat2: return 2 * sizeof(float);
+        case MeshElementFloat3: return 3 * sizeof(float);
+        case MeshElementFloat4: return 4 * sizeof(float);
+        case MeshElementUnorm16x4: return 4 * sizeof(uint16_t);
+        case MeshElementUnorm1010102: return sizeof(uint32_t);
+        case MeshElementUnorm8x4: return sizeof(uint32_t);
+        case MeshElementHalf2: return 2 * sizeof(uint16_t);
+        default: return 0;
+        }
+    }
+
+    bool IsKnownFormat(uint32_t aFormat)
+    {
+        return GetFormatSize(aFormat) != 0;
+    }
+
+    // Everything Open trusts later on, a truncated or foreign file must never be read past its end
+    bool ValidateMeshFile(const unsigned char* someData, size_t aSize, const std::string& aPath)
+    {
+        if (aSize < sizeof(MeshFileHeader))
+        {
+            std::cerr << "Mesh file too small: " << aPath << std::endl;
+            return false;
+        }
+
+        const MeshFileHeader& header = *reinterpret_cast<const MeshFileHeader*>(someData);
+        if (std::memcmp(header.magic, locMeshFileMagic, sizeof(header.magic)) != 0 || header.version != locMeshFileVersion)
+        {
+            std::cerr << "Not a version " << locMeshFileVersion << " mesh file: " << aPath << std::endl;
+            return false;
+        }
+        if (header.fileSize != aSize || (header.indexSize != 2 && header.indexSize != 4) || header.vertexStride == 0 ||
+            header.elementCount == 0 || header.lodCount == 0)
+        {
+            std::cerr << "Corrupt mesh file header: " << aPath << std::endl;
+            return false;
+        }
+
+        const uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * header.vertexStride;
+        const uint64_t indexBytes = static_cast<uint64_t>(header.indexCount) * header.indexSize;
+        if (!IsSectionInside(header.elementsOffset, sizeof(MeshFileElement) * static_cast<uint64_t>(header.elementCount), aSize) ||
+            !IsSectionInside(header.lodsOffset, sizeof(MeshFileLod) * static_cast<uint64_t>(header.lodCount), aSize) ||
+            !IsSectionInside(header.vertexOffset, vertexBytes, aSize) ||
+            !IsSectionInside(header.indexOffset, indexBytes, aSize) ||
+            header.elementsOffset % alignof(MeshFileElement) != 0 || header.lodsOffset % alignof(MeshFileLod) != 0 ||
+            header.indexOffset % header.indexSize != 0)
+        {
+            std::cerr << "Mesh file sections out of bounds: " << aPath << std::endl;
+            return false;
+        }
+
+        const MeshFileElement* elements = reinterpret_cast<const MeshFileElement*>(someData + header.elementsOffset);
+        for (uint32_t i = 0; i < header.elementCount; ++i)
+        {
+            const MeshFileElement& element = elements[i];
+            if (std::memchr(element.semantic, 0, sizeof(element.semantic)) == nullptr || !IsKnownFormat(element.format) ||
+                element.offset + GetFormatSize(element.format) > header.vertexStride)
+            {
+                std::cerr << "Unsupported vertex element " << i << " in mesh file: " << aPath << std::endl;
+                return false;
+            }
+        }
+
+        const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(someData + header.lodsOffset);
+        for (uint32_t i = 0; i < header.lodCount; ++i)
+        {
+            if (static_cast<uint64_t>(lods[i].startIndex) + lods[i].indexCount > header.indexCount)
+            {
+                std::cerr << "Detail level " << i << " reads past the index data in mesh file: " << aPath << std::endl;
+                return false;
+            }
+            if (lods[i].baseVertex < 0 || static_cast<uint64_t>(lods[i].baseVertex) + lods[i].vertexCount > header.vertexCount)
+            {
+                std::cerr << "Detail level " << i << " reads past the vertex data in mesh file: " << aPath << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+MeshFileElement MakeMeshFileElement(const char* aSemantic, MeshElementFormat aFormat, uint32_t anOffset)
+{
+    MeshFileElement element = {};
+    std::strncpy(element.semantic, aSemantic, sizeof(element.semantic) - 1);
+    element.format = aFormat;
+    element.offset = anOffset;
+    return element;
+}
+
+bool WriteMeshFile(const std::string& aPath, const MeshFileData& someData)
+{
+    if (someData.elements.empty() || someData.vertexStride == 0 || someData.vertices.size() % someData.vertexStride != 0)
+    {
+        std::cerr << "Mesh data does not match its vertex layout, not writing " << aPath << std::endl;
+        return false;
+    }
+
+    const uint32_t vertexCount = static_cast<uint32_t>(someData.vertices.size() / someData.vertexStride);
+    std::vector<MeshFileLod> lods;
+    for (const MeshLod& lod : someData.lods)
+    {
+        lods.push_back({ lod.startIndex, lod.indexCount, lod.baseVertex, lod.vertexCount, lod.maxScreenSize, 0 });
+    }
+    if (lods.empty())
+    {
+        lods.push_back({ 0, static_cast<uint32_t>(someData.indices.size()), 0, 0, FLT_MAX, 0 });
+    }
+
+    // Levels add baseVertex on the GPU, 16 bit indices only have to cover the largest level
+    uint32_t maxIndex = 0;
+    for (uint32_t index : someData.indices)
+    {
+        maxIndex = std::max(maxIndex, index);
+    }
+    const uint32_t indexSize = maxIndex <= 0xFFFF ? 2 : 4;
+
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, locMeshFileMagic, sizeof(header.magic));
+    header.version = locMeshFileVersion;
+    header.vertexCount = vertexCount;
+    header.vertexStride = someData.vertexStride;
+    header.indexCount = static_cast<uint32_t>(someData.indices.size());
+    header.indexSize = indexSize;
+    header.elementCount = static_cast<uint32_t>(someData.elements.size());
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    std::copy(someData.boundsMin, someData.boundsMin + 3, header.boundsMin);
+    std::copy(someData.boundsMax, someData.boundsMax + 3, header.boundsMax);
+    header.boundingRadius = someData.boundingRadius;
+    header.elementsOffset = AlignOffset(sizeof(MeshFileHeader));
+    header.lodsOffset = AlignOffset(header.elementsOffset + sizeof(MeshFileElement) * someData.elements.size());
+    header.vertexOffset = AlignOffset(header.lodsOffset + sizeof(MeshFileLod) * lods.size());
+    header.indexOffset = AlignOffset(header.vertexOffset + someData.vertices.size());
+    header.fileSize = header.indexOffset + static_cast<uint64_t>(header.indexCount) * indexSize;
+
+    std::vector<unsigned char> file(static_cast<size_t>(header.fileSize), 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + header.elementsOffset, someData.elements.data(), sizeof(MeshFileElement) * someData.elements.size());
+    std::memcpy(file.data() + header.lodsOffset, lods.data(), sizeof(MeshFileLod) * lods.size());
+    std::memcpy(file.data() + header.vertexOffset, someData.vertices.data(), someData.vertices.size());
+    if (indexSize == 2)
+    {
+        uint16_t* indices = reinterpret_cast<uint16_t*>(file.data() + header.indexOffset);
+        for (size_t i = 0; i < someData.indices.size(); ++i)
+        {
+            indices[i] = static_cast<uint16_t>(someData.indices[i]);
+        }
+    }
+    else
+    {
+        std::memcpy(file.data() + header.indexOffset, someData.indices.data(), sizeof(uint32_t) * someData.indices.size());
+    }
+
+    std::ofstream stream(aPath, std::ios::binary | std::ios::trunc);
+    if (!stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size())))
+    {
+        std::cerr << "Failed to write mesh file: " << aPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+MappedMeshFile::~MappedMeshFile()
+{
+    Close();
+}
+
+bool MappedMeshFile::Open(const std::string& aPath)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Failed to open mesh file: " << aPath << std::endl;
+        return false;
+    }
+    myFile = file;
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        std::cerr << "Failed to read the size of mesh file: " << aPath << std::endl;
+        Close();
+        return false;
+    }
+    mySize = static_cast<size_t>(size.QuadPart);
+
+    myMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    myData = myMapping ? static_cast<const unsigned char*>(MapViewOfFile(myMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+    const int file = open(aPath.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        std::cerr << "Failed to open mesh file: " << aPath << std::endl;
+        return false;
+    }
+
+    struct stat status = {};
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        std::cerr << "Failed to read the size of mesh file: " << aPath << std::endl;
+        close(file);
+        return false;
+    }
+    mySize = static_cast<size_t>(status.st_size);
+
+    // The descriptor can go as soon as the mapping exists
+    void* data = mmap(nullptr, mySize, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    myData = data != MAP_FAILED ? static_cast<const unsigned char*>(data) : nullptr;
+#endif
+
+    if (!myData)
+    {
+        std::cerr << "Failed to map mesh file: " << aPath << std::endl;
+        Close();
+        return false;
+    }
+    if (!ValidateMeshFile(myData, mySize, aPath))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedMeshFile::Close()
+{
+#ifdef _WIN32
+    if (myData)
+    {
+        UnmapViewOfFile(myData);
+    }
+    if (myMapping)
+    {
+        CloseHandle(myMapping);
+    }
+    if (myFile)
+    {
+        CloseHandle(myFile);
+    }
+    myMapping = nullptr;
+    myFile = nullptr;
+#else
+    if (myData)
+    {
+        munmap(const_cast<unsigned char*>(myData), mySize);
+    }
+#endif
+    myData = nullptr;
+    mySize = 0;
+}
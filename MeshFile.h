@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshLod.h"
+
+// Binary mesh container, laid out so a loader can hand the mapped file straight to the GPU:
+//   MeshFileHeader | MeshFileElement[elementCount] | MeshFileLod[lodCount] | vertices | indices
+// Every section starts on a locMeshFileAlignment boundary, the header records where.
+// Portable on purpose, the converter builds on Linux without the D3D headers.
+
+constexpr char locMeshFileMagic[4] = { 'M', 'E', 'S', 'H' };
+constexpr uint32_t locMeshFileVersion = 1;
+constexpr uint64_t locMeshFileAlignment = 64;
+
+// Numeric values of the DXGI_FORMATs the elements use, checked against d3d11.h where the file is uploaded
+enum MeshElementFormat : uint32_t
+{
+    MeshElementFloat4 = 2,          // DXGI_FORMAT_R32G32B32A32_FLOAT
+    MeshElementFloat3 = 6,          // DXGI_FORMAT_R32G32B32_FLOAT
+    MeshElementUnorm16x4 = 11,      // DXGI_FORMAT_R16G16B16A16_UNORM, a POSITION in it is quantized to the header bounds
+    MeshElementFloat2 = 16,         // DXGI_FORMAT_R32G32_FLOAT
+    MeshElementUnorm1010102 = 24,   // DXGI_FORMAT_R10G10B10A2_UNORM
+    MeshElementUnorm8x4 = 28,       // DXGI_FORMAT_R8G8B8A8_UNORM
+    MeshElementHalf2 = 34           // DXGI_FORMAT_R16G16_FLOAT
+};
+
+struct MeshFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    uint32_t indexCount;
+    uint32_t indexSize;     // 2 or 4 bytes
+    uint32_t elementCount;
+    uint32_t lodCount;
+    float boundsMin[3];
+    float boundingRadius;   // Around the mesh origin
+    float boundsMax[3];
+    uint32_t reserved;
+    uint64_t elementsOffset;
+    uint64_t lodsOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t fileSize;
+};
+
+struct MeshFileElement
+{
+    char semantic[24];      // Null terminated
+    uint32_t semanticIndex;
+    uint32_t format;        // MeshElementFormat
+    uint32_t offset;        // Byte offset inside a vertex
+    uint32_t reserved;
+};
+
+struct MeshFileLod
+{
+    uint32_t startIndex;
+    uint32_t indexCount;
+    int32_t baseVertex;
+    uint32_t vertexCount;
+    float maxScreenSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(MeshFileHeader) == 104, "MeshFileHeader is part of the file format");
+static_assert(sizeof(MeshFileElement) == 40, "MeshFileElement is part of the file format");
+static_assert(sizeof(MeshFileLod) == 24, "MeshFileLod is part of the file format");
+
+// Everything WriteMeshFile needs, vertices already packed to the layout in someElements
+struct MeshFileData
+{
+    std::vector<MeshFileElement> elements;
+    uint32_t vertexStride = 0;
+    std::vector<unsigned char> vertices;
+    std::vector<uint32_t> indices;  // Written as 16 bit when every index fits
+    std::vector<MeshLod> lods;      // Empty means one level covering all indices
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+    float boundingRadius = 0.0f;
+};
+
+MeshFileElement MakeMeshFileElement(const char* aSemantic, MeshElementFormat aFormat, uint32_t anOffset);
+bool WriteMeshFile(const std::string& aPath, const MeshFileData& someData);
+
+// Read-only view of a mesh file in mapped memory, the pointers stay valid until Close or destruction
+class MappedMeshFile
+{
+public:
+    MappedMeshFile() = default;
+    ~MappedMeshFile();
+    MappedMeshFile(const MappedMeshFile&) = delete;
+    MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+
+    // Maps the file and validates the header and section bounds, prints the reason on failure
+    bool Open(const std::string& aPath);
+    void Close();
+
+    const MeshFileHeader& GetHeader() const { return *reinterpret_cast<const MeshFileHeader*>(myData); }
+    const MeshFileElement* GetElements() const { return reinterpret_cast<const MeshFileElement*>(myData + GetHeader().elementsOffset); }
+    const MeshFileLod* GetLods() const { return reinterpret_cast<const MeshFileLod*>(myData + GetHeader().lodsOffset); }
+    const void* GetVertexData() const { return myData + GetHeader().vertexOffset; }
+    const void* GetIndexData() const { return myData + GetHeader().indexOffset; }
+    size_t GetVertexDataSize() const { return static_cast<size_t>(GetHeader().vertexCount) * GetHeader().vertexStride; }
+    size_t GetIndexDataSize() const { return static_cast<size_t>(GetHeader().indexCount) * GetHeader().indexSize; }
+
+private:
+    const unsigned char* myData = nullptr;
+    size_t mySize = 0;
+#ifdef _WIN32
+    void* myFile = nullptr;
+    void* myMapping = nullptr;
+#endif
+};
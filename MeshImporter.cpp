@@ -0,0 +1,1454 @@
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "MeshTangents.h"
+#include "ParallelFor.h"
+
+namespace
+{
+    constexpr size_t locMinObjChunkSize = 1 << 20; // Smaller files aren't worth a thread per chunk
+    constexpr int locMaxGltfNodeDepth = 64;
+
+    using ImportClock = std::chrono::high_resolution_clock;
+
+    float GetMilliseconds(ImportClock::time_point aStart)
+    {
+        return std::chrono::duration<float, std::milli>(ImportClock::now() - aStart).count();
+    }
+
+    bool ReadFileBytes(const std::string& aPath, std::string& someData)
+    {
+        std::ifstream file(aPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        const std::streamoff size = file.tellg();
+        someData.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        return size == 0 || static_cast<bool>(file.read(someData.data(), size));
+    }
+
+    std::string GetExtension(const std::string& aPath)
+    {
+        const size_t dot = aPath.find_last_of('.');
+        std::string extension = dot == std::string::npos ? std::string() : aPath.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char aCharacter) { return static_cast<char>(std::tolower(aCharacter)); });
+        return extension;
+    }
+
+    std::string GetDirectory(const std::string& aPath)
+    {
+        const size_t slash = aPath.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : aPath.substr(0, slash + 1);
+    }
+
+    // Hash of every byte of a vertex, computed up front so merging only does table lookups
+    uint64_t HashVertex(const Vertex& aVertex)
+    {
+        uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+        std::memcpy(words, &aVertex, sizeof(words));
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t word : words)
+        {
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Merges bit identical vertices, someRemap receives the new index of every old vertex
+    void WeldVertices(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, std::vector<UINT>& someRemap)
+    {
+        std::vector<uint64_t> hashes(someVertices.size());
+        ParallelFor(0, static_cast<int>(someVertices.size()), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                hashes[i] = HashVertex(someVertices[i]);
+            }
+        });
+
+        std::unordered_map<uint64_t, UINT> firstWithHash;
+        firstWithHash.reserve(someVertices.size());
+        std::vector<Vertex> welded;
+        welded.reserve(someVertices.size());
+        someRemap.resize(someVertices.size());
+        for (size_t i = 0; i < someVertices.size(); ++i)
+        {
+            auto [it, isNew] = firstWithHash.emplace(hashes[i], static_cast<UINT>(welded.size()));
+            // A collision between different vertices just keeps both
+            if (isNew || std::memcmp(&welded[it->second], &someVertices[i], sizeof(Vertex)) != 0)
+            {
+                someRemap[i] = static_cast<UINT>(welded.size());
+                welded.push_back(someVertices[i]);
+            }
+            else
+            {
+                someRemap[i] = it->second;
+            }
+        }
+
+        for (UINT& index : someIndices)
+        {
+            index = someRemap[index];
+        }
+        someVertices.swap(welded);
+    }
+
+    // Normals and tangents for the vertices flagged in the masks, masks are per vertex
+    void GenerateMissingFrames(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, const std::vector<char>& someMissingNormals,
+        const std::vector<char>& someMissingTangents, MeshImportStats& someStats)
+    {
+        someStats.generatedNormals = std::find(someMissingNormals.begin(), someMissingNormals.end(), 1) != someMissingNormals.end();
+        someStats.generatedTangents = std::find(someMissingTangents.begin(), someMissingTangents.end(), 1) != someMissingTangents.end();
+        if (someStats.generatedNormals)
+        {
+            GenerateNormals(someVertices, someIndices, someMissingNormals);
+        }
+        if (someStats.generatedTangents)
+        {
+            GenerateTangents(someVertices, someIndices, someMissingTangents);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // OBJ
+    //--------------------------------------------------------------------------------------------------------------
+
+    constexpr int locObjMissing = INT_MIN;
+
+    enum ObjRelativeFlags : unsigned char
+    {
+        ObjRelativePosition = 1,
+        ObjRelativeTexCoord = 2,
+        ObjRelativeNormal = 4
+    };
+
+    struct ObjCorner
+    {
+        int position = locObjMissing;
+        int texCoord = locObjMissing;
+        int normal = locObjMissing;
+        unsigned char relative = 0; // Fields given as negative indices, stored relative to the chunk's first element until resolved
+
+        bool operator==(const ObjCorner& anOther) const
+        {
+            return position == anOther.position && texCoord == anOther.texCoord && normal == anOther.normal;
+        }
+    };
+
+    struct ObjCornerHash
+    {
+        size_t operator()(const ObjCorner& aCorner) const
+        {
+            uint64_t hash = static_cast<uint32_t>(aCorner.position) * 0x9E3779B97F4A7C15ull;
+            hash ^= (static_cast<uint32_t>(aCorner.texCoord) + 0x7F4A7C15ull) * 0xC2B2AE3D27D4EB4Full;
+            hash ^= (static_cast<uint32_t>(aCorner.normal) + 0x27D4EB4Full) * 0x165667B19E3779F9ull;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+    };
+
+    // Open addressing map from corners to indices. A node based map allocated per corner and dominated import times.
+    class ObjCornerTable
+    {
+    public:
+        explicit ObjCornerTable(size_t anExpectedCount)
+        {
+            size_t capacity = 16;
+            while (capacity < anExpectedCount * 2)
+            {
+                capacity *= 2;
+            }
+            Allocate(capacity);
+        }
+
+        // The index already stored for aCorner, or anIndex after storing it. second is true when aCorner was new.
+        std::pair<UINT, bool> Insert(const ObjCorner& aCorner, UINT anIndex)
+        {
+            if ((myCount + 1) * 2 > myIndices.size())
+            {
+                Grow();
+            }
+
+            size_t slot = ObjCornerHash()(aCorner) & myMask;
+            while (myIndices[slot] != locEmptySlot)
+            {
+                if (myCorners[slot] == aCorner)
+                {
+                    return { myIndices[slot], false };
+                }
+                slot = (slot + 1) & myMask;
+            }
+            myCorners[slot] = aCorner;
+            myIndices[slot] = anIndex;
+            ++myCount;
+            return { anIndex, true };
+        }
+
+    private:
+        static constexpr UINT locEmptySlot = UINT_MAX;
+
+        void Allocate(size_t aCapacity)
+        {
+            myCorners.assign(aCapacity, ObjCorner());
+            myIndices.assign(aCapacity, locEmptySlot);
+            myMask = aCapacity - 1;
+            myCount = 0;
+        }
+
+        void Grow()
+        {
+            std::vector<ObjCorner> corners;
+            std::vector<UINT> indices;
+            corners.swap(myCorners);
+            indices.swap(myIndices);
+            Allocate(indices.size() * 2);
+            for (size_t slot = 0; slot < indices.size(); ++slot)
+            {
+                if (indices[slot] != locEmptySlot)
+                {
+                    Insert(corners[slot], indices[slot]);
+                }
+            }
+        }
+
+        std::vector<ObjCorner> myCorners;
+        std::vector<UINT> myIndices;
+        size_t myMask = 0;
+        size_t myCount = 0;
+    };
+
+    // One newline aligned slice of the file, parsed and deduplicated on its own thread
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        std::vector<float> positions;
+        std::vector<float> texCoords;
+        std::vector<float> normals;
+        std::vector<ObjCorner> corners;         // Three per triangle
+        std::vector<ObjCorner> uniqueCorners;
+        std::vector<UINT> localIndices;         // Into uniqueCorners
+        std::vector<UINT> remap;                // uniqueCorners to mesh vertices
+        size_t positionOffset = 0;
+        size_t texCoordOffset = 0;
+        size_t normalOffset = 0;
+        size_t indexOffset = 0;
+        std::string error;
+    };
+
+    const char* SkipSpaces(const char* aCursor, const char* anEnd)
+    {
+        while (aCursor < anEnd && (*aCursor == ' ' || *aCursor == '\t'))
+        {
+            ++aCursor;
+        }
+        return aCursor;
+    }
+
+    const char* SkipToken(const char* aCursor, const char* anEnd)
+    {
+        while (aCursor < anEnd && *aCursor != ' ' && *aCursor != '\t')
+        {
+            ++aCursor;
+        }
+        return aCursor;
+    }
+
+    // Components the line doesn't have stay 0
+    void ParseObjFloats(const char* aCursor, const char* anEnd, float* someValues, int aCount)
+    {
+        for (int i = 0; i < aCount; ++i)
+        {
+            aCursor = SkipSpaces(aCursor, anEnd);
+            if (aCursor < anEnd && *aCursor == '+')
+            {
+                ++aCursor;
+            }
+            float value = 0.0f;
+            const std::from_chars_result result = std::from_chars(aCursor, anEnd, value);
+            if (result.ec == std::errc())
+            {
+                aCursor = result.ptr;
+            }
+            someValues[i] = value;
+        }
+    }
+
+    // OBJ indices are 1-based, negative ones count back from the last element read so far
+    int ResolveObjIndex(int anIndex, size_t aChunkCount, unsigned char aFlag, unsigned char& someRelative)
+    {
+        if (anIndex > 0)
+        {
+            return anIndex - 1;
+        }
+        if (anIndex < 0)
+        {
+            someRelative |= aFlag;
+            return static_cast<int>(aChunkCount) + anIndex;
+        }
+        return locObjMissing;
+    }
+
+    ObjCorner ParseObjCorner(const char* aCursor, const char* anEnd, const ObjChunk& aChunk)
+    {
+        int fields[3] = { 0, 0, 0 };
+        for (int field = 0; field < 3 && aCursor < anEnd; ++field)
+        {
+            if (*aCursor != '/')
+            {
+                const std::from_chars_result result = std::from_chars(aCursor, anEnd, fields[field]);
+                aCursor = result.ptr;
+            }
+            if (aCursor >= anEnd || *aCursor != '/')
+            {
+                break;
+            }
+            ++aCursor;
+        }
+
+        ObjCorner corner;
+        corner.position = ResolveObjIndex(fields[0], aChunk.positions.size() / 3, ObjRelativePosition, corner.relative);
+        corner.texCoord = ResolveObjIndex(fields[1], aChunk.texCoords.size() / 2, ObjRelativeTexCoord, corner.relative);
+        corner.normal = ResolveObjIndex(fields[2], aChunk.normals.size() / 3, ObjRelativeNormal, corner.relative);
+        return corner;
+    }
+
+    void ParseObjChunk(ObjChunk& aChunk)
+    {
+        std::vector<ObjCorner> polygon;
+        const char* cursor = aChunk.begin;
+        while (cursor < aChunk.end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', aChunk.end - cursor));
+            lineEnd = lineEnd ? lineEnd : aChunk.end;
+            const char* next = lineEnd + (lineEnd < aChunk.end ? 1 : 0);
+            if (lineEnd > cursor && lineEnd[-1] == '\r')
+            {
+                --lineEnd;
+            }
+
+            cursor = SkipSpaces(cursor, lineEnd);
+            const char* keywordEnd = SkipToken(cursor, lineEnd);
+            const size_t keywordLength = keywordEnd - cursor;
+            if (keywordLength == 1 && cursor[0] == 'v')
+            {
+                // Mirrored z turns the right handed file left handed and its counter-clockwise faces into the engine's winding
+                float position[3];
+                ParseObjFloats(keywordEnd, lineEnd, position, 3);
+                aChunk.positions.insert(aChunk.positions.end(), { position[0], position[1], -position[2] });
+            }
+            else if (keywordLength == 2 && cursor[0] == 'v' && cursor[1] == 't')
+            {
+                float texCoord[2];
+                ParseObjFloats(keywordEnd, lineEnd, texCoord, 2);
+                aChunk.texCoords.insert(aChunk.texCoords.end(), { texCoord[0], 1.0f - texCoord[1] });
+            }
+            else if (keywordLength == 2 && cursor[0] == 'v' && cursor[1] == 'n')
+            {
+                float normal[3];
+                ParseObjFloats(keywordEnd, lineEnd, normal, 3);
+                aChunk.normals.insert(aChunk.normals.end(), { normal[0], normal[1], -normal[2] });
+            }
+            else if (keywordLength == 1 && cursor[0] == 'f')
+            {
+                polygon.clear();
+                const char* token = SkipSpaces(keywordEnd, lineEnd);
+                while (token < lineEnd)
+                {
+                    const char* tokenEnd = SkipToken(token, lineEnd);
+                    polygon.push_back(ParseObjCorner(token, tokenEnd, aChunk));
+                    token = SkipSpaces(tokenEnd, lineEnd);
+                }
+
+                // Fan triangulation, fine for the convex polygons exporters write
+                for (size_t i = 2; i < polygon.size(); ++i)
+                {
+                    aChunk.corners.insert(aChunk.corners.end(), { polygon[0], polygon[i - 1], polygon[i] });
+                }
+            }
+            cursor = next;
+        }
+    }
+
+    bool IsObjIndexValid(int anIndex, size_t aCount, bool anIsOptional)
+    {
+        return anIndex == locObjMissing ? anIsOptional : anIndex >= 0 && static_cast<size_t>(anIndex) < aCount;
+    }
+
+    // Turns chunk relative indices global, checks them and merges corners that repeat inside the chunk
+    void ResolveObjChunk(ObjChunk& aChunk, size_t aPositionCount, size_t aTexCoordCount, size_t aNormalCount)
+    {
+        ObjCornerTable cornerToUnique(aChunk.corners.size() / 4);
+        aChunk.localIndices.reserve(aChunk.corners.size());
+        for (ObjCorner corner : aChunk.corners)
+        {
+            corner.position += (corner.relative & ObjRelativePosition) ? static_cast<int>(aChunk.positionOffset) : 0;
+            corner.texCoord += (corner.relative & ObjRelativeTexCoord) ? static_cast<int>(aChunk.texCoordOffset) : 0;
+            corner.normal += (corner.relative & ObjRelativeNormal) ? static_cast<int>(aChunk.normalOffset) : 0;
+            corner.relative = 0;
+            if (!IsObjIndexValid(corner.position, aPositionCount, false) || !IsObjIndexValid(corner.texCoord, aTexCoordCount, true) ||
+                !IsObjIndexValid(corner.normal, aNormalCount, true))
+            {
+                aChunk.error = "face index out of range";
+                return;
+            }
+
+            const auto [index, isNew] = cornerToUnique.Insert(corner, static_cast<UINT>(aChunk.uniqueCorners.size()));
+            if (isNew)
+            {
+                aChunk.uniqueCorners.push_back(corner);
+            }
+            aChunk.localIndices.push_back(index);
+        }
+        std::vector<ObjCorner>().swap(aChunk.corners);
+    }
+
+    bool ImportObj(const std::string& aPath, const std::string& someData, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, MeshImportStats& someStats)
+    {
+        // Newline aligned chunks, one or more per hardware thread
+        const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunkCount = std::clamp<size_t>(someData.size() / locMinObjChunkSize, 1, threadCount);
+        std::vector<ObjChunk> chunks(chunkCount);
+        const char* data = someData.data();
+        const char* dataEnd = data + someData.size();
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            chunks[i].begin = i == 0 ? data : chunks[i - 1].end;
+            const char* split = i + 1 == chunkCount ? dataEnd : std::max(chunks[i].begin, data + someData.size() * (i + 1) / chunkCount);
+            const char* newline = static_cast<const char*>(std::memchr(split, '\n', dataEnd - split));
+            chunks[i].end = i + 1 == chunkCount || !newline ? dataEnd : newline + 1;
+        }
+
+        ParallelFor(0, static_cast<int>(chunkCount), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                ParseObjChunk(chunks[i]);
+            }
+        });
+
+        size_t positionCount = 0;
+        size_t texCoordCount = 0;
+        size_t normalCount = 0;
+        size_t cornerCount = 0;
+        for (ObjChunk& chunk : chunks)
+        {
+            chunk.positionOffset = positionCount;
+            chunk.texCoordOffset = texCoordCount;
+            chunk.normalOffset = normalCount;
+            chunk.indexOffset = cornerCount;
+            positionCount += chunk.positions.size() / 3;
+            texCoordCount += chunk.texCoords.size() / 2;
+            normalCount += chunk.normals.size() / 3;
+            cornerCount += chunk.corners.size();
+        }
+
+        ParallelFor(0, static_cast<int>(chunkCount), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                ResolveObjChunk(chunks[i], positionCount, texCoordCount, normalCount);
+            }
+        });
+
+        // Only corners that are unique within their chunk are left for the serial merge, a single chunk is already done
+        size_t uniqueCount = 0;
+        for (const ObjChunk& chunk : chunks)
+        {
+            if (!chunk.error.empty())
+            {
+                std::cerr << "Failed to import " << aPath << ": " << chunk.error << std::endl;
+                return false;
+            }
+            uniqueCount += chunk.uniqueCorners.size();
+        }
+
+        std::vector<ObjCorner> vertexCorners;
+        if (chunkCount == 1)
+        {
+            vertexCorners.swap(chunks[0].uniqueCorners);
+            chunks[0].remap.resize(vertexCorners.size());
+            for (size_t i = 0; i < vertexCorners.size(); ++i)
+            {
+                chunks[0].remap[i] = static_cast<UINT>(i);
+            }
+        }
+        else
+        {
+            ObjCornerTable cornerToVertex(uniqueCount / 2);
+            vertexCorners.reserve(uniqueCount);
+            for (ObjChunk& chunk : chunks)
+            {
+                chunk.remap.reserve(chunk.uniqueCorners.size());
+                for (const ObjCorner& corner : chunk.uniqueCorners)
+                {
+                    const auto [index, isNew] = cornerToVertex.Insert(corner, static_cast<UINT>(vertexCorners.size()));
+                    if (isNew)
+                    {
+                        vertexCorners.push_back(corner);
+                    }
+                    chunk.remap.push_back(index);
+                }
+            }
+        }
+
+        std::vector<float> positions;
+        std::vector<float> texCoords;
+        std::vector<float> normals;
+        positions.reserve(positionCount * 3);
+        texCoords.reserve(texCoordCount * 2);
+        normals.reserve(normalCount * 3);
+        for (const ObjChunk& chunk : chunks)
+        {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        }
+
+        someIndices.resize(cornerCount);
+        ParallelFor(0, static_cast<int>(chunkCount), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                const ObjChunk& chunk = chunks[i];
+                for (size_t corner = 0; corner < chunk.localIndices.size(); ++corner)
+                {
+                    someIndices[chunk.indexOffset + corner] = chunk.remap[chunk.localIndices[corner]];
+                }
+            }
+        });
+
+        someVertices.resize(vertexCorners.size());
+        std::vector<char> missingNormals(vertexCorners.size(), 0);
+        ParallelFor(0, static_cast<int>(vertexCorners.size()), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                const ObjCorner& corner = vertexCorners[i];
+                Vertex vertex = {};
+                vertex.x = positions[corner.position * 3];
+                vertex.y = positions[corner.position * 3 + 1];
+                vertex.z = positions[corner.position * 3 + 2];
+                vertex.w = 1.0f;
+                vertex.r = vertex.g = vertex.b = vertex.a = 1.0f;
+                if (corner.texCoord != locObjMissing)
+                {
+                    vertex.u = texCoords[corner.texCoord * 2];
+                    vertex.v = texCoords[corner.texCoord * 2 + 1];
+                }
+                if (corner.normal != locObjMissing)
+                {
+                    vertex.nx = normals[corner.normal * 3];
+                    vertex.ny = normals[corner.normal * 3 + 1];
+                    vertex.nz = normals[corner.normal * 3 + 2];
+                }
+                missingNormals[i] = corner.normal == locObjMissing;
+                someVertices[i] = vertex;
+            }
+        });
+
+        // OBJ has no tangents
+        GenerateMissingFrames(someVertices, someIndices, missingNormals, std::vector<char>(someVertices.size(), 1), someStats);
+        someStats.cornerCount = cornerCount;
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // glTF
+    //--------------------------------------------------------------------------------------------------------------
+
+    struct JsonValue
+    {
+        enum class Type { Null, Boolean, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        const JsonValue* Find(const char* aKey) const
+        {
+            for (const auto& [key, value] : members)
+            {
+                if (key == aKey)
+                {
+                    return &value;
+                }
+            }
+            return nullptr;
+        }
+        double GetNumber(const char* aKey, double aDefault) const
+        {
+            const JsonValue* value = Find(aKey);
+            return value && value->type == Type::Number ? value->number : aDefault;
+        }
+        int GetInt(const char* aKey, int aDefault) const
+        {
+            return static_cast<int>(GetNumber(aKey, aDefault));
+        }
+        std::string GetString(const char* aKey) const
+        {
+            const JsonValue* value = Find(aKey);
+            return value && value->type == Type::String ? value->string : std::string();
+        }
+        // Empty array for missing keys so callers can just iterate
+        const std::vector<JsonValue>& GetArray(const char* aKey) const
+        {
+            static const std::vector<JsonValue> empty;
+            const JsonValue* value = Find(aKey);
+            return value && value->type == Type::Array ? value->array : empty;
+        }
+    };
+
+    // Just enough JSON for glTF documents, which are small next to their buffers
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* aBegin, const char* anEnd) : myCursor(aBegin), myEnd(anEnd) {}
+
+        bool Parse(JsonValue& aValue)
+        {
+            return ParseValue(aValue, 0) && (SkipWhitespace(), myCursor == myEnd);
+        }
+
+    private:
+        static constexpr int locMaxDepth = 256;
+
+        void SkipWhitespace()
+        {
+            while (myCursor < myEnd && (*myCursor == ' ' || *myCursor == '\t' || *myCursor == '\n' || *myCursor == '\r'))
+            {
+                ++myCursor;
+            }
+        }
+
+        bool Consume(const char* aLiteral)
+        {
+            const size_t length = std::strlen(aLiteral);
+            if (static_cast<size_t>(myEnd - myCursor) < length || std::memcmp(myCursor, aLiteral, length) != 0)
+            {
+                return false;
+            }
+            myCursor += length;
+            return true;
+        }
+
+        bool ParseValue(JsonValue& aValue, int aDepth)
+        {
+            SkipWhitespace();
+            if (myCursor >= myEnd || aDepth > locMaxDepth)
+            {
+                return false;
+            }
+
+            switch (*myCursor)
+            {
+            case '{': return ParseObject(aValue, aDepth);
+            case '[': return ParseArray(aValue, aDepth);
+            case '"': aValue.type = JsonValue::Type::String; return ParseString(aValue.string);
+            case 't': aValue.type = JsonValue::Type::Boolean; aValue.boolean = true; return Consume("true");
+            case 'f': aValue.type = JsonValue::Type::Boolean; aValue.boolean = false; return Consume("false");
+            case 'n': aValue.type = JsonValue::Type::Null; return Consume("null");
+            default: break;
+            }
+
+            aValue.type = JsonValue::Type::Number;
+            const std::from_chars_result result = std::from_chars(myCursor, myEnd, aValue.number);
+            if (result.ec != std::errc())
+            {
+                return false;
+            }
+            myCursor = result.ptr;
+            return true;
+        }
+
+        bool ParseObject(JsonValue& aValue, int aDepth)
+        {
+            aValue.type = JsonValue::Type::Object;
+            ++myCursor;
+            SkipWhitespace();
+            if (myCursor < myEnd && *myCursor == '}')
+            {
+                ++myCursor;
+                return true;
+            }
+            while (true)
+            {
+                SkipWhitespace();
+                std::pair<std::string, JsonValue> member;
+                if (myCursor >= myEnd || *myCursor != '"' || !ParseString(member.first))
+                {
+                    return false;
+                }
+                SkipWhitespace();
+                if (!Consume(":") || !ParseValue(member.second, aDepth + 1))
+                {
+                    return false;
+                }
+                aValue.members.push_back(std::move(member));
+                SkipWhitespace();
+                if (Consume("}"))
+                {
+                    return true;
+                }
+                if (!Consume(","))
+                {
+                    return false;
+                }
+            }
+        }
+
+        bool ParseArray(JsonValue& aValue, int aDepth)
+        {
+            aValue.type = JsonValue::Type::Array;
+            ++myCursor;
+            SkipWhitespace();
+            if (myCursor < myEnd && *myCursor == ']')
+            {
+                ++myCursor;
+                return true;
+            }
+            while (true)
+            {
+                aValue.array.emplace_back();
+                if (!ParseValue(aValue.array.back(), aDepth + 1))
+                {
+                    return false;
+                }
+                SkipWhitespace();
+                if (Consume("]"))
+                {
+                    return true;
+                }
+                if (!Consume(","))
+                {
+                    return false;
+                }
+            }
+        }
+
+        static void AppendUtf8(std::string& aString, uint32_t aCodePoint)
+        {
+            if (aCodePoint < 0x80)
+            {
+                aString += static_cast<char>(aCodePoint);
+            }
+            else if (aCodePoint < 0x800)
+            {
+                aString += static_cast<char>(0xC0 | (aCodePoint >> 6));
+                aString += static_cast<char>(0x80 | (aCodePoint & 0x3F));
+            }
+            else
+            {
+                aString += static_cast<char>(0xE0 | (aCodePoint >> 12));
+                aString += static_cast<char>(0x80 | ((aCodePoint >> 6) & 0x3F));
+                aString += static_cast<char>(0x80 | (aCodePoint & 0x3F));
+            }
+        }
+
+        bool ParseString(std::string& aString)
+        {
+            ++myCursor;
+            while (myCursor < myEnd && *myCursor != '"')
+            {
+                if (*myCursor != '\\')
+                {
+                    aString += *myCursor++;
+                    continue;
+                }
+                if (++myCursor >= myEnd)
+                {
+                    return false;
+                }
+                const char escape = *myCursor++;
+                switch (escape)
+                {
+                case 'b': aString += '\b'; break;
+                case 'f': aString += '\f'; break;
+                case 'n': aString += '\n'; break;
+                case 'r': aString += '\r'; break;
+                case 't': aString += '\t'; break;
+                case 'u':
+                {
+                    uint32_t codePoint = 0;
+                    if (myEnd - myCursor < 4 || std::from_chars(myCursor, myCursor + 4, codePoint, 16).ptr != myCursor + 4)
+                    {
+                        return false;
+                    }
+                    myCursor += 4;
+                    AppendUtf8(aString, codePoint);
+                    break;
+                }
+                default: aString += escape; break;
+                }
+            }
+            if (myCursor >= myEnd)
+            {
+                return false;
+            }
+            ++myCursor;
+            return true;
+        }
+
+        const char* myCursor;
+        const char* myEnd;
+    };
+
+    bool DecodeBase64(const char* aBegin, const char* anEnd, std::string& someBytes)
+    {
+        auto decodeCharacter = [](char aCharacter) -> int
+        {
+            if (aCharacter >= 'A' && aCharacter <= 'Z') return aCharacter - 'A';
+            if (aCharacter >= 'a' && aCharacter <= 'z') return aCharacter - 'a' + 26;
+            if (aCharacter >= '0' && aCharacter <= '9') return aCharacter - '0' + 52;
+            if (aCharacter == '+') return 62;
+            if (aCharacter == '/') return 63;
+            return -1;
+        };
+
+        someBytes.clear();
+        someBytes.reserve((anEnd - aBegin) / 4 * 3);
+        uint32_t bits = 0;
+        int bitCount = 0;
+        for (const char* cursor = aBegin; cursor < anEnd && *cursor != '='; ++cursor)
+        {
+            const int value = decodeCharacter(*cursor);
+            if (value < 0)
+            {
+                return false;
+            }
+            bits = (bits << 6) | static_cast<uint32_t>(value);
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                someBytes += static_cast<char>((bits >> bitCount) & 0xFF);
+            }
+        }
+        return true;
+    }
+
+    // 4x4 column-major like glTF's node matrices
+    struct GltfMatrix
+    {
+        float values[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+        GltfMatrix operator*(const GltfMatrix& anOther) const
+        {
+            GltfMatrix result;
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int row = 0; row < 4; ++row)
+                {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        sum += values[k * 4 + row] * anOther.values[column * 4 + k];
+                    }
+                    result.values[column * 4 + row] = sum;
+                }
+            }
+            return result;
+        }
+        float Determinant3x3() const
+        {
+            const float* m = values;
+            return m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+        }
+    };
+
+    struct GltfDocument
+    {
+        JsonValue json;
+        std::vector<std::string> buffers;
+    };
+
+    struct GltfAccessor
+    {
+        const unsigned char* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        int componentType = 0;
+        int componentCount = 0;
+        bool normalized = false;
+    };
+
+    enum GltfComponentType
+    {
+        GltfByte = 5120,
+        GltfUnsignedByte = 5121,
+        GltfShort = 5122,
+        GltfUnsignedShort = 5123,
+        GltfUnsignedInt = 5125,
+        GltfFloat = 5126
+    };
+
+    size_t GetGltfComponentSize(int aComponentType)
+    {
+        switch (aComponentType)
+        {
+        case GltfByte:
+        case GltfUnsignedByte: return 1;
+        case GltfShort:
+        case GltfUnsignedShort: return 2;
+        case GltfUnsignedInt:
+        case GltfFloat: return 4;
+        default: return 0;
+        }
+    }
+
+    int GetGltfComponentCount(const std::string& aType)
+    {
+        if (aType == "SCALAR") return 1;
+        if (aType == "VEC2") return 2;
+        if (aType == "VEC3") return 3;
+        if (aType == "VEC4") return 4;
+        return 0;
+    }
+
+    float ReadGltfComponent(const unsigned char* someData, int aComponentType, bool anIsNormalized)
+    {
+        switch (aComponentType)
+        {
+        case GltfFloat: { float value; std::memcpy(&value, someData, sizeof(value)); return value; }
+        case GltfUnsignedByte: return anIsNormalized ? someData[0] / 255.0f : someData[0];
+        case GltfByte: { const float value = static_cast<signed char>(someData[0]); return anIsNormalized ? std::max(value / 127.0f, -1.0f) : value; }
+        case GltfUnsignedShort: { uint16_t value; std::memcpy(&value, someData, sizeof(value)); return anIsNormalized ? value / 65535.0f : value; }
+        case GltfShort: { int16_t value; std::memcpy(&value, someData, sizeof(value)); return anIsNormalized ? std::max(value / 32767.0f, -1.0f) : value; }
+        case GltfUnsignedInt: { uint32_t value; std::memcpy(&value, someData, sizeof(value)); return static_cast<float>(value); }
+        default: return 0.0f;
+        }
+    }
+
+    // Up to aCount components of element anIndex, the rest keep their defaults
+    void ReadGltfElement(const GltfAccessor& anAccessor, size_t anIndex, float* someValues, int aCount)
+    {
+        const unsigned char* element = anAccessor.data + anIndex * anAccessor.stride;
+        const size_t componentSize = GetGltfComponentSize(anAccessor.componentType);
+        for (int i = 0; i < std::min(aCount, anAccessor.componentCount); ++i)
+        {
+            someValues[i] = ReadGltfComponent(element + i * componentSize, anAccessor.componentType, anAccessor.normalized);
+        }
+    }
+
+    UINT ReadGltfIndex(const GltfAccessor& anAccessor, size_t anIndex)
+    {
+        const unsigned char* element = anAccessor.data + anIndex * anAccessor.stride;
+        switch (anAccessor.componentType)
+        {
+        case GltfUnsignedByte: return element[0];
+        case GltfUnsignedShort: { uint16_t value; std::memcpy(&value, element, sizeof(value)); return value; }
+        default: { uint32_t value; std::memcpy(&value, element, sizeof(value)); return value; }
+        }
+    }
+
+    bool GetGltfAccessor(const GltfDocument& aDocument, int anIndex, GltfAccessor& anAccessor)
+    {
+        const std::vector<JsonValue>& accessors = aDocument.json.GetArray("accessors");
+        if (anIndex < 0 || static_cast<size_t>(anIndex) >= accessors.size())
+        {
+            return false;
+        }
+        const JsonValue& accessor = accessors[anIndex];
+        if (accessor.Find("sparse"))
+        {
+            std::cerr << "Sparse glTF accessors are not supported" << std::endl;
+            return false;
+        }
+
+        anAccessor.count = static_cast<size_t>(accessor.GetNumber("count", 0));
+        anAccessor.componentType = accessor.GetInt("componentType", 0);
+        anAccessor.componentCount = GetGltfComponentCount(accessor.GetString("type"));
+        const JsonValue* normalized = accessor.Find("normalized");
+        anAccessor.normalized = normalized && normalized->type == JsonValue::Type::Boolean && normalized->boolean;
+        const size_t elementSize = GetGltfComponentSize(anAccessor.componentType) * anAccessor.componentCount;
+        if (elementSize == 0)
+        {
+            return false;
+        }
+
+        const std::vector<JsonValue>& views = aDocument.json.GetArray("bufferViews");
+        const int viewIndex = accessor.GetInt("bufferView", -1);
+        if (viewIndex < 0 || static_cast<size_t>(viewIndex) >= views.size())
+        {
+            std::cerr << "glTF accessors without a buffer view are not supported" << std::endl;
+            return false;
+        }
+        const JsonValue& view = views[viewIndex];
+        const int bufferIndex = view.GetInt("buffer", -1);
+        if (bufferIndex < 0 || static_cast<size_t>(bufferIndex) >= aDocument.buffers.size())
+        {
+            return false;
+        }
+
+        const std::string& buffer = aDocument.buffers[bufferIndex];
+        const size_t viewOffset = static_cast<size_t>(view.GetNumber("byteOffset", 0));
+        const size_t viewLength = static_cast<size_t>(view.GetNumber("byteLength", 0));
+        const size_t accessorOffset = static_cast<size_t>(accessor.GetNumber("byteOffset", 0));
+        anAccessor.stride = static_cast<size_t>(view.GetNumber("byteStride", 0));
+        anAccessor.stride = anAccessor.stride != 0 ? anAccessor.stride : elementSize;
+        const size_t accessorSize = anAccessor.count == 0 ? 0 : accessorOffset + anAccessor.stride * (anAccessor.count - 1) + elementSize;
+        if (viewOffset > buffer.size() || viewLength > buffer.size() - viewOffset || accessorSize > viewLength)
+        {
+            std::cerr << "glTF accessor " << anIndex << " reads past its buffer" << std::endl;
+            return false;
+        }
+
+        anAccessor.data = reinterpret_cast<const unsigned char*>(buffer.data()) + viewOffset + accessorOffset;
+        return true;
+    }
+
+    bool LoadGltfBuffers(const std::string& aPath, const std::string& someBinaryChunk, GltfDocument& aDocument)
+    {
+        const std::vector<JsonValue>& buffers = aDocument.json.GetArray("buffers");
+        aDocument.buffers.resize(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            const std::string uri = buffers[i].GetString("uri");
+            const size_t byteLength = static_cast<size_t>(buffers[i].GetNumber("byteLength", 0));
+            std::string& bytes = aDocument.buffers[i];
+            if (uri.empty())
+            {
+                // The .glb binary chunk
+                bytes = someBinaryChunk;
+            }
+            else if (uri.compare(0, 5, "data:") == 0)
+            {
+                const size_t comma = uri.find(',');
+                if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos ||
+                    !DecodeBase64(uri.data() + comma + 1, uri.data() + uri.size(), bytes))
+                {
+                    std::cerr << "Unsupported data uri in buffer " << i << " of " << aPath << std::endl;
+                    return false;
+                }
+            }
+            else if (!ReadFileBytes(GetDirectory(aPath) + uri, bytes))
+            {
+                std::cerr << "Failed to read buffer " << uri << " of " << aPath << std::endl;
+                return false;
+            }
+
+            if (bytes.size() < byteLength)
+            {
+                std::cerr << "Buffer " << i << " of " << aPath << " is shorter than declared" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool LoadGltfDocument(const std::string& aPath, const std::string& someData, GltfDocument& aDocument)
+    {
+        const char* jsonBegin = someData.data();
+        const char* jsonEnd = someData.data() + someData.size();
+        std::string binaryChunk;
+
+        // Binary container: 12 byte header, a JSON chunk and an optional BIN chunk
+        constexpr uint32_t glbMagic = 0x46546C67;
+        constexpr uint32_t jsonChunkType = 0x4E4F534A;
+        constexpr uint32_t binaryChunkType = 0x004E4942;
+        uint32_t magic = 0;
+        if (someData.size() >= 12 && (std::memcpy(&magic, someData.data(), 4), magic == glbMagic))
+        {
+            size_t offset = 12;
+            jsonBegin = jsonEnd = nullptr;
+            while (offset + 8 <= someData.size())
+            {
+                uint32_t chunkLength = 0;
+                uint32_t chunkType = 0;
+                std::memcpy(&chunkLength, someData.data() + offset, 4);
+                std::memcpy(&chunkType, someData.data() + offset + 4, 4);
+                offset += 8;
+                if (chunkLength > someData.size() - offset)
+                {
+                    break;
+                }
+                if (chunkType == jsonChunkType && !jsonBegin)
+                {
+                    jsonBegin = someData.data() + offset;
+                    jsonEnd = jsonBegin + chunkLength;
+                }
+                else if (chunkType == binaryChunkType && binaryChunk.empty())
+                {
+                    binaryChunk.assign(someData.data() + offset, chunkLength);
+                }
+                offset += (chunkLength + 3) & ~3u;
+            }
+            // The JSON chunk is padded with spaces, trailing ones are fine
+            if (!jsonBegin)
+            {
+                std::cerr << "No JSON chunk in " << aPath << std::endl;
+                return false;
+            }
+        }
+
+        JsonParser parser(jsonBegin, jsonEnd);
+        if (!parser.Parse(aDocument.json) || aDocument.json.type != JsonValue::Type::Object)
+        {
+            std::cerr << "Failed to parse glTF JSON in " << aPath << std::endl;
+            return false;
+        }
+        return LoadGltfBuffers(aPath, binaryChunk, aDocument);
+    }
+
+    GltfMatrix GetGltfNodeMatrix(const JsonValue& aNode)
+    {
+        GltfMatrix matrix;
+        const std::vector<JsonValue>& values = aNode.GetArray("matrix");
+        if (values.size() == 16)
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                matrix.values[i] = static_cast<float>(values[i].number);
+            }
+            return matrix;
+        }
+
+        auto readVector = [&aNode](const char* aKey, float* someValues, size_t aCount)
+        {
+            const std::vector<JsonValue>& vector = aNode.GetArray(aKey);
+            for (size_t i = 0; i < std::min(aCount, vector.size()); ++i)
+            {
+                someValues[i] = static_cast<float>(vector[i].number);
+            }
+        };
+        float translation[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float scale[3] = { 1.0f, 1.0f, 1.0f };
+        readVector("translation", translation, 3);
+        readVector("rotation", rotation, 4);
+        readVector("scale", scale, 3);
+
+        // T * R * S with R from the unit quaternion (x, y, z, w)
+        const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+        const float rotationMatrix[9] =
+        {
+            1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+            2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+            2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)
+        };
+        for (int column = 0; column < 3; ++column)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                matrix.values[column * 4 + row] = rotationMatrix[column * 3 + row] * scale[column];
+            }
+            matrix.values[12 + column] = translation[column];
+        }
+        return matrix;
+    }
+
+    struct GltfMeshBuilder
+    {
+        std::vector<Vertex> vertices;
+        std::vector<UINT> indices;
+        std::vector<char> missingNormals;
+        std::vector<char> missingTangents;
+    };
+
+    bool AppendGltfPrimitive(const GltfDocument& aDocument, const JsonValue& aPrimitive, const GltfMatrix& aTransform, GltfMeshBuilder& aBuilder)
+    {
+        if (aPrimitive.GetInt("mode", 4) != 4)
+        {
+            std::cout << "Skipping glTF primitive that isn't a triangle list" << std::endl;
+            return true;
+        }
+
+        const JsonValue* attributes = aPrimitive.Find("attributes");
+        GltfAccessor positions;
+        if (!attributes || !GetGltfAccessor(aDocument, attributes->GetInt("POSITION", -1), positions))
+        {
+            std::cerr << "glTF primitive without readable positions" << std::endl;
+            return false;
+        }
+
+        GltfAccessor normals;
+        GltfAccessor tangents;
+        GltfAccessor texCoords;
+        GltfAccessor colors;
+        auto getOptional = [&](const char* aName, GltfAccessor& anAccessor)
+        {
+            const int index = attributes->GetInt(aName, -1);
+            return index >= 0 && GetGltfAccessor(aDocument, index, anAccessor) && anAccessor.count >= positions.count;
+        };
+        const bool hasNormals = getOptional("NORMAL", normals);
+        const bool hasTangents = hasNormals && getOptional("TANGENT", tangents);
+        const bool hasTexCoords = getOptional("TEXCOORD_0", texCoords);
+        const bool hasColors = getOptional("COLOR_0", colors);
+
+        // Normals go through the cofactor matrix, the inverse transpose scaled by the determinant
+        const float* m = aTransform.values;
+        const float determinant = aTransform.Determinant3x3();
+        const float sign = determinant < 0.0f ? -1.0f : 1.0f;
+        const float normalMatrix[9] =
+        {
+            sign * (m[5] * m[10] - m[6] * m[9]), sign * (m[6] * m[8] - m[4] * m[10]), sign * (m[4] * m[9] - m[5] * m[8]),
+            sign * (m[9] * m[2] - m[10] * m[1]), sign * (m[10] * m[0] - m[8] * m[2]), sign * (m[8] * m[1] - m[9] * m[0]),
+            sign * (m[1] * m[6] - m[2] * m[5]), sign * (m[2] * m[4] - m[0] * m[6]), sign * (m[0] * m[5] - m[1] * m[4])
+        };
+
+        const size_t baseVertex = aBuilder.vertices.size();
+        aBuilder.vertices.resize(baseVertex + positions.count);
+        aBuilder.missingNormals.resize(aBuilder.vertices.size(), !hasNormals);
+        aBuilder.missingTangents.resize(aBuilder.vertices.size(), !hasTangents);
+        ParallelFor(0, static_cast<int>(positions.count), [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                float position[3] = { 0.0f, 0.0f, 0.0f };
+                float normal[3] = { 0.0f, 0.0f, 0.0f };
+                float tangent[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                float texCoord[2] = { 0.0f, 0.0f };
+                float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+                ReadGltfElement(positions, i, position, 3);
+                if (hasNormals) ReadGltfElement(normals, i, normal, 3);
+                if (hasTangents) ReadGltfElement(tangents, i, tangent, 4);
+                if (hasTexCoords) ReadGltfElement(texCoords, i, texCoord, 2);
+                if (hasColors) ReadGltfElement(colors, i, color, 4);
+
+                float worldPosition[3];
+                float worldNormal[3];
+                float worldTangent[3];
+                for (int row = 0; row < 3; ++row)
+                {
+                    worldPosition[row] = m[row] * position[0] + m[4 + row] * position[1] + m[8 + row] * position[2] + m[12 + row];
+                    worldNormal[row] = normalMatrix[row] * normal[0] + normalMatrix[3 + row] * normal[1] + normalMatrix[6 + row] * normal[2];
+                    worldTangent[row] = m[row] * tangent[0] + m[4 + row] * tangent[1] + m[8 + row] * tangent[2];
+                }
+                auto normalize = [](float* someValues)
+                {
+                    const float length = std::sqrt(someValues[0] * someValues[0] + someValues[1] * someValues[1] + someValues[2] * someValues[2]);
+                    for (int axis = 0; axis < 3 && length > 0.0f; ++axis)
+                    {
+                        someValues[axis] /= length;
+                    }
+                };
+                normalize(worldNormal);
+                normalize(worldTangent);
+
+                // Mirrored z makes the space left handed and keeps glTF's counter-clockwise faces front facing.
+                // The bitangent is the mirrored glTF one, cross(n, t) * w, which flips sign under the mirror.
+                Vertex& vertex = aBuilder.vertices[baseVertex + i];
+                vertex = {};
+                vertex.x = worldPosition[0];
+                vertex.y = worldPosition[1];
+                vertex.z = -worldPosition[2];
+                vertex.w = 1.0f;
+                vertex.r = color[0];
+                vertex.g = color[1];
+                vertex.b = color[2];
+                vertex.a = color[3];
+                vertex.u = texCoord[0];
+                vertex.v = texCoord[1];
+                vertex.nx = worldNormal[0];
+                vertex.ny = worldNormal[1];
+                vertex.nz = -worldNormal[2];
+                if (hasTangents)
+                {
+                    vertex.tx = worldTangent[0];
+                    vertex.ty = worldTangent[1];
+                    vertex.tz = -worldTangent[2];
+                    const float handedness = -(tangent[3] < 0.0f ? -1.0f : 1.0f) * sign;
+                    vertex.bx = (vertex.ny * vertex.tz - vertex.nz * vertex.ty) * handedness;
+                    vertex.by = (vertex.nz * vertex.tx - vertex.nx * vertex.tz) * handedness;
+                    vertex.bz = (vertex.nx * vertex.ty - vertex.ny * vertex.tx) * handedness;
+                }
+            }
+        });
+
+        // Unindexed primitives draw their vertices in order
+        GltfAccessor indexAccessor;
+        const int indicesIndex = aPrimitive.GetInt("indices", -1);
+        const bool hasIndices = indicesIndex >= 0;
+        if (hasIndices && (!GetGltfAccessor(aDocument, indicesIndex, indexAccessor) || indexAccessor.componentCount != 1 ||
+            (indexAccessor.componentType != GltfUnsignedByte && indexAccessor.componentType != GltfUnsignedShort && indexAccessor.componentType != GltfUnsignedInt)))
+        {
+            std::cerr << "glTF primitive with unreadable indices" << std::endl;
+            return false;
+        }
+
+        const size_t indexCount = (hasIndices ? indexAccessor.count : positions.count) / 3 * 3;
+        const size_t firstIndex = aBuilder.indices.size();
+        aBuilder.indices.resize(firstIndex + indexCount);
+        bool isInRange = true;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const UINT index = hasIndices ? ReadGltfIndex(indexAccessor, i) : static_cast<UINT>(i);
+            isInRange = isInRange && index < positions.count;
+            aBuilder.indices[firstIndex + i] = static_cast<UINT>(baseVertex) + index;
+        }
+        if (!isInRange)
+        {
+            std::cerr << "glTF primitive indexes past its vertices" << std::endl;
+            return false;
+        }
+
+        // A mirroring node transform turns the faces around, undo it
+        if (determinant < 0.0f)
+        {
+            for (size_t i = firstIndex; i < aBuilder.indices.size(); i += 3)
+            {
+                std::swap(aBuilder.indices[i + 1], aBuilder.indices[i + 2]);
+            }
+        }
+        return true;
+    }
+
+    bool AppendGltfMesh(const GltfDocument& aDocument, int aMeshIndex, const GltfMatrix& aTransform, GltfMeshBuilder& aBuilder)
+    {
+        const std::vector<JsonValue>& meshes = aDocument.json.GetArray("meshes");
+        if (aMeshIndex < 0 || static_cast<size_t>(aMeshIndex) >= meshes.size())
+        {
+            return false;
+        }
+        for (const JsonValue& primitive : meshes[aMeshIndex].GetArray("primitives"))
+        {
+            if (!AppendGltfPrimitive(aDocument, primitive, aTransform, aBuilder))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool AppendGltfNode(const GltfDocument& aDocument, int aNodeIndex, const GltfMatrix& aParentTransform, int aDepth, GltfMeshBuilder& aBuilder)
+    {
+        const std::vector<JsonValue>& nodes = aDocument.json.GetArray("nodes");
+        if (aNodeIndex < 0 || static_cast<size_t>(aNodeIndex) >= nodes.size() || aDepth > locMaxGltfNodeDepth)
+        {
+            std::cerr << "Invalid glTF node hierarchy" << std::endl;
+            return false;
+        }
+
+        const JsonValue& node = nodes[aNodeIndex];
+        const GltfMatrix transform = aParentTransform * GetGltfNodeMatrix(node);
+        if (node.Find("mesh") && !AppendGltfMesh(aDocument, node.GetInt("mesh", -1), transform, aBuilder))
+        {
+            return false;
+        }
+        for (const JsonValue& child : node.GetArray("children"))
+        {
+            if (!AppendGltfNode(aDocument, static_cast<int>(child.number), transform, aDepth + 1, aBuilder))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ImportGltf(const std::string& aPath, const std::string& someData, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, MeshImportStats& someStats)
+    {
+        GltfDocument document;
+        if (!LoadGltfDocument(aPath, someData, document))
+        {
+            return false;
+        }
+
+        // The default scene with its node transforms baked in, or every mesh as is when the file has no scenes
+        GltfMeshBuilder builder;
+        const std::vector<JsonValue>& scenes = document.json.GetArray("scenes");
+        if (!scenes.empty())
+        {
+            const size_t sceneIndex = std::min(static_cast<size_t>(std::max(document.json.GetInt("scene", 0), 0)), scenes.size() - 1);
+            for (const JsonValue& node : scenes[sceneIndex].GetArray("nodes"))
+            {
+                if (!AppendGltfNode(document, static_cast<int>(node.number), GltfMatrix(), 0, builder))
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            for (size_t mesh = 0; mesh < document.json.GetArray("meshes").size(); ++mesh)
+            {
+                if (!AppendGltfMesh(document, static_cast<int>(mesh), GltfMatrix(), builder))
+                {
+                    return false;
+                }
+            }
+        }
+
+        someStats.cornerCount = builder.indices.size();
+        std::vector<UINT> remap;
+        WeldVertices(builder.vertices, builder.indices, remap);
+        std::vector<char> missingNormals(builder.vertices.size(), 0);
+        std::vector<char> missingTangents(builder.vertices.size(), 0);
+        for (size_t i = 0; i < remap.size(); ++i)
+        {
+            missingNormals[remap[i]] |= builder.missingNormals[i];
+            missingTangents[remap[i]] |= builder.missingTangents[i];
+        }
+
+        GenerateMissingFrames(builder.vertices, builder.indices, missingNormals, missingTangents, someStats);
+        someVertices.swap(builder.vertices);
+        someIndices.swap(builder.indices);
+        return true;
+    }
+}
+
+bool ImportMesh(const std::string& aPath, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, MeshImportStats* someStats)
+{
+    const ImportClock::time_point start = ImportClock::now();
+    MeshImportStats stats;
+    std::string data;
+    if (!ReadFileBytes(aPath, data))
+    {
+        std::cerr << "Failed to open mesh: " << aPath << std::endl;
+        return false;
+    }
+    stats.readMilliseconds = GetMilliseconds(start);
+
+    someVertices.clear();
+    someIndices.clear();
+    const std::string extension = GetExtension(aPath);
+    bool isImported = false;
+    if (extension == "obj")
+    {
+        isImported = ImportObj(aPath, data, someVertices, someIndices, stats);
+    }
+    else if (extension == "gltf" || extension == "glb")
+    {
+        isImported = ImportGltf(aPath, data, someVertices, someIndices, stats);
+    }
+    else
+    {
+        std::cerr << "Unsupported mesh format: " << aPath << std::endl;
+    }
+
+    if (!isImported || someIndices.empty())
+    {
+        std::cerr << "No triangles imported from " << aPath << std::endl;
+        return false;
+    }
+
+    stats.triangleCount = someIndices.size() / 3;
+    stats.vertexCount = someVertices.size();
+    stats.totalMilliseconds = GetMilliseconds(start);
+    if (someStats)
+    {
+        *someStats = stats;
+    }
+    return true;
+}
+
+bool IsImportableMesh(const std::string& aPath)
+{
+    const std::string extension = GetExtension(aPath);
+    return extension == "obj" || extension == "gltf" || extension == "glb";
+}
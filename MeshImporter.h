@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Vertex.h"
+
+typedef unsigned int UINT;
+
+struct MeshImportStats
+{
+    size_t triangleCount = 0;
+    size_t cornerCount = 0;         // Vertex references in the source, before identical ones are merged
+    size_t vertexCount = 0;
+    bool generatedNormals = false;
+    bool generatedTangents = false;
+    float readMilliseconds = 0.0f;  // Getting the file into memory, the floor for the whole import
+    float totalMilliseconds = 0.0f;
+};
+
+// Reads OBJ, glTF 2.0 (.gltf with embedded or external buffers) and binary .glb into engine vertices. Data is
+// converted to the engine's left handed space and winding, glTF node transforms are baked in, identical vertices
+// are merged and missing normals and tangents are generated. Parsing and decoding run on all hardware threads.
+bool ImportMesh(const std::string& aPath, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, MeshImportStats* someStats = nullptr);
+
+// True for the extensions ImportMesh understands
+bool IsImportableMesh(const std::string& aPath);
@@ -0,0 +1,40 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <vector>
+
+// One level of detail inside a shared vertex/index buffer, finest level first
+struct MeshLod
+{
+    unsigned int startIndex = 0;
+    unsigned int indexCount = 0;
+    int baseVertex = 0;              // Added to every index of the level
+    unsigned int vertexCount = 0;    // Vertices owned by the level from baseVertex on, 0 when levels share all vertices
+    float maxScreenSize = FLT_MAX;   // Largest projected bounding diameter in pixels the level is good enough for
+};
+
+// Coarsest level that still holds up at aScreenSize pixels, the finest one when none does
+inline size_t SelectMeshLod(const std::vector<MeshLod>& someLods, float aScreenSize)
+{
+    for (size_t lod = someLods.size(); lod > 1; --lod)
+    {
+        if (aScreenSize <= someLods[lod - 1].maxScreenSize)
+        {
+            return lod - 1;
+        }
+    }
+    return 0;
+}
+
+// As above, but the level only changes once the size is aHysteresis past the switch point, so objects sitting right on
+// a threshold don't flicker between levels from frame to frame
+inline size_t SelectMeshLod(const std::vector<MeshLod>& someLods, float aScreenSize, size_t aCurrentLod, float aHysteresis = 0.1f)
+{
+    const size_t coarser = SelectMeshLod(someLods, aScreenSize * (1.0f + aHysteresis));
+    if (coarser > aCurrentLod)
+    {
+        return coarser;
+    }
+    const size_t finer = SelectMeshLod(someLods, aScreenSize * (1.0f - aHysteresis));
+    return finer < aCurrentLod ? finer : aCurrentLod;
+}
@@ -0,0 +1,342 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Includes/MeehanVector3.hpp"
+
+namespace
+{
+    constexpr int locScoringCacheSize = 32;
+    constexpr float locCacheDecayPower = 1.5f;
+    constexpr float locLastTriangleScore = 0.75f;
+    constexpr float locValenceBoostScale = 2.0f;
+    constexpr float locValenceBoostPower = 0.5f;
+
+    float ScoreVertex(int aCachePosition, int aRemainingValence)
+    {
+        if (aRemainingValence == 0)
+        {
+            return -1.0f; // Nothing left to draw with this vertex
+        }
+
+        float score = 0.0f;
+        if (aCachePosition >= 0)
+        {
+            if (aCachePosition < 3)
+            {
+                // Used by the last triangle, fixed score so strips don't get favoured over fans
+                score = locLastTriangleScore;
+            }
+            else
+            {
+                const float scaler = 1.0f / static_cast<float>(locScoringCacheSize - 3);
+                score = std::pow(1.0f - static_cast<float>(aCachePosition - 3) * scaler, locCacheDecayPower);
+            }
+        }
+
+        // Boost vertices with few triangles left so they get finished instead of leaving lone triangles behind
+        score += locValenceBoostScale * std::pow(static_cast<float>(aRemainingValence), -locValenceBoostPower);
+        return score;
+    }
+}
+
+float ComputeACMR(const std::vector<UINT>& someIndices, size_t aVertexCount, int aCacheSize)
+{
+    const size_t triangleCount = someIndices.size() / 3;
+    if (triangleCount == 0 || aCacheSize <= 0)
+    {
+        return 0.0f;
+    }
+
+    // FIFO cache: a vertex is resident while fewer than aCacheSize misses happened since it was loaded
+    std::vector<size_t> loadedAt(aVertexCount, 0);
+    size_t misses = 0;
+    for (UINT index : someIndices)
+    {
+        if (loadedAt[index] == 0 || misses - loadedAt[index] >= static_cast<size_t>(aCacheSize))
+        {
+            ++misses;
+            loadedAt[index] = misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+void OptimizeVertexCache(std::vector<UINT>& someIndices, size_t aVertexCount)
+{
+    const size_t triangleCount = someIndices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles per vertex, packed
+    std::vector<int> valence(aVertexCount, 0);
+    for (UINT index : someIndices)
+    {
+        ++valence[index];
+    }
+    std::vector<size_t> adjacencyStart(aVertexCount + 1, 0);
+    for (size_t i = 0; i < aVertexCount; ++i)
+    {
+        adjacencyStart[i + 1] = adjacencyStart[i] + valence[i];
+    }
+    std::vector<UINT> adjacency(someIndices.size());
+    std::vector<size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            adjacency[fill[someIndices[triangle * 3 + corner]]++] = static_cast<UINT>(triangle);
+        }
+    }
+
+    std::vector<int> remainingValence = valence;
+    std::vector<int> cachePosition(aVertexCount, -1);
+    std::vector<float> vertexScore(aVertexCount);
+    for (size_t i = 0; i < aVertexCount; ++i)
+    {
+        vertexScore[i] = ScoreVertex(-1, remainingValence[i]);
+    }
+
+    std::vector<char> isEmitted(triangleCount, 0);
+
+    std::vector<UINT> result;
+    result.reserve(someIndices.size());
+    std::vector<UINT> cache;
+    std::vector<UINT> nextCache;
+    cache.reserve(locScoringCacheSize + 3);
+    nextCache.reserve(locScoringCacheSize + 3);
+
+    size_t scanCursor = 0;
+    size_t bestTriangle = 0;
+    while (result.size() < someIndices.size())
+    {
+        if (bestTriangle == triangleCount)
+        {
+            // Nothing connected to the cache is left, continue with the next triangle in input order
+            while (isEmitted[scanCursor])
+            {
+                ++scanCursor;
+            }
+            bestTriangle = scanCursor;
+        }
+
+        isEmitted[bestTriangle] = 1;
+        const UINT* corners = &someIndices[bestTriangle * 3];
+        result.insert(result.end(), corners, corners + 3);
+
+        // The emitted triangle's vertices move to the front of the LRU cache
+        nextCache.assign(corners, corners + 3);
+        for (UINT vertex : cache)
+        {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            const UINT vertex = corners[corner];
+            UINT* begin = adjacency.data() + adjacencyStart[vertex];
+            UINT* end = begin + remainingValence[vertex];
+            std::iter_swap(std::find(begin, end, static_cast<UINT>(bestTriangle)), end - 1);
+            --remainingValence[vertex];
+        }
+
+        for (size_t i = 0; i < nextCache.size(); ++i)
+        {
+            cachePosition[nextCache[i]] = i < locScoringCacheSize ? static_cast<int>(i) : -1;
+        }
+        for (UINT vertex : nextCache)
+        {
+            vertexScore[vertex] = ScoreVertex(cachePosition[vertex], remainingValence[vertex]);
+        }
+
+        // Only triangles touching the cache changed score, pick the best of them
+        float bestScore = -1.0f;
+        bestTriangle = triangleCount;
+        for (UINT vertex : nextCache)
+        {
+            const UINT* begin = adjacency.data() + adjacencyStart[vertex];
+            for (const UINT* triangle = begin; triangle != begin + remainingValence[vertex]; ++triangle)
+            {
+                const UINT* triangleCorners = &someIndices[*triangle * 3];
+                const float score = vertexScore[triangleCorners[0]] + vertexScore[triangleCorners[1]] + vertexScore[triangleCorners[2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = *triangle;
+                }
+            }
+        }
+
+        if (nextCache.size() > locScoringCacheSize)
+        {
+            nextCache.resize(locScoringCacheSize);
+        }
+        cache.swap(nextCache);
+    }
+
+    someIndices.swap(result);
+}
+
+void OptimizeOverdraw(std::vector<UINT>& someIndices, const std::vector<Vertex>& someVertices)
+{
+    const size_t triangleCount = someIndices.size() / 3;
+    if (triangleCount < 2)
+    {
+        return;
+    }
+
+    // A triangle where all three vertices miss the cache starts a new cluster, reordering clusters keeps the cache
+    std::vector<size_t> clusterStarts;
+    {
+        const size_t cacheSize = 16;
+        std::vector<size_t> loadedAt(someVertices.size(), 0);
+        size_t misses = 0;
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            int triangleMisses = 0;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const UINT index = someIndices[triangle * 3 + corner];
+                if (loadedAt[index] == 0 || misses - loadedAt[index] >= cacheSize)
+                {
+                    ++misses;
+                    ++triangleMisses;
+                    loadedAt[index] = misses;
+                }
+            }
+            if (triangle == 0 || triangleMisses == 3)
+            {
+                clusterStarts.push_back(triangle);
+            }
+        }
+    }
+    if (clusterStarts.size() < 2)
+    {
+        return;
+    }
+
+    CommonUtilities::Vector3<float> meshCenter(0.0f, 0.0f, 0.0f);
+    for (const Vertex& vertex : someVertices)
+    {
+        meshCenter += CommonUtilities::Vector3<float>(vertex.x, vertex.y, vertex.z);
+    }
+    meshCenter /= static_cast<float>(someVertices.size());
+
+    // Sort key: how far the cluster's area weighted normal points away from the mesh center
+    struct Cluster
+    {
+        size_t begin;
+        size_t end;
+        float outwardness;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < clusterStarts.size(); ++i)
+    {
+        Cluster cluster = { clusterStarts[i], i + 1 < clusterStarts.size() ? clusterStarts[i + 1] : triangleCount, 0.0f };
+
+        CommonUtilities::Vector3<float> center(0.0f, 0.0f, 0.0f);
+        CommonUtilities::Vector3<float> normal(0.0f, 0.0f, 0.0f);
+        float area = 0.0f;
+        for (size_t triangle = cluster.begin; triangle < cluster.end; ++triangle)
+        {
+            const Vertex& v0 = someVertices[someIndices[triangle * 3]];
+            const Vertex& v1 = someVertices[someIndices[triangle * 3 + 1]];
+            const Vertex& v2 = someVertices[someIndices[triangle * 3 + 2]];
+            const CommonUtilities::Vector3<float> p0(v0.x, v0.y, v0.z);
+            const CommonUtilities::Vector3<float> p1(v1.x, v1.y, v1.z);
+            const CommonUtilities::Vector3<float> p2(v2.x, v2.y, v2.z);
+
+            const CommonUtilities::Vector3<float> faceNormal = (p1 - p0).Cross(p2 - p0);
+            const float faceArea = faceNormal.Length();
+            normal += faceNormal;
+            center += (p0 + p1 + p2) * (faceArea / 3.0f);
+            area += faceArea;
+        }
+        if (area > 0.0f)
+        {
+            center /= area;
+            cluster.outwardness = (center - meshCenter).Dot(normal.GetNormalized());
+        }
+        clusters.push_back(cluster);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& aLeft, const Cluster& aRight) { return aLeft.outwardness > aRight.outwardness; });
+
+    std::vector<UINT> result;
+    result.reserve(someIndices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        result.insert(result.end(), someIndices.begin() + cluster.begin * 3, someIndices.begin() + cluster.end * 3);
+    }
+    someIndices.swap(result);
+}
+
+size_t OptimizeVertexFetch(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    const UINT unused = ~0u;
+    std::vector<UINT> remap(someVertices.size(), unused);
+    std::vector<Vertex> result;
+    result.reserve(someVertices.size());
+
+    for (UINT& index : someIndices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = static_cast<UINT>(result.size());
+            result.push_back(someVertices[index]);
+        }
+        index = remap[index];
+    }
+
+    const size_t removed = someVertices.size() - result.size();
+    someVertices.swap(result);
+    return removed;
+}
+
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    MeshOptimizationStats stats;
+    stats.acmrBefore = ComputeACMR(someIndices, someVertices.size());
+
+    OptimizeVertexCache(someIndices, someVertices.size());
+    OptimizeOverdraw(someIndices, someVertices);
+    stats.removedVertices = OptimizeVertexFetch(someVertices, someIndices);
+
+    stats.acmrAfter = ComputeACMR(someIndices, someVertices.size());
+    return stats;
+}
+
+MeshOptimizationStats OptimizeSharedLods(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, std::vector<MeshLod>& someLods)
+{
+    MeshOptimizationStats stats;
+    std::vector<UINT> indices;
+    indices.reserve(someIndices.size());
+    for (MeshLod& lod : someLods)
+    {
+        std::vector<UINT> lodIndices(someIndices.begin() + lod.startIndex, someIndices.begin() + lod.startIndex + lod.indexCount);
+        if (&lod == &someLods.front())
+        {
+            stats.acmrBefore = ComputeACMR(lodIndices, someVertices.size());
+        }
+
+        OptimizeVertexCache(lodIndices, someVertices.size());
+        OptimizeOverdraw(lodIndices, someVertices);
+        lod.startIndex = static_cast<UINT>(indices.size());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+
+    // The finest level comes first in the index buffer, so it decides the vertex order
+    someIndices.swap(indices);
+    stats.removedVertices = OptimizeVertexFetch(someVertices, someIndices);
+    if (!someLods.empty())
+    {
+        const std::vector<UINT> finest(someIndices.begin() + someLods[0].startIndex, someIndices.begin() + someLods[0].startIndex + someLods[0].indexCount);
+        stats.acmrAfter = ComputeACMR(finest, someVertices.size());
+    }
+    return stats;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "MeshLod.h"
+#include "Vertex.h"
+
+typedef unsigned int UINT;
+
+struct MeshOptimizationStats
+{
+    float acmrBefore = 0.0f; // Average cache misses per triangle, 0.5 is the ideal for a regular grid
+    float acmrAfter = 0.0f;
+    size_t removedVertices = 0;
+};
+
+// Simulated post-transform cache misses per triangle for a FIFO cache of aCacheSize entries
+float ComputeACMR(const std::vector<UINT>& someIndices, size_t aVertexCount, int aCacheSize = 16);
+
+// Reorders triangles for vertex cache reuse with Forsyth's linear-speed scoring
+void OptimizeVertexCache(std::vector<UINT>& someIndices, size_t aVertexCount);
+
+// Splits the cache-ordered triangles into clusters where the cache runs cold and draws the most outward facing
+// clusters first, so front faces fill the depth buffer early without giving up the cache order inside a cluster
+void OptimizeOverdraw(std::vector<UINT>& someIndices, const std::vector<Vertex>& someVertices);
+
+// Renumbers vertices in the order the index buffer first touches them and drops unreferenced ones
+size_t OptimizeVertexFetch(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+
+// All of the above in the order they have to run, safe to call on any triangle list
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+
+// Same for levels that index one shared vertex range (vertexCount 0): triangles are ordered per level and never move
+// between levels, vertices are renumbered for the finest level first. Stats describe the finest level
+MeshOptimizationStats OptimizeSharedLods(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, std::vector<MeshLod>& someLods);
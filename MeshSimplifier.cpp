@@ -0,0 +1,577 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <queue>
+
+#include "ParallelFor.h"
+
+namespace
+{
+    constexpr double locMinNormalCosine = 0.25;     // Remaining triangles may not tilt further than this in one collapse
+    constexpr double locReevaluateTolerance = 1e-6; // Popped costs that grew by more than this go back in the queue
+    constexpr float locMinLevelReduction = 0.95f;   // A level that keeps more of the previous one isn't worth having
+    constexpr size_t locMinLevelTriangles = 8;
+    constexpr UINT locInvalid = UINT_MAX;
+
+    // Sum of squared distances to area weighted planes, evaluated in double so large meshes stay stable
+    struct Quadric
+    {
+        double xx = 0.0, xy = 0.0, xz = 0.0, yy = 0.0, yz = 0.0, zz = 0.0;
+        double x = 0.0, y = 0.0, z = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const double aNormal[3], double aDistance, double aWeight)
+        {
+            xx += aWeight * aNormal[0] * aNormal[0];
+            xy += aWeight * aNormal[0] * aNormal[1];
+            xz += aWeight * aNormal[0] * aNormal[2];
+            yy += aWeight * aNormal[1] * aNormal[1];
+            yz += aWeight * aNormal[1] * aNormal[2];
+            zz += aWeight * aNormal[2] * aNormal[2];
+            x += aWeight * aNormal[0] * aDistance;
+            y += aWeight * aNormal[1] * aDistance;
+            z += aWeight * aNormal[2] * aDistance;
+            c += aWeight * aDistance * aDistance;
+            weight += aWeight;
+        }
+
+        void Add(const Quadric& anOther)
+        {
+            xx += anOther.xx; xy += anOther.xy; xz += anOther.xz;
+            yy += anOther.yy; yz += anOther.yz; zz += anOther.zz;
+            x += anOther.x; y += anOther.y; z += anOther.z;
+            c += anOther.c;
+            weight += anOther.weight;
+        }
+
+        double Evaluate(const Vertex& aVertex) const
+        {
+            const double px = aVertex.x, py = aVertex.y, pz = aVertex.z;
+            return xx * px * px + 2.0 * xy * px * py + 2.0 * xz * px * pz + yy * py * py + 2.0 * yz * py * pz + zz * pz * pz +
+                2.0 * (x * px + y * py + z * pz) + c;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost = DBL_MAX;
+        double geometricError = 0.0; // Distance the surface moved, in mesh units
+        UINT target = locInvalid;    // Position collapsed into
+        UINT targetVertex = locInvalid;
+    };
+
+    // Per thread buffers for the neighborhood walks, collapses are evaluated millions of times
+    struct Scratch
+    {
+        std::vector<UINT> neighbors;
+        std::vector<UINT> targetNeighbors;
+        std::vector<UINT> edgeApexes;
+    };
+
+    struct QueueEntry
+    {
+        double cost;
+        UINT position;
+        UINT version;
+
+        // std::priority_queue pops the largest, so cheaper and then lower positions compare larger
+        bool operator<(const QueueEntry& anOther) const
+        {
+            return cost != anOther.cost ? cost > anOther.cost : position > anOther.position;
+        }
+    };
+
+    void Cross(const double a[3], const double b[3], double aResult[3])
+    {
+        aResult[0] = a[1] * b[2] - a[2] * b[1];
+        aResult[1] = a[2] * b[0] - a[0] * b[2];
+        aResult[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    double Dot(const double a[3], const double b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void TriangleNormal(const Vertex& a, const Vertex& b, const Vertex& c, double aResult[3])
+    {
+        const double edge1[3] = { static_cast<double>(b.x) - a.x, static_cast<double>(b.y) - a.y, static_cast<double>(b.z) - a.z };
+        const double edge2[3] = { static_cast<double>(c.x) - a.x, static_cast<double>(c.y) - a.y, static_cast<double>(c.z) - a.z };
+        Cross(edge1, edge2, aResult);
+    }
+
+    // Vertices are the wedges of positions: copies of one point with different normals or uvs. Collapses move whole
+    // positions, a position with more than one wedge sits on a seam and stays where it is.
+    class Simplifier
+    {
+    public:
+        Simplifier(const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices, const MeshSimplifySettings& someSettings)
+            : myVertices(someVertices), mySettings(someSettings)
+        {
+            BuildPositions();
+            BuildTriangles(someIndices);
+            BuildLocks();
+            BuildQuadrics();
+        }
+
+        size_t GetTriangleCount() const { return myTriangleCount; }
+        double GetError() const { return myMaxError; }
+
+        // Collapses the cheapest positions until at most aTargetCount triangles are left or nothing can move
+        void Simplify(size_t aTargetCount)
+        {
+            if (!myIsQueueBuilt)
+            {
+                BuildQueue();
+            }
+
+            while (myTriangleCount > aTargetCount && !myQueue.empty())
+            {
+                const QueueEntry entry = myQueue.top();
+                myQueue.pop();
+                if (myIsRemoved[entry.position] || entry.version != myVersions[entry.position])
+                {
+                    continue;
+                }
+
+                // Neighbors further out may have changed since the cost was queued, a collapse that got invalid or more
+                // expensive goes back in with whatever is best now
+                GetNeighbors(entry.position, myScratch.neighbors);
+                Collapse collapse = EvaluateCollapse(entry.position, myBestCollapses[entry.position].target, myScratch);
+                if (collapse.target == locInvalid || collapse.cost > entry.cost + locReevaluateTolerance * (1.0 + std::abs(entry.cost)))
+                {
+                    collapse = FindBestCollapse(entry.position, myScratch);
+                    if (collapse.target != locInvalid)
+                    {
+                        Push(entry.position, collapse);
+                    }
+                    continue;
+                }
+
+                Apply(entry.position, collapse);
+            }
+        }
+
+        void AppendTriangles(std::vector<UINT>& someIndices) const
+        {
+            for (size_t triangle = 0; triangle < myIsAlive.size(); ++triangle)
+            {
+                if (myIsAlive[triangle])
+                {
+                    someIndices.insert(someIndices.end(), myTriangles.begin() + triangle * 3, myTriangles.begin() + triangle * 3 + 3);
+                }
+            }
+        }
+
+    private:
+        void BuildPositions()
+        {
+            // Sorting instead of hashing keeps the numbering independent of the standard library
+            std::vector<UINT> order(myVertices.size());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                order[i] = static_cast<UINT>(i);
+            }
+            auto lessPosition = [this](UINT a, UINT b)
+            {
+                const Vertex& va = myVertices[a];
+                const Vertex& vb = myVertices[b];
+                if (va.x != vb.x) return va.x < vb.x;
+                if (va.y != vb.y) return va.y < vb.y;
+                if (va.z != vb.z) return va.z < vb.z;
+                return a < b;
+            };
+            std::sort(order.begin(), order.end(), lessPosition);
+
+            myVertexPosition.assign(myVertices.size(), locInvalid);
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                const Vertex& vertex = myVertices[order[i]];
+                const bool isNew = i == 0 || vertex.x != myVertices[order[i - 1]].x || vertex.y != myVertices[order[i - 1]].y || vertex.z != myVertices[order[i - 1]].z;
+                if (isNew)
+                {
+                    myPositionVertex.push_back(order[i]);
+                    myWedgeCounts.push_back(0);
+                }
+                myVertexPosition[order[i]] = static_cast<UINT>(myPositionVertex.size() - 1);
+                ++myWedgeCounts.back();
+            }
+
+            myRadius = 0.0;
+            for (const Vertex& vertex : myVertices)
+            {
+                myRadius = std::max(myRadius, std::sqrt(static_cast<double>(vertex.x) * vertex.x + static_cast<double>(vertex.y) * vertex.y +
+                    static_cast<double>(vertex.z) * vertex.z));
+            }
+        }
+
+        void BuildTriangles(const std::vector<UINT>& someIndices)
+        {
+            const size_t positionCount = myPositionVertex.size();
+            myPositionTriangles.resize(positionCount);
+            for (size_t i = 0; i + 2 < someIndices.size(); i += 3)
+            {
+                const UINT a = myVertexPosition[someIndices[i]];
+                const UINT b = myVertexPosition[someIndices[i + 1]];
+                const UINT c = myVertexPosition[someIndices[i + 2]];
+                const UINT triangle = static_cast<UINT>(myIsAlive.size());
+                const bool isDegenerate = a == b || b == c || a == c;
+                myTriangles.insert(myTriangles.end(), { someIndices[i], someIndices[i + 1], someIndices[i + 2] });
+                myIsAlive.push_back(!isDegenerate);
+                if (isDegenerate)
+                {
+                    continue;
+                }
+                myPositionTriangles[a].push_back(triangle);
+                myPositionTriangles[b].push_back(triangle);
+                myPositionTriangles[c].push_back(triangle);
+                ++myTriangleCount;
+            }
+        }
+
+        // Seams and open or non-manifold edges are locked, moving them would tear the surface
+        void BuildLocks()
+        {
+            myIsLocked.assign(myPositionVertex.size(), 0);
+            myIsRemoved.assign(myPositionVertex.size(), 0);
+            myVersions.assign(myPositionVertex.size(), 0);
+            for (size_t position = 0; position < myPositionVertex.size(); ++position)
+            {
+                myIsLocked[position] = myWedgeCounts[position] > 1;
+            }
+
+            std::vector<unsigned long long> edges;
+            edges.reserve(myTriangleCount * 3);
+            for (size_t triangle = 0; triangle < myIsAlive.size(); ++triangle)
+            {
+                if (!myIsAlive[triangle])
+                {
+                    continue;
+                }
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const unsigned long long a = myVertexPosition[myTriangles[triangle * 3 + corner]];
+                    const unsigned long long b = myVertexPosition[myTriangles[triangle * 3 + (corner + 1) % 3]];
+                    edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t end = i + 1;
+                while (end < edges.size() && edges[end] == edges[i])
+                {
+                    ++end;
+                }
+                if (end - i != 2)
+                {
+                    myIsLocked[edges[i] >> 32] = 1;
+                    myIsLocked[edges[i] & 0xFFFFFFFFull] = 1;
+                }
+                i = end;
+            }
+        }
+
+        void BuildQuadrics()
+        {
+            // Each position sums the planes of its own triangles, so there is no scatter to synchronize
+            myQuadrics.assign(myPositionVertex.size(), Quadric());
+            ParallelFor(0, static_cast<int>(myPositionVertex.size()), [this](int aFirst, int aLast)
+            {
+                for (int position = aFirst; position < aLast; ++position)
+                {
+                    for (UINT triangle : myPositionTriangles[position])
+                    {
+                        const Vertex& a = myVertices[myTriangles[triangle * 3]];
+                        double normal[3];
+                        TriangleNormal(a, myVertices[myTriangles[triangle * 3 + 1]], myVertices[myTriangles[triangle * 3 + 2]], normal);
+                        const double length = std::sqrt(Dot(normal, normal));
+                        if (length <= 0.0)
+                        {
+                            continue;
+                        }
+                        const double unitNormal[3] = { normal[0] / length, normal[1] / length, normal[2] / length };
+                        const double distance = -(unitNormal[0] * a.x + unitNormal[1] * a.y + unitNormal[2] * a.z);
+                        myQuadrics[position].AddPlane(unitNormal, distance, length * 0.5);
+                    }
+                }
+            });
+        }
+
+        void BuildQueue()
+        {
+            std::vector<Collapse> collapses(myPositionVertex.size());
+            ParallelFor(0, static_cast<int>(myPositionVertex.size()), [&](int aFirst, int aLast)
+            {
+                Scratch scratch;
+                for (int position = aFirst; position < aLast; ++position)
+                {
+                    if (!myIsLocked[position])
+                    {
+                        collapses[position] = FindBestCollapse(position, scratch);
+                    }
+                }
+            });
+
+            myBestCollapses.resize(myPositionVertex.size());
+            for (size_t position = 0; position < collapses.size(); ++position)
+            {
+                if (collapses[position].target != locInvalid)
+                {
+                    Push(static_cast<UINT>(position), collapses[position]);
+                }
+            }
+            myIsQueueBuilt = true;
+        }
+
+        void Push(UINT aPosition, const Collapse& aCollapse)
+        {
+            myBestCollapses[aPosition] = aCollapse;
+            myQueue.push({ aCollapse.cost, aPosition, ++myVersions[aPosition] });
+        }
+
+        bool HasPosition(UINT aTriangle, UINT aPosition) const
+        {
+            return myVertexPosition[myTriangles[aTriangle * 3]] == aPosition || myVertexPosition[myTriangles[aTriangle * 3 + 1]] == aPosition ||
+                myVertexPosition[myTriangles[aTriangle * 3 + 2]] == aPosition;
+        }
+
+        void GetNeighbors(UINT aPosition, std::vector<UINT>& someNeighbors) const
+        {
+            someNeighbors.clear();
+            for (UINT triangle : myPositionTriangles[aPosition])
+            {
+                if (!myIsAlive[triangle])
+                {
+                    continue;
+                }
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const UINT position = myVertexPosition[myTriangles[triangle * 3 + corner]];
+                    if (position != aPosition && std::find(someNeighbors.begin(), someNeighbors.end(), position) == someNeighbors.end())
+                    {
+                        someNeighbors.push_back(position);
+                    }
+                }
+            }
+        }
+
+        Collapse FindBestCollapse(UINT aPosition, Scratch& aScratch) const
+        {
+            GetNeighbors(aPosition, aScratch.neighbors);
+
+            Collapse best;
+            for (UINT target : aScratch.neighbors)
+            {
+                const Collapse collapse = EvaluateCollapse(aPosition, target, aScratch);
+                if (collapse.cost < best.cost)
+                {
+                    best = collapse;
+                }
+            }
+            return best;
+        }
+
+        // aScratch.neighbors has to hold the neighbors of aPosition
+        Collapse EvaluateCollapse(UINT aPosition, UINT aTarget, Scratch& aScratch) const
+        {
+            const UINT sourceVertex = myPositionVertex[aPosition];
+            const Vertex& source = myVertices[sourceVertex];
+            const Vertex& targetPoint = myVertices[myPositionVertex[aTarget]];
+
+            // Triangles on the edge disappear, the rest move their source corner and must not fold over
+            Collapse collapse;
+            std::vector<UINT>& edgeApexes = aScratch.edgeApexes;
+            edgeApexes.clear();
+            for (UINT triangle : myPositionTriangles[aPosition])
+            {
+                if (!myIsAlive[triangle])
+                {
+                    continue;
+                }
+
+                const UINT* corners = &myTriangles[triangle * 3];
+                if (HasPosition(triangle, aTarget))
+                {
+                    for (int corner = 0; corner < 3; ++corner)
+                    {
+                        const UINT position = myVertexPosition[corners[corner]];
+                        if (position == aTarget)
+                        {
+                            // Every triangle on the edge has to agree on the target's wedge
+                            if (collapse.targetVertex != locInvalid && collapse.targetVertex != corners[corner])
+                            {
+                                return {};
+                            }
+                            collapse.targetVertex = corners[corner];
+                        }
+                        else if (position != aPosition)
+                        {
+                            edgeApexes.push_back(position);
+                        }
+                    }
+                    continue;
+                }
+
+                double before[3];
+                double after[3];
+                TriangleNormal(myVertices[corners[0]], myVertices[corners[1]], myVertices[corners[2]], before);
+                TriangleNormal(corners[0] == sourceVertex ? targetPoint : myVertices[corners[0]], corners[1] == sourceVertex ? targetPoint : myVertices[corners[1]],
+                    corners[2] == sourceVertex ? targetPoint : myVertices[corners[2]], after);
+                const double lengths = std::sqrt(Dot(before, before) * Dot(after, after));
+                if (lengths <= 0.0 || Dot(before, after) < locMinNormalCosine * lengths)
+                {
+                    return {};
+                }
+            }
+            if (collapse.targetVertex == locInvalid)
+            {
+                return {};
+            }
+
+            // Link condition: the only shared neighbors are the apexes of the edge's triangles, anything else pinches the surface
+            GetNeighbors(aTarget, aScratch.targetNeighbors);
+            for (UINT neighbor : aScratch.neighbors)
+            {
+                if (neighbor != aTarget && std::find(aScratch.targetNeighbors.begin(), aScratch.targetNeighbors.end(), neighbor) != aScratch.targetNeighbors.end() &&
+                    std::find(edgeApexes.begin(), edgeApexes.end(), neighbor) == edgeApexes.end())
+                {
+                    return {};
+                }
+            }
+
+            Quadric quadric = myQuadrics[aPosition];
+            quadric.Add(myQuadrics[aTarget]);
+            const double geometric = std::max(0.0, quadric.Evaluate(targetPoint));
+
+            // Attribute changes are priced as if they moved the surface, scaled by the mesh size and the area around the source
+            const Vertex& target = myVertices[collapse.targetVertex];
+            const double normalDelta = (source.nx - target.nx) * (source.nx - target.nx) + (source.ny - target.ny) * (source.ny - target.ny) +
+                (source.nz - target.nz) * (source.nz - target.nz);
+            const double texCoordDelta = (source.u - target.u) * (source.u - target.u) + (source.v - target.v) * (source.v - target.v);
+            const double attribute = (mySettings.normalWeight * normalDelta + mySettings.texCoordWeight * texCoordDelta) * myRadius * myRadius;
+
+            collapse.target = aTarget;
+            collapse.cost = geometric + myQuadrics[aPosition].weight * attribute;
+            collapse.geometricError = quadric.weight > 0.0 ? std::sqrt(geometric / quadric.weight) : 0.0;
+            return collapse;
+        }
+
+        void Apply(UINT aPosition, const Collapse& aCollapse)
+        {
+            const UINT sourceVertex = myPositionVertex[aPosition];
+            std::vector<UINT>& targetTriangles = myPositionTriangles[aCollapse.target];
+            for (UINT triangle : myPositionTriangles[aPosition])
+            {
+                if (!myIsAlive[triangle])
+                {
+                    continue;
+                }
+                if (HasPosition(triangle, aCollapse.target))
+                {
+                    myIsAlive[triangle] = 0;
+                    --myTriangleCount;
+                    continue;
+                }
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    UINT& vertex = myTriangles[triangle * 3 + corner];
+                    vertex = vertex == sourceVertex ? aCollapse.targetVertex : vertex;
+                }
+                targetTriangles.push_back(triangle);
+            }
+            targetTriangles.erase(std::remove_if(targetTriangles.begin(), targetTriangles.end(), [this](UINT aTriangle) { return !myIsAlive[aTriangle]; }),
+                targetTriangles.end());
+            std::vector<UINT>().swap(myPositionTriangles[aPosition]);
+
+            myQuadrics[aCollapse.target].Add(myQuadrics[aPosition]);
+            myIsRemoved[aPosition] = 1;
+            myMaxError = std::max(myMaxError, aCollapse.geometricError);
+
+            // The target has new neighbors to pick from. The rest of the ring is only checked again when it reaches the
+            // top of the queue, re-searching every neighbor here costs several times as much for nearly the same result
+            if (!myIsLocked[aCollapse.target])
+            {
+                const Collapse collapse = FindBestCollapse(aCollapse.target, myScratch);
+                if (collapse.target != locInvalid)
+                {
+                    Push(aCollapse.target, collapse);
+                }
+                else
+                {
+                    ++myVersions[aCollapse.target];
+                }
+            }
+        }
+
+        const std::vector<Vertex>& myVertices;
+        const MeshSimplifySettings& mySettings;
+        std::vector<UINT> myVertexPosition;             // Position of every vertex
+        std::vector<UINT> myPositionVertex;             // Lowest vertex at every position, the only one for unlocked positions
+        std::vector<UINT> myWedgeCounts;
+        std::vector<std::vector<UINT>> myPositionTriangles;
+        std::vector<UINT> myTriangles;                  // Current vertex indices, three per source triangle
+        std::vector<char> myIsAlive;
+        std::vector<char> myIsLocked;
+        std::vector<char> myIsRemoved;
+        std::vector<UINT> myVersions;
+        std::vector<Quadric> myQuadrics;
+        std::vector<Collapse> myBestCollapses;  // What each queued position was pushed with
+        std::priority_queue<QueueEntry> myQueue;
+        Scratch myScratch;
+        size_t myTriangleCount = 0;
+        double myRadius = 0.0;
+        double myMaxError = 0.0;
+        bool myIsQueueBuilt = false;
+    };
+}
+
+std::vector<MeshLod> SimplifyMeshLods(const std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, const MeshSimplifySettings& someSettings)
+{
+    std::vector<MeshLod> lods(1);
+    lods[0].indexCount = static_cast<UINT>(someIndices.size());
+    if (someSettings.levelCount <= 0 || someIndices.size() < locMinLevelTriangles * 3)
+    {
+        return lods;
+    }
+
+    Simplifier simplifier(someVertices, someIndices, someSettings);
+    float radius = 0.0f;
+    for (const Vertex& vertex : someVertices)
+    {
+        radius = std::max(radius, std::sqrt(vertex.x * vertex.x + vertex.y * vertex.y + vertex.z * vertex.z));
+    }
+
+    size_t previousCount = someIndices.size() / 3;
+    for (int level = 0; level < someSettings.levelCount; ++level)
+    {
+        const size_t targetCount = static_cast<size_t>(previousCount * someSettings.levelRatio);
+        if (targetCount < locMinLevelTriangles)
+        {
+            break;
+        }
+
+        simplifier.Simplify(targetCount);
+        const size_t count = simplifier.GetTriangleCount();
+        if (count > previousCount * locMinLevelReduction)
+        {
+            break;
+        }
+
+        // The level holds up while its error stays under the target on screen, error * screenSize / diameter <= target
+        MeshLod lod;
+        lod.startIndex = static_cast<UINT>(someIndices.size());
+        simplifier.AppendTriangles(someIndices);
+        lod.indexCount = static_cast<UINT>(someIndices.size()) - lod.startIndex;
+        const double error = simplifier.GetError();
+        lod.maxScreenSize = error > 0.0 ? static_cast<float>(someSettings.targetErrorPixels * 2.0 * radius / error) : FLT_MAX;
+        lod.maxScreenSize = std::min(lod.maxScreenSize, lods.back().maxScreenSize);
+        lods.push_back(lod);
+        previousCount = count;
+    }
+    return lods;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+
+#include "MeshLod.h"
+#include "Vertex.h"
+
+typedef unsigned int UINT;
+
+struct MeshSimplifySettings
+{
+    int levelCount = 0;              // Coarser levels to add after the original, 0 leaves the mesh alone
+    float levelRatio = 0.5f;         // Triangle count of each level relative to the one before it
+    float targetErrorPixels = 1.0f;  // How far a level may deviate on screen before the finer one takes over
+    float normalWeight = 0.25f;      // Cost of bending normals, relative to moving the surface by the mesh radius
+    float texCoordWeight = 1.0f;     // Cost of stretching uvs by a whole texture
+};
+
+// Quadric error edge collapses over the existing vertices, so every level is an index list into the same vertex
+// buffer. Appends the coarser levels to someIndices and returns the chain, finest first, with maxScreenSize set from
+// each level's geometric error. Uv seams, hard normal edges and open borders keep their vertices in place.
+// Quadrics and collapse costs are built on all hardware threads, the collapse order itself is serial and ties are
+// broken by vertex index, so the same input gives the same levels on any machine.
+std::vector<MeshLod> SimplifyMeshLods(const std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, const MeshSimplifySettings& someSettings);
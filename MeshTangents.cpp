@@ -0,0 +1,275 @@
+#include "MeshTangents.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <thread>
+
+#include "Includes/MeehanVector3.hpp"
+#include "ParallelFor.h"
+
+namespace
+{
+    using Vector3f = CommonUtilities::Vector3<float>;
+
+    constexpr size_t locTrianglesPerChunk = 16384; // Smaller meshes aren't worth a second accumulation buffer
+    constexpr float locMinTexCoordArea = 1e-12f;
+    constexpr UINT locNoSplit = UINT_MAX;
+
+    Vector3f GetPosition(const Vertex& aVertex) { return { aVertex.x, aVertex.y, aVertex.z }; }
+    Vector3f GetNormal(const Vertex& aVertex) { return { aVertex.nx, aVertex.ny, aVertex.nz }; }
+
+    Vector3f GetNormalizedOrZero(const Vector3f& aVector)
+    {
+        return aVector.LengthSqr() > 0.0f ? aVector.GetNormalized() : Vector3f(0.0f, 0.0f, 0.0f);
+    }
+
+    // Any unit vector perpendicular to aNormal
+    Vector3f GetPerpendicular(const Vector3f& aNormal)
+    {
+        const Vector3f axis = std::abs(aNormal.x) < 0.9f ? Vector3f(1.0f, 0.0f, 0.0f) : Vector3f(0.0f, 1.0f, 0.0f);
+        return (axis - aNormal * aNormal.Dot(axis)).GetNormalized();
+    }
+
+    bool IsSelected(const std::vector<char>& someMask, size_t aVertex)
+    {
+        // Vertices past the mask were split off selected ones
+        return someMask.empty() || aVertex >= someMask.size() || someMask[aVertex];
+    }
+
+    // Splits the triangles into a fixed number of chunks, each adding into its own zeroed sums with
+    // aFunction(firstTriangle, lastTriangle, someSums), then adds the chunks up per value in chunk order.
+    // No atomics and no locks, and the result doesn't depend on which thread ran which chunk.
+    template <class Function>
+    std::vector<Vector3f> AccumulateOverTriangles(size_t aTriangleCount, size_t aValueCount, const Function& aFunction)
+    {
+        const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunkCount = std::clamp(aTriangleCount / locTrianglesPerChunk, static_cast<size_t>(1), threadCount);
+        const size_t chunkSize = (aTriangleCount + chunkCount - 1) / chunkCount;
+
+        std::vector<std::vector<Vector3f>> sums(chunkCount, std::vector<Vector3f>(aValueCount, Vector3f(0.0f, 0.0f, 0.0f)));
+        ParallelFor(0, static_cast<int>(chunkCount), [&](int aFirst, int aLast)
+        {
+            for (int chunk = aFirst; chunk < aLast; ++chunk)
+            {
+                const size_t first = chunk * chunkSize;
+                aFunction(first, std::min(first + chunkSize, aTriangleCount), sums[chunk]);
+            }
+        });
+
+        ParallelFor(0, static_cast<int>(aValueCount), [&](int aFirst, int aLast)
+        {
+            for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+            {
+                for (int value = aFirst; value < aLast; ++value)
+                {
+                    sums[0][value] += sums[chunk][value];
+                }
+            }
+        });
+        return std::move(sums[0]);
+    }
+
+    // Unit directions of +u and +v across one triangle. orientation is the sign of the triangle's uv area, -1 where
+    // the uvs are mirrored, 0 where they are degenerate and the triangle can't say anything about the frame
+    struct TriangleFrame
+    {
+        Vector3f tangent;
+        Vector3f bitangent;
+        int orientation = 0;
+    };
+
+    TriangleFrame ComputeTriangleFrame(const Vertex& a, const Vertex& b, const Vertex& c)
+    {
+        const Vector3f edge1 = GetPosition(b) - GetPosition(a);
+        const Vector3f edge2 = GetPosition(c) - GetPosition(a);
+        const float du1 = b.u - a.u;
+        const float dv1 = b.v - a.v;
+        const float du2 = c.u - a.u;
+        const float dv2 = c.v - a.v;
+        const float area = du1 * dv2 - du2 * dv1;
+
+        TriangleFrame frame;
+        if (std::abs(area) < locMinTexCoordArea)
+        {
+            return frame;
+        }
+
+        // Solve edge = du * tangent + dv * bitangent for both edges, only the direction matters
+        const float sign = area > 0.0f ? 1.0f : -1.0f;
+        frame.tangent = GetNormalizedOrZero((edge1 * dv2 - edge2 * dv1) * sign);
+        frame.bitangent = GetNormalizedOrZero((edge2 * du1 - edge1 * du2) * sign);
+        frame.orientation = frame.tangent.LengthSqr() > 0.0f ? static_cast<int>(sign) : 0;
+        return frame;
+    }
+
+    // Angle of the triangle at aCorner, measured in the tangent plane of the corner's normal like MikkTSpace does
+    float GetCornerAngle(const Vector3f& aNormal, const Vector3f& aCorner, const Vector3f& aNext, const Vector3f& aPrevious)
+    {
+        const Vector3f toNext = GetNormalizedOrZero((aNext - aCorner) - aNormal * aNormal.Dot(aNext - aCorner));
+        const Vector3f toPrevious = GetNormalizedOrZero((aPrevious - aCorner) - aNormal * aNormal.Dot(aPrevious - aCorner));
+        return std::acos(std::clamp(toNext.Dot(toPrevious), -1.0f, 1.0f));
+    }
+}
+
+void GenerateNormals(std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices, const std::vector<char>& someMissing)
+{
+    const std::vector<Vector3f> normals = AccumulateOverTriangles(someIndices.size() / 3, someVertices.size(),
+        [&](size_t aFirst, size_t aLast, std::vector<Vector3f>& someSums)
+    {
+        for (size_t triangle = aFirst; triangle < aLast; ++triangle)
+        {
+            const UINT* corners = &someIndices[triangle * 3];
+            const Vector3f a = GetPosition(someVertices[corners[0]]);
+            const Vector3f b = GetPosition(someVertices[corners[1]]);
+            const Vector3f c = GetPosition(someVertices[corners[2]]);
+            // The edge cross product points into the surface, its length is twice the area
+            const Vector3f faceNormal = (c - a).Cross(b - a);
+            someSums[corners[0]] += faceNormal;
+            someSums[corners[1]] += faceNormal;
+            someSums[corners[2]] += faceNormal;
+        }
+    });
+
+    for (size_t i = 0; i < someVertices.size(); ++i)
+    {
+        if (!IsSelected(someMissing, i))
+        {
+            continue;
+        }
+        const Vector3f normal = normals[i].LengthSqr() > 0.0f ? normals[i].GetNormalized() : Vector3f(0.0f, 1.0f, 0.0f);
+        someVertices[i].nx = normal.x;
+        someVertices[i].ny = normal.y;
+        someVertices[i].nz = normal.z;
+    }
+}
+
+void GenerateTangents(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, const std::vector<char>& someMissing)
+{
+    const size_t triangleCount = someIndices.size() / 3;
+    std::vector<TriangleFrame> frames(triangleCount);
+    ParallelFor(0, static_cast<int>(triangleCount), [&](int aFirst, int aLast)
+    {
+        for (int triangle = aFirst; triangle < aLast; ++triangle)
+        {
+            const UINT* corners = &someIndices[triangle * 3];
+            frames[triangle] = ComputeTriangleFrame(someVertices[corners[0]], someVertices[corners[1]], someVertices[corners[2]]);
+        }
+    });
+
+    // A vertex can only hold one handedness, vertices shared by mirrored and unmirrored triangles get a copy for the
+    // triangles that disagree with the first one, the same split MikkTSpace makes
+    std::vector<signed char> orientations(someVertices.size(), 0);
+    std::vector<UINT> splits(someVertices.size(), locNoSplit);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const int orientation = frames[triangle].orientation;
+        if (orientation == 0)
+        {
+            continue;
+        }
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            UINT& vertex = someIndices[triangle * 3 + corner];
+            if (!IsSelected(someMissing, vertex) || orientations[vertex] == orientation)
+            {
+                continue;
+            }
+            if (orientations[vertex] == 0)
+            {
+                orientations[vertex] = static_cast<signed char>(orientation);
+                continue;
+            }
+            if (splits[vertex] == locNoSplit)
+            {
+                splits[vertex] = static_cast<UINT>(someVertices.size());
+                someVertices.push_back(someVertices[vertex]);
+            }
+            vertex = splits[vertex];
+        }
+    }
+
+    // Corners add the face directions projected into their own tangent plane, weighted by the corner angle.
+    // Tangents sit at even entries and bitangents at odd ones
+    const std::vector<Vector3f> sums = AccumulateOverTriangles(triangleCount, someVertices.size() * 2,
+        [&](size_t aFirst, size_t aLast, std::vector<Vector3f>& someSums)
+    {
+        for (size_t triangle = aFirst; triangle < aLast; ++triangle)
+        {
+            const TriangleFrame& frame = frames[triangle];
+            if (frame.orientation == 0)
+            {
+                continue;
+            }
+
+            const UINT* corners = &someIndices[triangle * 3];
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const Vertex& vertex = someVertices[corners[corner]];
+                const Vector3f normal = GetNormal(vertex);
+                const float angle = GetCornerAngle(normal, GetPosition(vertex), GetPosition(someVertices[corners[(corner + 1) % 3]]),
+                    GetPosition(someVertices[corners[(corner + 2) % 3]]));
+                someSums[corners[corner] * 2] += GetNormalizedOrZero(frame.tangent - normal * normal.Dot(frame.tangent)) * angle;
+                someSums[corners[corner] * 2 + 1] += GetNormalizedOrZero(frame.bitangent - normal * normal.Dot(frame.bitangent)) * angle;
+            }
+        }
+    });
+
+    ParallelFor(0, static_cast<int>(someVertices.size()), [&](int aFirst, int aLast)
+    {
+        for (int i = aFirst; i < aLast; ++i)
+        {
+            if (!IsSelected(someMissing, i))
+            {
+                continue;
+            }
+
+            Vertex& vertex = someVertices[i];
+            const Vector3f normal = GetNormal(vertex);
+            Vector3f tangent = GetNormalizedOrZero(sums[i * 2] - normal * normal.Dot(sums[i * 2]));
+            if (tangent.LengthSqr() == 0.0f)
+            {
+                tangent = GetPerpendicular(normal);
+            }
+
+            // Mirrored vertices flip the bitangent so it keeps following +v
+            Vector3f bitangent = normal.Cross(tangent);
+            if (bitangent.Dot(sums[i * 2 + 1]) < 0.0f)
+            {
+                bitangent = bitangent * -1.0f;
+            }
+
+            vertex.tx = tangent.x;
+            vertex.ty = tangent.y;
+            vertex.tz = tangent.z;
+            vertex.bx = bitangent.x;
+            vertex.by = bitangent.y;
+            vertex.bz = bitangent.z;
+        }
+    });
+}
+
+void CompleteTangentFrames(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    std::vector<char> missingNormals(someVertices.size(), 0);
+    std::vector<char> missingTangents(someVertices.size(), 0);
+    bool hasMissingNormals = false;
+    bool hasMissingTangents = false;
+    for (size_t i = 0; i < someVertices.size(); ++i)
+    {
+        const Vertex& vertex = someVertices[i];
+        missingNormals[i] = vertex.nx == 0.0f && vertex.ny == 0.0f && vertex.nz == 0.0f;
+        missingTangents[i] = vertex.tx == 0.0f && vertex.ty == 0.0f && vertex.tz == 0.0f;
+        hasMissingNormals |= missingNormals[i] != 0;
+        hasMissingTangents |= missingTangents[i] != 0;
+    }
+
+    if (hasMissingNormals)
+    {
+        GenerateNormals(someVertices, someIndices, missingNormals);
+    }
+    if (hasMissingTangents)
+    {
+        GenerateTangents(someVertices, someIndices, missingTangents);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+#include "Vertex.h"
+
+typedef unsigned int UINT;
+
+// Area weighted vertex normals from the triangles, in the engine's winding. someMissing selects the vertices to
+// write (non-zero entries), empty writes every vertex.
+void GenerateNormals(std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices, const std::vector<char>& someMissing = {});
+
+// Tangents along +u and bitangents along +v from the texture coordinates, built the way MikkTSpace builds them so
+// normal maps from the usual bakers line up: face directions are projected into each corner's tangent plane and
+// weighted by the corner angle, and a vertex shared by mirrored and unmirrored uvs is split in two (appended to
+// someVertices, someIndices updated). Vertices without usable uvs get an arbitrary frame around their normal.
+// someMissing works as for GenerateNormals. Both run over triangles on all hardware threads, each thread adding
+// into its own buffer.
+void GenerateTangents(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices, const std::vector<char>& someMissing = {});
+
+// Generates the normals and tangents a mesh generator left at zero and keeps the ones it wrote
+void CompleteTangentFrames(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
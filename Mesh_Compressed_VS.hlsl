@@ -0,0 +1,33 @@
+#include "Common.hlsli"
+
+// Static meshes in CompressedVertexFormat, the same output as Mesh_VS
+PixelInputType main(CompressedVertexInputType input)
+{
+    PixelInputType output;
+
+    // Transform position
+    float4 vertexObjectPos = DecodePosition(input.position);
+    float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
+    float4 vertexClipPos = mul(worldToClip, vertexWorldPos);
+
+    // Rebuild the frame in object space, the bitangent isn't stored
+    float3 normal = DecodeUnitVector(input.normal);
+    float3 tangent = DecodeUnitVector(input.tangent);
+    float3 bitangent = DecodeBitangent(normal, tangent, input.tangent);
+
+    // Transform normal, tangent, and bitangent to world space
+    float3x3 toWorldRotation = (float3x3)modelToWorld;
+
+    // Pass data to the pixel shader
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = input.color;
+    output.uv = input.uv;
+
+    output.normal = normalize(mul(toWorldRotation, normal));
+    output.tangent = normalize(mul(toWorldRotation, tangent));
+    output.bitangent = normalize(mul(toWorldRotation, bitangent));
+    output.depth = vertexClipPos.z / vertexClipPos.w;
+
+    return output;
+}
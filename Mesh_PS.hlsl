@@ -0,0 +1,17 @@
+#include "Common.hlsli"
+
+PixelOutput main(PixelInputType input)
+{
+    PixelOutput result;
+
+    float4 albedo = defaultTexture.Sample(defaultSampler, input.uv) * input.color;
+
+    // Plain lambert against the sun, the sky and ground colors stand in for image based lighting
+    float3 normal = normalize(input.normal);
+    float3 ambient = lerp(ambientColor2.rgb * ambientIntensity2, ambientColor1.rgb * ambientIntensity1, normal.y * 0.5f + 0.5f);
+    float3 sun = directionalLightColor.rgb * directionalLightIntensity * saturate(dot(normal, normalize(directionalLightDirection)));
+
+    result.color.rgb = albedo.rgb * (ambient + sun);
+    result.color.a = albedo.a;
+    return result;
+}
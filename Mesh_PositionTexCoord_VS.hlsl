@@ -0,0 +1,27 @@
+#include "Common.hlsli"
+
+// Static meshes written by the mesh converter in its position-texcoord layout, they carry no frame so the object's axes stand in
+PixelInputType main(PositionTexCoordVertexInputType input)
+{
+    PixelInputType output;
+
+    // Transform position
+    float4 vertexObjectPos = input.position;
+    float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
+    float4 vertexClipPos = mul(worldToClip, vertexWorldPos);
+
+    float3x3 toWorldRotation = (float3x3)modelToWorld;
+
+    // Pass data to the pixel shader
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    output.uv = input.uv;
+
+    output.normal = normalize(mul(toWorldRotation, float3(0.0f, 1.0f, 0.0f)));
+    output.tangent = normalize(mul(toWorldRotation, float3(1.0f, 0.0f, 0.0f)));
+    output.bitangent = normalize(mul(toWorldRotation, float3(0.0f, 0.0f, 1.0f)));
+    output.depth = vertexClipPos.z / vertexClipPos.w;
+
+    return output;
+}
@@ -0,0 +1,28 @@
+#include "Common.hlsli"
+
+// Static meshes written by the mesh converter in its standard layout
+PixelInputType main(VertexInputType input)
+{
+    PixelInputType output;
+
+    // Transform position
+    float4 vertexObjectPos = input.position;
+    float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
+    float4 vertexClipPos = mul(worldToClip, vertexWorldPos);
+
+    // Transform normal, tangent, and bitangent to world space
+    float3x3 toWorldRotation = (float3x3)modelToWorld;
+
+    // Pass data to the pixel shader
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = input.color;
+    output.uv = input.uv;
+
+    output.normal = normalize(mul(toWorldRotation, input.normal));
+    output.tangent = normalize(mul(toWorldRotation, input.tangent));
+    output.bitangent = normalize(mul(toWorldRotation, input.bitangent));
+    output.depth = vertexClipPos.z / vertexClipPos.w;
+
+    return output;
+}
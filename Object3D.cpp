@@ -1,127 +1,294 @@
 #include "Object3D.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 
 #include "Engine.h"
 #include "GraphicsEngine.h"
+#include "MeshTangents.h"
 #include "TextureManager.h"
 #include "Vertex.h"
 
+// Prints tangent frame timings and cache stats for every generated mesh, the stats stay available either way
+// through GetMeshOptimizationStats
+//#define REPORT_MESH_PROCESSING
+
 bool Object3D::Initialize(ID3D11Device* aDevice)
 {
-    std::vector<Vertex> vertices;
-    std::vector<UINT> indices;
-    CreateGeometry(vertices, indices);
     InitObjectResources();
-    if (!CreateBuffers(aDevice, vertices, indices))
+
+    // Objects with a geometry key skip generation entirely when another instance already uploaded the mesh
+    GeometryRegistry& registry = Engine::GetInstance().GetGraphicsEngine().GetGeometryRegistry();
+    if (!UseSharedGeometry(registry.Find(GetGeometryKey())))
     {
-        return false;
+        std::vector<Vertex> vertices;
+        std::vector<UINT> indices;
+        CreateGeometry(vertices, indices);
+        GenerateTangentFrames(vertices, indices);
+        OptimizeGeometry(vertices, indices);
+        if (!CreateBuffers(aDevice, vertices, indices))
+        {
+            return false;
+        }
     }
     return LoadShadersAndCreateInputLayout(aDevice);
 }
-void Object3D::Render(ID3D11DeviceContext* aContext)
+void Object3D::Record(RenderCommandBuffer& aCommands, RenderState* aBoundState) const
 {
-    aContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    aContext->IASetInputLayout(myInputLayout.Get());
-    unsigned int stride = sizeof(Vertex);
-    unsigned int offset = 0;
-    aContext->IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
-    aContext->IASetIndexBuffer(myIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-    aContext->VSSetShader(myVertexShader.Get(), nullptr, 0);
-    aContext->PSSetShader(myPixelShader.Get(), nullptr, 0);
+    BindRenderState(aCommands, aBoundState);
+    const MeshLod& lod = myGeometry->lods[myLodIndex];
+    aCommands.DrawIndexed(lod.indexCount, lod.startIndex, lod.baseVertex);
+}
+void Object3D::RenderInstanced(RenderContext& aContext, ID3D11Buffer* anInstanceBuffer, UINT aFirstInstance, UINT anInstanceCount)
+{
+    aContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    aContext.IASetInputLayout(myInstancedInputLayout.Get());
+    ID3D11Buffer* buffers[2] = { myVertexBuffer.Get(), anInstanceBuffer };
+    unsigned int strides[2] = { myGeometry->vertexStride, sizeof(CommonUtilities::Matrix4x4<float>) };
+    unsigned int offsets[2] = { 0, 0 };
+    aContext.IASetVertexBuffers(0, 2, buffers, strides, offsets);
+    aContext.IASetIndexBuffer(myIndexBuffer.Get(), myGeometry->indexFormat, 0);
+    aContext.VSSetShader(myInstancedVertexShader.Get(), nullptr, 0);
+    aContext.PSSetShader(myPixelShader.Get(), nullptr, 0);
     if (myTexture)
     {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
+        aContext.PSSetShaderResources(0, 1, GetTexture());
     }
-    /*else
-    {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
-    }*/
-    aContext->DrawIndexed(myIndexCount, 0, 0);
+    const MeshLod& lod = myGeometry->lods[myLodIndex];
+    aContext.DrawIndexedInstanced(lod.indexCount, anInstanceCount, lod.startIndex, lod.baseVertex, aFirstInstance);
 }
-bool Object3D::LoadShadersAndCreateInputLayout(ID3D11Device* aDevice)
+InstanceKey Object3D::GetInstanceKey() const
+{
+    return { myGeometry.get(), myInstancedVertexShader.Get(), myPixelShader.Get(), myTexture.Get(), myLodIndex };
+}
+RenderState Object3D::GetRenderState() const
 {
-    std::string vsData;
-    std::ifstream vsFile;
-    vsFile.open(GetVertexShaderPath(), std::ios::binary);
-    if (!vsFile.is_open())
+    return { myInputLayout.Get(), myVertexShader.Get(), myPixelShader.Get(), myTexture.Get(), myGeometry.get() };
+}
+void Object3D::BindRenderState(RenderCommandBuffer& aCommands, RenderState* aBoundState) const
+{
+    const RenderState state = GetRenderState();
+    const bool bindAll = aBoundState == nullptr;
+    if (bindAll)
     {
-        std::cerr << "Failed to open vertex shader file: " << GetVertexShaderPath() << std::endl;
-        return false;
+        aCommands.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     }
-    vsData = { std::istreambuf_iterator<char>(vsFile), std::istreambuf_iterator<char>() };
-    vsFile.close();
-
-    HRESULT hr = aDevice->CreateVertexShader(vsData.data(), vsData.size(), nullptr, &myVertexShader);
-    if (FAILED(hr))
+    if (bindAll || aBoundState->inputLayout != state.inputLayout)
     {
-        std::cerr << "Failed to create vertex shader: " << GetVertexShaderPath() << " Error: " << std::hex << hr << std::endl;
-        return false;
+        aCommands.IASetInputLayout(myInputLayout.Get());
+    }
+    if (bindAll || aBoundState->geometry != state.geometry)
+    {
+        unsigned int stride = myGeometry->vertexStride;
+        unsigned int offset = 0;
+        aCommands.IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
+        aCommands.IASetIndexBuffer(myIndexBuffer.Get(), myGeometry->indexFormat, 0);
+    }
+    if (bindAll || aBoundState->vertexShader != state.vertexShader)
+    {
+        aCommands.VSSetShader(myVertexShader.Get());
+    }
+    if (bindAll || aBoundState->pixelShader != state.pixelShader)
+    {
+        aCommands.PSSetShader(myPixelShader.Get());
+    }
+    // Objects without a texture leave the previous one bound
+    if (myTexture && (bindAll || aBoundState->texture != state.texture))
+    {
+        aCommands.PSSetShaderResources(0, 1, GetTexture());
     }
 
-    std::ifstream psFile;
-    psFile.open(GetPixelShaderPath(), std::ios::binary);
-    if (!psFile.is_open())
+    if (aBoundState)
     {
-        std::cerr << "Failed to open pixel shader file: " << GetPixelShaderPath() << std::endl;
-        return false;
+        const void* boundTexture = aBoundState->texture;
+        *aBoundState = state;
+        aBoundState->texture = myTexture ? state.texture : boundTexture;
+    }
+}
+void Object3D::SelectLod(const CommonUtilities::Vector3<float>& aCameraPosition, float aPixelsPerUnit, int aForcedLod)
+{
+    if (!myGeometry || myGeometry->lods.size() < 2)
+    {
+        myLodIndex = 0;
+        return;
+    }
+    if (aForcedLod >= 0)
+    {
+        myLodIndex = std::min(static_cast<size_t>(aForcedLod), myGeometry->lods.size() - 1);
+        return;
     }
-    std::string psData = { std::istreambuf_iterator<char>(psFile), std::istreambuf_iterator<char>() };
-    psFile.close();
 
-    hr = aDevice->CreatePixelShader(psData.data(), psData.size(), nullptr, &myPixelShader);
-    if (FAILED(hr))
+    // Projected bounding sphere diameter, inside the sphere counts as infinitely large
+    const float distance = (myPosition - aCameraPosition).Length();
+    const float radius = myGeometry->boundingRadius;
+    const float screenSize = distance > radius ? 2.0f * radius * aPixelsPerUnit / distance : FLT_MAX;
+    myLodIndex = SelectMeshLod(myGeometry->lods, screenSize, myLodIndex);
+}
+bool Object3D::GetBoundingSphere(CommonUtilities::Vector3<float>& aCenter, float& aRadius) const
+{
+    if (!myGeometry)
     {
-        std::cerr << "Failed to create pixel shader: " << GetPixelShaderPath() << " Error: " << std::hex << hr << std::endl;
         return false;
     }
 
-    D3D11_INPUT_ELEMENT_DESC layout[] =
+    // The radius is around the mesh origin, rotation doesn't change it and the largest scale bounds the rest
+    aCenter = myPosition;
+    aRadius = myGeometry->boundingRadius * std::max({ std::abs(myScale.x), std::abs(myScale.y), std::abs(myScale.z) });
+    return true;
+}
+bool Object3D::LoadShadersAndCreateInputLayout(ID3D11Device* aDevice)
+{
+    // Shaders and the input layout are compiled once per path and shared between objects
+    GeometryRegistry& registry = Engine::GetInstance().GetGraphicsEngine().GetGeometryRegistry();
+    if (!myInstancedVertexShaderPath.empty() &&
+        !registry.GetVertexShader(myInstancedVertexShaderPath, GetVertexFormat(), myInstancedVertexShader, myInstancedInputLayout, true))
     {
-        { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    };
-
-    hr = aDevice->CreateInputLayout(layout, _countof(layout), vsData.data(), vsData.size(), &myInputLayout);
-    if (FAILED(hr))
+        return false;
+    }
+    if (!registry.GetVertexShader(GetVertexShaderPath(), GetVertexFormat(), myVertexShader, myInputLayout) ||
+        !registry.GetPixelShader(GetPixelShaderPath(), myPixelShader))
     {
-        std::cerr << "Failed to create input layout for vertex shader: " << GetVertexShaderPath() << " Error: " << std::hex << hr << std::endl;
         return false;
     }
+    UpdateRenderStateIds();
     return true;
 }
+void Object3D::UpdateRenderStateIds()
+{
+    myRenderStateIds = Engine::GetInstance().GetGraphicsEngine().GetRenderQueue().GetStateIds(GetRenderState());
+}
 bool Object3D::CreateBuffers(ID3D11Device* aDevice, const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices)
 {
-    D3D11_BUFFER_DESC bufferDesc = {};
-    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    bufferDesc.CPUAccessFlags = 0;
-    D3D11_SUBRESOURCE_DATA initData = {};
-
-    // Vertex buffer
-    bufferDesc.ByteWidth = static_cast<UINT>(sizeof(Vertex) * someVertices.size());
-    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    initData.pSysMem = someVertices.data();
-    if (FAILED(aDevice->CreateBuffer(&bufferDesc, &initData, myVertexBuffer.GetAddressOf())))
+    GeometryRegistry& registry = Engine::GetInstance().GetGraphicsEngine().GetGeometryRegistry();
+    return UseSharedGeometry(registry.Acquire(GetGeometryKey(), someVertices, someIndices, GetVertexFormat(), myGeneratedLods));
+}
+bool Object3D::UseSharedGeometry(const std::shared_ptr<const SharedGeometry>& aGeometry)
+{
+    if (!aGeometry)
     {
         return false;
     }
 
-    // Index buffer
-    bufferDesc.ByteWidth = static_cast<UINT>(sizeof(UINT) * someIndices.size());
-    bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    initData.pSysMem = someIndices.data();
-    if (FAILED(aDevice->CreateBuffer(&bufferDesc, &initData, myIndexBuffer.GetAddressOf())))
+    myGeometry = aGeometry;
+    myVertexBuffer = aGeometry->vertexBuffer;
+    myIndexBuffer = aGeometry->indexBuffer;
+    myIndexCount = aGeometry->indexCount;
+    myLodIndex = 0;
+    return true;
+}
+std::string Object3D::GetGeometryKey() const
+{
+    return {};
+}
+const VertexFormatDesc& Object3D::GetVertexFormat() const
+{
+    return GetVertexFormatDesc<StandardVertexFormat>();
+}
+void Object3D::GenerateTangentFrames(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+#if defined(REPORT_MESH_PROCESSING)
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    const bool ownsVertices = std::any_of(myGeneratedLods.begin(), myGeneratedLods.end(), [](const MeshLod& aLod) { return aLod.vertexCount > 0; });
+    if (!ownsVertices)
     {
-        return false;
+        CompleteTangentFrames(someVertices, someIndices);
     }
+    else
+    {
+        // Split vertices are appended, so every level is completed on its own copy and packed back in order
+        std::vector<Vertex> vertices;
+        for (MeshLod& lod : myGeneratedLods)
+        {
+            std::vector<Vertex> lodVertices(someVertices.begin() + lod.baseVertex, someVertices.begin() + lod.baseVertex + lod.vertexCount);
+            std::vector<UINT> lodIndices(someIndices.begin() + lod.startIndex, someIndices.begin() + lod.startIndex + lod.indexCount);
+            CompleteTangentFrames(lodVertices, lodIndices);
 
-    myIndexCount = static_cast<unsigned int>(someIndices.size());
-    return true;
+            std::copy(lodIndices.begin(), lodIndices.end(), someIndices.begin() + lod.startIndex);
+            lod.baseVertex = static_cast<int>(vertices.size());
+            lod.vertexCount = static_cast<UINT>(lodVertices.size());
+            vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+        }
+        someVertices.swap(vertices);
+    }
+
+#if defined(REPORT_MESH_PROCESSING)
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    std::cout << "Tangent frames for " << GetVertexShaderPath() << ": " << someVertices.size() << " vertices in " << duration.count() << " ms" << std::endl;
+#endif
+}
+void Object3D::OptimizeGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    if (!myOptimizeMesh)
+    {
+        return;
+    }
+
+    if (myGeneratedLods.empty())
+    {
+        myMeshOptimizationStats = OptimizeMesh(someVertices, someIndices);
+    }
+    else
+    {
+        OptimizeLods(someVertices, someIndices);
+    }
+#if defined(REPORT_MESH_PROCESSING)
+    std::cout << "Optimized mesh for " << GetVertexShaderPath() << ": ACMR " << myMeshOptimizationStats.acmrBefore
+        << " -> " << myMeshOptimizationStats.acmrAfter << ", " << myMeshOptimizationStats.removedVertices << " unused vertices removed" << std::endl;
+#endif
+}
+void Object3D::OptimizeLods(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    // Simplified chains index one vertex range, the vertex order can follow all levels at once
+    const bool isShared = std::all_of(myGeneratedLods.begin(), myGeneratedLods.end(), [](const MeshLod& aLod) { return aLod.vertexCount == 0; });
+    if (isShared)
+    {
+        myMeshOptimizationStats = OptimizeSharedLods(someVertices, someIndices, myGeneratedLods);
+        return;
+    }
+
+    // Each level is optimized on its own so triangles never move between levels, stats are for the finest one
+    std::vector<Vertex> vertices;
+    std::vector<UINT> indices;
+    for (size_t level = 0; level < myGeneratedLods.size(); ++level)
+    {
+        MeshLod& lod = myGeneratedLods[level];
+        std::vector<UINT> lodIndices(someIndices.begin() + lod.startIndex, someIndices.begin() + lod.startIndex + lod.indexCount);
+        if (lod.vertexCount == 0)
+        {
+            // Levels sharing one vertex range can only reorder their triangles
+            OptimizeVertexCache(lodIndices, someVertices.size());
+            lod.startIndex = static_cast<UINT>(indices.size());
+            indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+            continue;
+        }
+
+        std::vector<Vertex> lodVertices(someVertices.begin() + lod.baseVertex, someVertices.begin() + lod.baseVertex + lod.vertexCount);
+        const MeshOptimizationStats stats = OptimizeMesh(lodVertices, lodIndices);
+        if (level == 0)
+        {
+            myMeshOptimizationStats = stats;
+        }
+        else
+        {
+            myMeshOptimizationStats.removedVertices += stats.removedVertices;
+        }
+
+        lod.startIndex = static_cast<UINT>(indices.size());
+        lod.baseVertex = static_cast<int>(vertices.size());
+        lod.vertexCount = static_cast<UINT>(lodVertices.size());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+        vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+    }
+
+    if (!vertices.empty())
+    {
+        someVertices.swap(vertices);
+    }
+    someIndices.swap(indices);
 }
 void Object3D::UpdateTransformationMatrix()
 {
@@ -135,11 +302,11 @@ void Object3D::UpdateWorldMatrix()
     myWorldMatrix = transMat;
 }
 
-std::string Object3D::GetVertexShaderPath() const
+const std::string& Object3D::GetVertexShaderPath() const
 {
     return myVertexShaderPath;
 }
-std::string Object3D::GetPixelShaderPath() const
+const std::string& Object3D::GetPixelShaderPath() const
 {
     return myPixelShaderPath;
 }
@@ -147,7 +314,7 @@ const CommonUtilities::Matrix4x4<float>& Object3D::GetModelToWorld() const
 {
     return myTransformationMatrix;
 }
-CommonUtilities::Matrix4x4<float> Object3D::GetWorldMatrix()
+CommonUtilities::Matrix4x4<float> Object3D::GetWorldMatrix() const
 {
     return myWorldMatrix;
 }
@@ -173,9 +340,22 @@ void Object3D::SetPixelShaderPath(const std::string& aPath)
 
     myPixelShaderPath = solutionDir + shaderDir + aPath;
 }
+void Object3D::SetInstancedVertexShaderPath(const std::string& aPath)
+{
+    std::string solutionDir = SOLUTION_DIR;
+    std::string shaderDir = "TGP/Shaders/";
+
+    myInstancedVertexShaderPath = solutionDir + shaderDir + aPath;
+}
 void Object3D::SetTexture(ID3D11ShaderResourceView* aTexture)
 {
     myTexture = aTexture;
+
+    // Textures set before the shaders are loaded get their ids with them
+    if (myPixelShader)
+    {
+        UpdateRenderStateIds();
+    }
 }
 void Object3D::SetPosition(const CommonUtilities::Vector3<float>& aPos)
 {
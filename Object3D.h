@@ -1,10 +1,18 @@
 #pragma once
 #include <wrl/client.h>
 #include <d3d11.h>
+#include <memory>
 #include <vector>
 #include <string>
 #include "Includes/Matrix4x4.h"
+#include "GeometryRegistry.h"
+#include "InstanceBatcher.h"
+#include "MeshOptimizer.h"
+#include "RenderQueue.h"
+#include "RenderCommandBuffer.h"
+#include "StateFilteringContext.h"
 #include "Vertex.h"
+#include "VertexFormat.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -16,40 +24,83 @@ public:
 
     virtual bool Initialize(ID3D11Device* aDevice);
     virtual bool InitObjectResources() = 0;
-    virtual void Render(ID3D11DeviceContext* aContext);
+    // Records the draw, safe on worker threads. aBoundState, when given, is what the previous draw left bound: only
+    // the differences are rebound and it is updated to this draw's state. nullptr binds everything
+    virtual void Record(RenderCommandBuffer& aCommands, RenderState* aBoundState = nullptr) const;
+    // Draws anInstanceCount copies of the mesh, their transforms read from anInstanceBuffer starting at aFirstInstance
+    virtual void RenderInstanced(RenderContext& aContext, ID3D11Buffer* anInstanceBuffer, UINT aFirstInstance, UINT anInstanceCount);
+    bool SupportsInstancing() const { return myInstancedVertexShader != nullptr; }
+    InstanceKey GetInstanceKey() const;
+    RenderState GetRenderState() const;
+    const RenderStateIds& GetRenderStateIds() const { return myRenderStateIds; }
+    uint32_t GetMaterialId() const { return myRenderStateIds.material; }
+    RenderPass GetRenderPass() const { return myIsBlended ? RenderPass::Blended : RenderPass::Opaque; }
+    bool HasPass(uint32_t aPassMask) const { return (myPassMask & aPassMask) != 0; }
+    // Picks the detail level from the projected size, aPixelsPerUnit is the screen size of one unit at distance 1.
+    // aForcedLod >= 0 overrides the choice, clamped to the levels the mesh has
+    void SelectLod(const CommonUtilities::Vector3<float>& aCameraPosition, float aPixelsPerUnit, int aForcedLod = -1);
+    size_t GetLodIndex() const { return myLodIndex; }
+    // World space sphere around the mesh, false when there is no geometry to bound
+    bool GetBoundingSphere(CommonUtilities::Vector3<float>& aCenter, float& aRadius) const;
+    const SharedGeometry* GetGeometry() const { return myGeometry.get(); }
 
     void SetPosition(const CommonUtilities::Vector3<float>& aPosition);
     void SetRotation(const CommonUtilities::Vector3<float>& aRotation);
     void SetScale(const CommonUtilities::Vector3<float>& aScale);
 
+    const CommonUtilities::Vector3<float>& GetPosition() const { return myPosition; }
     const CommonUtilities::Matrix4x4<float>& GetModelToWorld() const;
-    CommonUtilities::Matrix4x4<float> GetWorldMatrix();
+    CommonUtilities::Matrix4x4<float> GetWorldMatrix() const;
     CommonUtilities::Vector3<float> GetNormal() const;
 
     void SetTexture(ID3D11ShaderResourceView* aTexture);
     ID3D11ShaderResourceView* const* GetTexture() const;
-    std::string GetVertexShaderPath() const;
-    std::string GetPixelShaderPath() const;
+    const std::string& GetVertexShaderPath() const;
+    const std::string& GetPixelShaderPath() const;
+    const MeshOptimizationStats& GetMeshOptimizationStats() const { return myMeshOptimizationStats; }
 	void SetVertexShaderPath(const std::string& aPath);
 	void SetPixelShaderPath(const std::string& aPath);
+	void SetInstancedVertexShaderPath(const std::string& aPath);
 
 protected:
     virtual void CreateGeometry(std::vector<Vertex>& vertices, std::vector<UINT>& indices) = 0;
+    // Generator type and parameters identifying the mesh so instances can share it, empty to share by content
+    virtual std::string GetGeometryKey() const;
+    // Attributes uploaded for this mesh, the vertex shader's inputs have to match. Defaults to StandardVertexFormat
+    virtual const VertexFormatDesc& GetVertexFormat() const;
 
     bool LoadShadersAndCreateInputLayout(ID3D11Device* aDevice);
+    void UpdateRenderStateIds();
+    void BindRenderState(RenderCommandBuffer& aCommands, RenderState* aBoundState) const;
     bool CreateBuffers(ID3D11Device* aDevice, const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices);
+    // Fills in the normals and tangents CreateGeometry left at zero, level by level for chains with their own vertices
+    void GenerateTangentFrames(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+    void OptimizeGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+    void OptimizeLods(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+    bool UseSharedGeometry(const std::shared_ptr<const SharedGeometry>& aGeometry);
 
     ComPtr<ID3D11Buffer> myLightBuffer;
+    std::shared_ptr<const SharedGeometry> myGeometry;
     ComPtr<ID3D11Buffer> myVertexBuffer;
     ComPtr<ID3D11Buffer> myIndexBuffer;
     ComPtr<ID3D11VertexShader> myVertexShader;
     ComPtr<ID3D11PixelShader> myPixelShader;
     ComPtr<ID3D11InputLayout> myInputLayout;
+    ComPtr<ID3D11VertexShader> myInstancedVertexShader;
+    ComPtr<ID3D11InputLayout> myInstancedInputLayout;
     ComPtr<ID3D11ShaderResourceView> myTexture;
     unsigned int myIndexCount = 0;
+    std::vector<MeshLod> myGeneratedLods; // Levels CreateGeometry laid out in its buffers, empty for single level meshes
+    size_t myLodIndex = 0;
+    bool myOptimizeMesh = true; // Turn off for objects that rely on the generated index order
+    bool myIsBlended = false; // Blended objects are drawn after the opaque ones, back to front
+    uint32_t myPassMask = PassMaskMain | PassMaskReflection;
+    RenderStateIds myRenderStateIds;
+    MeshOptimizationStats myMeshOptimizationStats;
 
 	std::string myVertexShaderPath;
 	std::string myPixelShaderPath;
+	std::string myInstancedVertexShaderPath; // Empty for objects that always draw one at a time
 
     CommonUtilities::Matrix4x4<float> myTransformationMatrix;
     CommonUtilities::Matrix4x4<float> myWorldMatrix;
@@ -1,7 +1,15 @@
 #pragma once
 #include "Includes/Matrix4x4.h"
+#include "Includes/MeehanVector4.hpp"
+#include "ConstantBuffer.h"
 
 struct ObjectBufferData
 {
 	CommonUtilities::Matrix4x4<float> modelToWorldMatrix;
-};
\ No newline at end of file
+	// Decodes quantized positions as offset + stored * scale, identity for float meshes. w is unused
+	CommonUtilities::Vector4<float> positionScale;
+	CommonUtilities::Vector4<float> positionOffset;
+};
+CHECK_HLSL_PACKING(ObjectBufferData, modelToWorldMatrix);
+CHECK_HLSL_PACKING(ObjectBufferData, positionScale);
+CHECK_HLSL_PACKING(ObjectBufferData, positionOffset);
\ No newline at end of file
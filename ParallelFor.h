@@ -0,0 +1,40 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Splits [aBegin, anEnd) into one contiguous range per hardware thread and calls aFunction(rangeBegin, rangeEnd) for each.
+// The calling thread works on the first range, so small jobs never pay for a thread spawn.
+template <class Function>
+void ParallelFor(int aBegin, int anEnd, const Function& aFunction)
+{
+    const int count = anEnd - aBegin;
+    if (count <= 0)
+    {
+        return;
+    }
+
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::clamp(threadCount, 1, count);
+    if (threadCount == 1)
+    {
+        aFunction(aBegin, anEnd);
+        return;
+    }
+
+    const int rangeSize = (count + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (int rangeBegin = aBegin + rangeSize; rangeBegin < anEnd; rangeBegin += rangeSize)
+    {
+        const int rangeEnd = std::min(rangeBegin + rangeSize, anEnd);
+        workers.emplace_back([&aFunction, rangeBegin, rangeEnd]() { aFunction(rangeBegin, rangeEnd); });
+    }
+
+    aFunction(aBegin, std::min(aBegin + rangeSize, anEnd));
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
@@ -5,6 +5,13 @@
 
 void Plane::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
 {
+    if (!myWaterBodies.empty())
+    {
+        CreateWaterBodyGeometry(someVertices, someIndices);
+        CalculateNormal(someVertices);
+        return;
+    }
+
     // Define plane size (make it larger)
     float width = 1000.0f; // Adjust the size as needed
     float depth = 1000.0f; // Adjust the size as needed
@@ -25,6 +32,37 @@ void Plane::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>&
 
 	CalculateNormal(someVertices);
 }
+void Plane::SetWaterBodies(std::vector<WaterBody> someWaterBodies)
+{
+    myWaterBodies = std::move(someWaterBodies);
+}
+void Plane::CreateWaterBodyGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    for (WaterBody& body : myWaterBodies)
+    {
+        body.startIndex = static_cast<unsigned int>(someIndices.size());
+
+        for (const WaterRect& rect : body.rects)
+        {
+            const float left = rect.minX;
+            const float right = rect.maxX;
+            const float back = rect.minZ;
+            const float front = rect.maxZ;
+
+            // UVs follow world XZ at the old quad's scale so neighbouring rects tile seamlessly
+            const float uvScale = 1.0f / 1000.0f;
+            const UINT first = static_cast<UINT>(someVertices.size());
+            someVertices.push_back({ left, 0.0f, back, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, left * uvScale, -back * uvScale });    // Bottom-left
+            someVertices.push_back({ right, 0.0f, back, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, right * uvScale, -back * uvScale });  // Bottom-right
+            someVertices.push_back({ right, 0.0f, front, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, right * uvScale, -front * uvScale }); // Top-right
+            someVertices.push_back({ left, 0.0f, front, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, left * uvScale, -front * uvScale });  // Top-left
+
+            someIndices.insert(someIndices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+        }
+
+        body.indexCount = static_cast<unsigned int>(someIndices.size()) - body.startIndex;
+    }
+}
 void Plane::CalculateNormal(std::vector<Vertex>& someVertices)
 {
     // Define two edges of the plane
@@ -42,12 +80,20 @@ void Plane::CalculateNormal(std::vector<Vertex>& someVertices)
     // Normalize the result to get the unit normal
     myNormal.Normalize();
 }
+const VertexFormatDesc& Plane::GetVertexFormat() const
+{
+    return GetVertexFormatDesc<PositionTexCoordVertexFormat>();
+}
 bool Plane::InitObjectResources()
 {
     TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
 
-    SetVertexShaderPath("Terrain_VS.cso");
+    SetVertexShaderPath("Plane_VS.cso");
     SetPixelShaderPath("Plane_PS.cso");
+    myPassMask = PassMaskMain | PassMaskWater; // Samples the reflection, so it can't be drawn into it
+
+    // Water bodies keep index ranges into the generated order
+    myOptimizeMesh = myWaterBodies.empty();
 
     if (!textureManager.LoadTexture("Pyramid", "lattice.png"))
     {
@@ -1,5 +1,6 @@
 #pragma once
 #include "Object3D.h"
+#include "WaterBodies.h"
 
 class Plane : public Object3D
 {
@@ -9,5 +10,15 @@ public:
 	void CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices) override;
 	void CalculateNormal(std::vector<Vertex>& someVertices);
 	bool InitObjectResources() override;
+	const VertexFormatDesc& GetVertexFormat() const override;
+
+	// Replaces the default 1000x1000 quad with tight quads over each body, laid out in world XZ for a plane at the origin
+	void SetWaterBodies(std::vector<WaterBody> someWaterBodies);
+	const std::vector<WaterBody>& GetWaterBodies() const { return myWaterBodies; }
+
+private:
+	void CreateWaterBodyGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+
+	std::vector<WaterBody> myWaterBodies;
 };
 
@@ -1,6 +1,44 @@
 #include "Common.hlsli"
 #include "PBRFunctions.hlsli"
 
+// How far apart two reflection depth values are, relative to the reference. The reflection is drawn with an oblique
+// near plane, so its depth can't be turned back into a view distance, but 1 - depth falls off with one over the
+// distance and this comes out close to the relative difference in distance.
+float ReflectionDepthDifference(float aDepth, float aReferenceDepth)
+{
+    return abs(aDepth - aReferenceDepth) / max(1.0f - aReferenceDepth, 1e-6f);
+}
+
+// The reflection may be drawn at a fraction of the screen resolution. Plain bilinear filtering would bleed the sky
+// into the silhouettes it reflects, so each of the four texels is also weighted by how close its depth is to the
+// depth of the texel nearest to the pixel. At full resolution this comes down to a single texel.
+float3 SampleReflection(float2 aUV)
+{
+    float2 size;
+    reflectionTexture.GetDimensions(size.x, size.y);
+    const int2 maxTexel = int2(size) - 1;
+
+    const float2 texel = aUV * size - 0.5f;
+    const int2 base = int2(floor(texel));
+    const float2 fraction = texel - base;
+    const float referenceDepth = reflectionDepthTexture.Load(int3(clamp(int2(round(texel)), 0, maxTexel), 0));
+
+    float3 color = 0.0f;
+    float weightSum = 0.0f;
+    [unroll]
+    for (int i = 0; i < 4; ++i)
+    {
+        const int2 offset = int2(i & 1, i >> 1);
+        const int3 coordinate = int3(clamp(base + offset, 0, maxTexel), 0);
+        const float2 bilinear = lerp(1.0f - fraction, fraction, float2(offset));
+        const float depth = reflectionDepthTexture.Load(coordinate);
+        const float weight = bilinear.x * bilinear.y / (1e-3f + ReflectionDepthDifference(depth, referenceDepth));
+        color += reflectionTexture.Load(coordinate).rgb * weight;
+        weightSum += weight;
+    }
+    return color / max(weightSum, 1e-6f);
+}
+
 PixelOutput main(PixelInputType input)
 {
     PixelOutput result;
@@ -18,7 +56,7 @@ PixelOutput main(PixelInputType input)
     float waterHeightOffset = 0.099f;
     float waterBlendFactor = saturate((distanceFromWater + waterHeightOffset) / (2.0f * waterHeightOffset));
 
-    float3 reflectionBaseColor = reflectionTexture.Sample(defaultSampler, wavePosition.xy / resolution).rgb;
+    float3 reflectionBaseColor = SampleReflection(wavePosition.xy / resolution);
     
     float3 fresnel = Fresnel_Schlick(float3(0.25f, 0.25f, 0.25f), float3(0.0f, 1.0f, 0.0f), viewDirection);
 
@@ -35,8 +73,10 @@ PixelOutput main(PixelInputType input)
     // Check if the resulting color is the clear color
     if (all(result.color.rgb == clearColor))
     {
-        // Sample the surrounding pixels
-        float2 texelSize = 1.0f / resolution;
+        // Sample the surrounding reflection texels
+        float2 reflectionSize;
+        reflectionTexture.GetDimensions(reflectionSize.x, reflectionSize.y);
+        float2 texelSize = 1.0f / reflectionSize;
         float3 color1 = reflectionTexture.Sample(defaultSampler, wavePosition.xy / resolution + float2(-texelSize.x, 0)).rgb;
         float3 color2 = reflectionTexture.Sample(defaultSampler, wavePosition.xy / resolution + float2(texelSize.x, 0)).rgb;
         float3 color3 = reflectionTexture.Sample(defaultSampler, wavePosition.xy / resolution + float2(0, -texelSize.y)).rgb;
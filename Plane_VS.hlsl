@@ -0,0 +1,24 @@
+#include "Common.hlsli"
+
+PixelInputType main(PositionTexCoordVertexInputType input)
+{
+    PixelInputType output;
+
+    // Transform position
+    float4 vertexObjectPos = input.position;
+    float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
+    float4 vertexClipPos = mul(worldToClip, vertexWorldPos);
+
+    // Pass data to the pixel shader, the water surface is flat so its frame is constant
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    output.uv = input.uv;
+
+    output.normal = float3(0.0f, 1.0f, 0.0f);
+    output.tangent = float3(1.0f, 0.0f, 0.0f);
+    output.bitangent = float3(0.0f, 0.0f, 1.0f);
+    output.depth = vertexClipPos.z / vertexClipPos.w;
+
+    return output;
+}
@@ -32,12 +32,21 @@ void Pyramid::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT
         3, 0, 4  // Side 4
     };
 }
+std::string Pyramid::GetGeometryKey() const
+{
+    return "Pyramid";
+}
+const VertexFormatDesc& Pyramid::GetVertexFormat() const
+{
+    return GetVertexFormatDesc<PositionTexCoordVertexFormat>();
+}
 bool Pyramid::InitObjectResources()
 {
     TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
 
     SetVertexShaderPath("Triangle_VS.cso");
     SetPixelShaderPath("Triangle_PS.cso");
+    SetInstancedVertexShaderPath("Triangle_Instanced_VS.cso");
 
     if (!textureManager.LoadTexture("Pyramid", "lattice.png"))
     {
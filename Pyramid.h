@@ -10,4 +10,6 @@ public:
 	~Pyramid() = default;
 	void CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices) override;
 	bool InitObjectResources() override;
+	std::string GetGeometryKey() const override;
+	const VertexFormatDesc& GetVertexFormat() const override;
 };
\ No newline at end of file
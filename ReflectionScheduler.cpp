@@ -0,0 +1,51 @@
+#include "ReflectionScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+ReflectionUpdateReason ReflectionScheduler::Update(const ReflectionView& aView)
+{
+    const ReflectionUpdateReason reason = GetReason(aView);
+    ++myStats.reasonCounts[static_cast<int>(reason)];
+    if (reason == ReflectionUpdateReason::None)
+    {
+        ++myFramesSinceUpdate;
+        ++myStats.reusedFrames;
+        return reason;
+    }
+
+    myLastView = aView;
+    myFramesSinceUpdate = 0;
+    myHasReflection = true;
+    ++myStats.renderedFrames;
+    return reason;
+}
+ReflectionUpdateReason ReflectionScheduler::GetReason(const ReflectionView& aView) const
+{
+    if (!myHasReflection)
+    {
+        return ReflectionUpdateReason::Invalidated;
+    }
+    if (myFramesSinceUpdate + 1 >= myPolicy.maxFrameInterval)
+    {
+        return ReflectionUpdateReason::Interval;
+    }
+    if ((aView.position - myLastView.position).LengthSqr() > myPolicy.maxCameraMovement * myPolicy.maxCameraMovement)
+    {
+        return ReflectionUpdateReason::CameraMoved;
+    }
+
+    const float cosine = aView.forward.x * myLastView.forward.x + aView.forward.y * myLastView.forward.y + aView.forward.z * myLastView.forward.z;
+    if (std::acos(std::clamp(cosine, -1.0f, 1.0f)) > myPolicy.maxCameraRotation)
+    {
+        return ReflectionUpdateReason::CameraRotated;
+    }
+
+    // The day wraps, 23:55 and 00:05 are ten minutes apart
+    const double timeChange = std::fabs(aView.timeOfDay - myLastView.timeOfDay);
+    if (std::min(timeChange, 24.0 - timeChange) > myPolicy.maxTimeOfDayChange)
+    {
+        return ReflectionUpdateReason::TimeOfDay;
+    }
+    return ReflectionUpdateReason::None;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Includes/MeehanVector3.hpp"
+
+// When the planar reflection is drawn again instead of reusing the last one. Each threshold is measured against the
+// view the reflection was last drawn from
+struct ReflectionUpdatePolicy
+{
+    unsigned int maxFrameInterval = 4;  // Drawn at least every this many frames, 1 draws it every frame
+    float maxCameraMovement = 0.5f;     // World units
+    float maxCameraRotation = 0.02f;    // Radians between the forward directions
+    float maxTimeOfDayChange = 0.1f;    // Hours, the light follows the time of day
+};
+
+// What the reflection depends on
+struct ReflectionView
+{
+    CommonUtilities::Vector3<float> position;
+    CommonUtilities::Vector3<float> forward;    // Unit length
+    double timeOfDay = 0.0;                     // Hours, wraps at 24
+};
+
+enum class ReflectionUpdateReason
+{
+    None,           // The last reflection is reused
+    Invalidated,    // Nothing to reuse yet, or the textures were recreated
+    Interval,
+    CameraMoved,
+    CameraRotated,
+    TimeOfDay,
+    Count
+};
+
+struct ReflectionStats
+{
+    unsigned int renderedFrames = 0;
+    unsigned int reusedFrames = 0;
+    unsigned int reasonCounts[static_cast<int>(ReflectionUpdateReason::Count)] = {};
+};
+
+// Decides each frame whether the reflection has to be drawn, only from the views it is given, so the same sequence
+// of views always gives the same decisions
+class ReflectionScheduler
+{
+public:
+    void SetPolicy(const ReflectionUpdatePolicy& aPolicy) { myPolicy = aPolicy; }
+    const ReflectionUpdatePolicy& GetPolicy() const { return myPolicy; }
+
+    // The next frame draws the reflection whatever the policy says
+    void Invalidate() { myHasReflection = false; }
+    // Called once per frame that shows the reflection, anything but None means it is drawn from aView this frame
+    ReflectionUpdateReason Update(const ReflectionView& aView);
+
+    const ReflectionStats& GetStats() const { return myStats; }
+    void ResetStats() { myStats = ReflectionStats(); }
+
+private:
+    ReflectionUpdateReason GetReason(const ReflectionView& aView) const;
+
+    ReflectionUpdatePolicy myPolicy;
+    ReflectionView myLastView;
+    unsigned int myFramesSinceUpdate = 0;
+    bool myHasReflection = false;
+    ReflectionStats myStats;
+};
@@ -0,0 +1,75 @@
+#include "RenderCommandBuffer.h"
+
+#include <algorithm>
+
+void RenderCommandBuffer::Clear()
+{
+    myBytes.clear();
+    myCommandCount = 0;
+    myConstantsCount = 0;
+    myLargestConstants = 0;
+}
+void RenderCommandBuffer::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY aTopology)
+{
+    Write(SetTopologyCommand{ aTopology });
+}
+void RenderCommandBuffer::IASetInputLayout(ID3D11InputLayout* anInputLayout)
+{
+    Write(SetInputLayoutCommand{ anInputLayout });
+}
+void RenderCommandBuffer::IASetVertexBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers, const UINT* someStrides, const UINT* someOffsets)
+{
+    // One command per slot keeps commands fixed size
+    for (UINT i = 0; i < aCount; ++i)
+    {
+        Write(BindVertexBufferCommand{ aStartSlot + i, someBuffers[i], someStrides[i], someOffsets[i] });
+    }
+}
+void RenderCommandBuffer::IASetIndexBuffer(ID3D11Buffer* aBuffer, DXGI_FORMAT aFormat, UINT anOffset)
+{
+    Write(BindIndexBufferCommand{ aBuffer, aFormat, anOffset });
+}
+void RenderCommandBuffer::VSSetShader(ID3D11VertexShader* aShader)
+{
+    Write(SetVertexShaderCommand{ aShader });
+}
+void RenderCommandBuffer::PSSetShader(ID3D11PixelShader* aShader)
+{
+    Write(SetPixelShaderCommand{ aShader });
+}
+void RenderCommandBuffer::PSSetShaderResources(UINT aStartSlot, UINT aCount, ID3D11ShaderResourceView* const* someViews)
+{
+    for (UINT i = 0; i < aCount; ++i)
+    {
+        Write(BindPixelShaderResourceCommand{ aStartSlot + i, someViews[i] });
+    }
+}
+void RenderCommandBuffer::UpdateConstants(UINT aSlot, UINT aStages, const void* someData, UINT aSize)
+{
+    Write(UpdateConstantsCommand{ aSlot, aStages, aSize }, someData, aSize);
+    ++myConstantsCount;
+    myLargestConstants = std::max(myLargestConstants, aSize);
+}
+void RenderCommandBuffer::DrawIndexed(UINT anIndexCount, UINT aStartIndex, INT aBaseVertex)
+{
+    Write(DrawIndexedCommand{ anIndexCount, aStartIndex, aBaseVertex });
+}
+
+size_t ParallelRenderCommands::GetConstantsCount() const
+{
+    size_t count = 0;
+    for (size_t job = 0; job < myJobCount; ++job)
+    {
+        count += myJobCommands[job].GetConstantsCount();
+    }
+    return count;
+}
+UINT ParallelRenderCommands::GetLargestConstants() const
+{
+    UINT largest = 0;
+    for (size_t job = 0; job < myJobCount; ++job)
+    {
+        largest = std::max(largest, myJobCommands[job].GetLargestConstants());
+    }
+    return largest;
+}
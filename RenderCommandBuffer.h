@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "D3D11Types.h"
+#include "WorkerPool.h"
+
+enum class RenderCommandType : uint8_t
+{
+    // State
+    SetTopology,
+    SetInputLayout,
+    SetVertexShader,
+    SetPixelShader,
+    // Bindings
+    BindVertexBuffer,
+    BindIndexBuffer,
+    BindPixelShaderResource,
+    // Constants, the data follows the command
+    UpdateConstants,
+    // Draws
+    DrawIndexed
+};
+
+// Every command starts with one. size covers the header, the command and its data, rounded up so the next header
+// is aligned
+struct RenderCommandHeader
+{
+    RenderCommandType type;
+    uint32_t size;
+};
+
+struct SetTopologyCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::SetTopology;
+    D3D11_PRIMITIVE_TOPOLOGY topology;
+};
+struct SetInputLayoutCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::SetInputLayout;
+    ID3D11InputLayout* inputLayout;
+};
+struct SetVertexShaderCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::SetVertexShader;
+    ID3D11VertexShader* shader;
+};
+struct SetPixelShaderCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::SetPixelShader;
+    ID3D11PixelShader* shader;
+};
+struct BindVertexBufferCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::BindVertexBuffer;
+    UINT slot;
+    ID3D11Buffer* buffer;
+    UINT stride;
+    UINT offset;
+};
+struct BindIndexBufferCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::BindIndexBuffer;
+    ID3D11Buffer* buffer;
+    DXGI_FORMAT format;
+    UINT offset;
+};
+struct BindPixelShaderResourceCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::BindPixelShaderResource;
+    UINT slot;
+    ID3D11ShaderResourceView* view;
+};
+struct UpdateConstantsCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::UpdateConstants;
+    UINT slot;
+    UINT stages;    // ConstantStage flags
+    UINT size;      // Bytes of data following the command
+};
+struct DrawIndexedCommand
+{
+    static constexpr RenderCommandType ourType = RenderCommandType::DrawIndexed;
+    UINT indexCount;
+    UINT startIndex;
+    INT baseVertex;
+};
+
+// Draw submission written down as plain commands in one linear block of memory, so it can be recorded on any
+// thread and issued on the immediate context later. The recording calls keep the names of the context calls they
+// stand for, like StateFilteringContext. Handles are stored as raw pointers and have to outlive the replay.
+// Class linkage isn't recorded.
+class RenderCommandBuffer
+{
+public:
+    // Keeps the memory, buffers are recorded again every frame
+    void Clear();
+
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY aTopology);
+    void IASetInputLayout(ID3D11InputLayout* anInputLayout);
+    void IASetVertexBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers, const UINT* someStrides, const UINT* someOffsets);
+    void IASetIndexBuffer(ID3D11Buffer* aBuffer, DXGI_FORMAT aFormat, UINT anOffset);
+    void VSSetShader(ID3D11VertexShader* aShader);
+    void PSSetShader(ID3D11PixelShader* aShader);
+    void PSSetShaderResources(UINT aStartSlot, UINT aCount, ID3D11ShaderResourceView* const* someViews);
+    // Copies aSize bytes of someData into the buffer, replay hands them to whatever uploads constants
+    void UpdateConstants(UINT aSlot, UINT aStages, const void* someData, UINT aSize);
+    void DrawIndexed(UINT anIndexCount, UINT aStartIndex, INT aBaseVertex);
+
+    bool IsEmpty() const { return myBytes.empty(); }
+    size_t GetSize() const { return myBytes.size(); }
+    size_t GetCommandCount() const { return myCommandCount; }
+    size_t GetConstantsCount() const { return myConstantsCount; }
+    UINT GetLargestConstants() const { return myLargestConstants; }
+
+    // Issues the commands in recording order. aContext needs the calls of a RenderContext used here,
+    // aSetConstants(const UpdateConstantsCommand&, const void* someData) uploads and binds constants
+    template <class Context, class SetConstants>
+    void Replay(Context& aContext, const SetConstants& aSetConstants) const;
+
+    // Calls aVisit(const UpdateConstantsCommand&, const void* someData) for each constant update in recording order
+    template <class Visit>
+    void ForEachConstants(const Visit& aVisit) const;
+
+private:
+    static constexpr size_t ourAlignment = alignof(void*);
+
+    template <class Command>
+    void Write(const Command& aCommand, const void* someData = nullptr, UINT aDataSize = 0);
+    template <class Command>
+    static Command Read(const unsigned char* aCommand);
+    template <class Visit>
+    void ForEachCommand(const Visit& aVisit) const;
+
+    std::vector<unsigned char> myBytes;
+    size_t myCommandCount = 0;
+    size_t myConstantsCount = 0;
+    UINT myLargestConstants = 0;
+};
+
+// Records a range of items into one RenderCommandBuffer per job on a WorkerPool, e.g. the objects of a pass with
+// their constants. Buffers belong to jobs rather than threads, so the merged stream is the same whatever the core
+// count: every job in order, each as it was recorded. A job starts without knowing what the previous one left bound
+// and binds all state on its first draw, a StateFilteringContext drops what is already bound.
+class ParallelRenderCommands
+{
+public:
+    // aRecord(RenderCommandBuffer& aCommands, size_t aFirst, size_t aLast) records [aFirst, aLast) of
+    // [0, anItemCount), it runs on aPool's threads at once. anItemsPerJob has to be at least one
+    template <class RecordJob>
+    void Record(WorkerPool& aPool, size_t anItemCount, size_t anItemsPerJob, const RecordJob& aRecord);
+
+    size_t GetJobCount() const { return myJobCount; }
+    const RenderCommandBuffer& GetCommands(size_t aJob) const { return myJobCommands[aJob]; }
+    size_t GetConstantsCount() const;
+    UINT GetLargestConstants() const;
+
+    // Replays the jobs' buffers one after the other, see RenderCommandBuffer::Replay
+    template <class Context, class SetConstants>
+    void Replay(Context& aContext, const SetConstants& aSetConstants) const;
+    template <class Visit>
+    void ForEachConstants(const Visit& aVisit) const;
+
+private:
+    std::vector<RenderCommandBuffer> myJobCommands; // Only grows, so buffers keep their memory between frames
+    size_t myJobCount = 0;
+};
+
+template <class Command>
+void RenderCommandBuffer::Write(const Command& aCommand, const void* someData, UINT aDataSize)
+{
+    static_assert(std::is_trivially_copyable_v<Command>, "Render commands are copied bytewise");
+    static_assert(alignof(Command) <= ourAlignment, "Commands are placed right after an aligned header");
+
+    const size_t size = (sizeof(RenderCommandHeader) + sizeof(Command) + aDataSize + ourAlignment - 1) & ~(ourAlignment - 1);
+    const RenderCommandHeader header = { Command::ourType, static_cast<uint32_t>(size) };
+
+    const size_t offset = myBytes.size();
+    myBytes.resize(offset + size);
+    unsigned char* destination = myBytes.data() + offset;
+    std::memcpy(destination, &header, sizeof(header));
+    std::memcpy(destination + sizeof(header), &aCommand, sizeof(Command));
+    if (aDataSize > 0)
+    {
+        std::memcpy(destination + sizeof(header) + sizeof(Command), someData, aDataSize);
+    }
+    ++myCommandCount;
+}
+template <class Command>
+Command RenderCommandBuffer::Read(const unsigned char* aCommand)
+{
+    Command command;
+    std::memcpy(&command, aCommand, sizeof(Command));
+    return command;
+}
+template <class Visit>
+void RenderCommandBuffer::ForEachCommand(const Visit& aVisit) const
+{
+    for (size_t offset = 0; offset < myBytes.size();)
+    {
+        RenderCommandHeader header;
+        std::memcpy(&header, myBytes.data() + offset, sizeof(header));
+        aVisit(header.type, myBytes.data() + offset + sizeof(header));
+        offset += header.size;
+    }
+}
+template <class Context, class SetConstants>
+void RenderCommandBuffer::Replay(Context& aContext, const SetConstants& aSetConstants) const
+{
+    ForEachCommand([&](RenderCommandType aType, const unsigned char* aCommand)
+    {
+        switch (aType)
+        {
+        case RenderCommandType::SetTopology:
+            aContext.IASetPrimitiveTopology(Read<SetTopologyCommand>(aCommand).topology);
+            break;
+        case RenderCommandType::SetInputLayout:
+            aContext.IASetInputLayout(Read<SetInputLayoutCommand>(aCommand).inputLayout);
+            break;
+        case RenderCommandType::SetVertexShader:
+            aContext.VSSetShader(Read<SetVertexShaderCommand>(aCommand).shader, nullptr, 0);
+            break;
+        case RenderCommandType::SetPixelShader:
+            aContext.PSSetShader(Read<SetPixelShaderCommand>(aCommand).shader, nullptr, 0);
+            break;
+        case RenderCommandType::BindVertexBuffer:
+        {
+            const BindVertexBufferCommand command = Read<BindVertexBufferCommand>(aCommand);
+            aContext.IASetVertexBuffers(command.slot, 1, &command.buffer, &command.stride, &command.offset);
+            break;
+        }
+        case RenderCommandType::BindIndexBuffer:
+        {
+            const BindIndexBufferCommand command = Read<BindIndexBufferCommand>(aCommand);
+            aContext.IASetIndexBuffer(command.buffer, command.format, command.offset);
+            break;
+        }
+        case RenderCommandType::BindPixelShaderResource:
+        {
+            const BindPixelShaderResourceCommand command = Read<BindPixelShaderResourceCommand>(aCommand);
+            aContext.PSSetShaderResources(command.slot, 1, &command.view);
+            break;
+        }
+        case RenderCommandType::UpdateConstants:
+            aSetConstants(Read<UpdateConstantsCommand>(aCommand), aCommand + sizeof(UpdateConstantsCommand));
+            break;
+        case RenderCommandType::DrawIndexed:
+        {
+            const DrawIndexedCommand command = Read<DrawIndexedCommand>(aCommand);
+            aContext.DrawIndexed(command.indexCount, command.startIndex, command.baseVertex);
+            break;
+        }
+        }
+    });
+}
+template <class Visit>
+void RenderCommandBuffer::ForEachConstants(const Visit& aVisit) const
+{
+    ForEachCommand([&](RenderCommandType aType, const unsigned char* aCommand)
+    {
+        if (aType == RenderCommandType::UpdateConstants)
+        {
+            aVisit(Read<UpdateConstantsCommand>(aCommand), aCommand + sizeof(UpdateConstantsCommand));
+        }
+    });
+}
+
+template <class RecordJob>
+void ParallelRenderCommands::Record(WorkerPool& aPool, size_t anItemCount, size_t anItemsPerJob, const RecordJob& aRecord)
+{
+    myJobCount = (anItemCount + anItemsPerJob - 1) / anItemsPerJob;
+    if (myJobCommands.size() < myJobCount)
+    {
+        myJobCommands.resize(myJobCount);
+    }
+
+    // Fewer items than one job records on the calling thread
+    aPool.ParallelFor(0, static_cast<int>(myJobCount), [&](int aFirstJob, int aLastJob)
+    {
+        for (int job = aFirstJob; job < aLastJob; ++job)
+        {
+            RenderCommandBuffer& commands = myJobCommands[job];
+            commands.Clear();
+            const size_t first = job * anItemsPerJob;
+            aRecord(commands, first, std::min(first + anItemsPerJob, anItemCount));
+        }
+    });
+}
+template <class Context, class SetConstants>
+void ParallelRenderCommands::Replay(Context& aContext, const SetConstants& aSetConstants) const
+{
+    for (size_t job = 0; job < myJobCount; ++job)
+    {
+        myJobCommands[job].Replay(aContext, aSetConstants);
+    }
+}
+template <class Visit>
+void ParallelRenderCommands::ForEachConstants(const Visit& aVisit) const
+{
+    for (size_t job = 0; job < myJobCount; ++job)
+    {
+        myJobCommands[job].ForEachConstants(aVisit);
+    }
+}
@@ -0,0 +1,105 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t locIdMask = 0xFFF;
+    constexpr uint32_t locDepthMask = 0xFFFFFF;
+    constexpr int locPassShift = 60;
+
+    // Non-negative floats order like their bit patterns, the top 24 bits keep the exponent and 16 bits of mantissa
+    uint32_t QuantizeDepth(float aViewDepth)
+    {
+        const float depth = aViewDepth > 0.0f ? aViewDepth : 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits >> 7) & locDepthMask;
+    }
+}
+
+uint64_t MakeRenderSortKey(RenderPass aPass, uint32_t aProgramId, uint32_t aMaterialId, uint32_t aGeometryId, float aViewDepth)
+{
+    const uint64_t pass = static_cast<uint64_t>(aPass) << locPassShift;
+    const uint64_t state = (static_cast<uint64_t>(aProgramId & locIdMask) << 24) | (static_cast<uint64_t>(aMaterialId & locIdMask) << 12) |
+        (aGeometryId & locIdMask);
+    const uint64_t depth = QuantizeDepth(aViewDepth);
+    if (aPass == RenderPass::Blended)
+    {
+        return pass | ((locDepthMask - depth) << 36) | state;
+    }
+    return pass | (state << 24) | depth;
+}
+
+void RadixSortRenderItems(std::vector<RenderItem>& someItems, std::vector<RenderItem>& someBuffer)
+{
+    if (someItems.size() < 2)
+    {
+        return;
+    }
+
+    // All eight histograms in one pass over the keys
+    size_t counts[8][256] = {};
+    for (const RenderItem& item : someItems)
+    {
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            ++counts[byte][(item.key >> (byte * 8)) & 0xFF];
+        }
+    }
+
+    someBuffer.resize(someItems.size());
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        size_t* histogram = counts[byte];
+        const int shift = byte * 8;
+        if (histogram[(someItems[0].key >> shift) & 0xFF] == someItems.size())
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            const size_t count = histogram[digit];
+            histogram[digit] = offset;
+            offset += count;
+        }
+        for (const RenderItem& item : someItems)
+        {
+            someBuffer[histogram[(item.key >> shift) & 0xFF]++] = item;
+        }
+        someItems.swap(someBuffer);
+    }
+}
+
+template <class Key>
+uint32_t RenderQueue::GetId(std::map<Key, uint32_t>& someIds, const Key& aKey)
+{
+    return someIds.emplace(aKey, static_cast<uint32_t>(someIds.size())).first->second;
+}
+
+void RenderQueue::Clear()
+{
+    myItems.clear();
+}
+
+RenderStateIds RenderQueue::GetStateIds(const RenderState& aState)
+{
+    RenderStateIds ids;
+    ids.program = GetId(myProgramIds, std::make_tuple(aState.inputLayout, aState.vertexShader, aState.pixelShader));
+    ids.material = GetId(myMaterialIds, aState.texture);
+    ids.geometry = GetId(myGeometryIds, aState.geometry);
+    return ids;
+}
+
+void RenderQueue::Add(RenderPass aPass, const RenderStateIds& someIds, float aViewDepth, size_t anObjectIndex)
+{
+    myItems.push_back({ MakeRenderSortKey(aPass, someIds.program, someIds.material, someIds.geometry, aViewDepth), anObjectIndex });
+}
+
+void RenderQueue::Sort()
+{
+    RadixSortRenderItems(myItems, mySortBuffer);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Passes are the top bits of the key, every draw of a pass is submitted before the next pass starts
+enum class RenderPass : uint8_t
+{
+    Opaque = 0,
+    Blended = 1
+};
+
+// What an object takes part in, objects carry these so passes never have to look at their shaders
+enum PassMask : uint32_t
+{
+    PassMaskMain = 1 << 0,
+    PassMaskReflection = 1 << 1,    // Drawn into the planar reflection
+    PassMaskWater = 1 << 2,         // The water surface sampling the reflection
+    PassMaskDiffuseDebug = 1 << 3,  // Has a diffuse only view for render mode 1
+    PassMaskSpecularDebug = 1 << 4  // Has a specular only view for render mode -1
+};
+
+// Everything a draw binds, as opaque handles like InstanceKey. Two draws with equal fields need no rebinding in between
+struct RenderState
+{
+    const void* inputLayout = nullptr;
+    const void* vertexShader = nullptr;
+    const void* pixelShader = nullptr;
+    const void* texture = nullptr;
+    const void* geometry = nullptr; // Vertex and index buffer with their stride and format
+};
+
+// Small ids for a RenderState, looked up once when an object's state changes rather than every frame
+struct RenderStateIds
+{
+    uint32_t program = 0;   // Input layout, vertex and pixel shader
+    uint32_t material = 0;  // Texture
+    uint32_t geometry = 0;
+};
+
+struct RenderItem
+{
+    uint64_t key = 0;
+    size_t objectIndex = 0;
+};
+
+// Packs a draw into one sortable integer, from the most significant bits down:
+//   opaque:  pass:4 | program:12 | material:12 | geometry:12 | depth:24   state first, front to back within a state
+//   blended: pass:4 | inverted depth:24 | program:12 | material:12 | geometry:12   back to front, state only breaks ties
+// Ids past 12 bits wrap, which only costs state changes since submission compares the real state
+uint64_t MakeRenderSortKey(RenderPass aPass, uint32_t aProgramId, uint32_t aMaterialId, uint32_t aGeometryId, float aViewDepth);
+
+// Collects the frame's draws, sorts them by key and hands them back grouped by pass and state. Programs, materials
+// and meshes get small ids the first time GetStateIds sees them and keep them, so keys are stable from frame to frame.
+// Only looks at opaque handles, the GPU side binds RenderStates and draws the objects.
+class RenderQueue
+{
+public:
+    RenderStateIds GetStateIds(const RenderState& aState);
+
+    void Clear();
+    void Add(RenderPass aPass, const RenderStateIds& someIds, float aViewDepth, size_t anObjectIndex);
+    // LSD radix sort over the key bytes, bytes every key shares are skipped. Stable, equal keys keep submission order
+    void Sort();
+
+    bool IsEmpty() const { return myItems.empty(); }
+    const std::vector<RenderItem>& GetItems() const { return myItems; }
+    size_t GetProgramCount() const { return myProgramIds.size(); }
+    size_t GetMaterialCount() const { return myMaterialIds.size(); }
+
+private:
+    template <class Key>
+    static uint32_t GetId(std::map<Key, uint32_t>& someIds, const Key& aKey);
+
+    std::map<std::tuple<const void*, const void*, const void*>, uint32_t> myProgramIds;
+    std::map<const void*, uint32_t> myMaterialIds;
+    std::map<const void*, uint32_t> myGeometryIds;
+    std::vector<RenderItem> myItems;
+    std::vector<RenderItem> mySortBuffer;
+};
+
+// Sorts someItems by key in place, using someBuffer as scratch
+void RadixSortRenderItems(std::vector<RenderItem>& someItems, std::vector<RenderItem>& someBuffer);
@@ -1,58 +1,29 @@
 #include "Sphere.h"
-#include <directxmath.h>
+#include <iostream>
 
 #include "Engine.h"
 #include "GraphicsEngine.h"
 
 void Sphere::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
 {
-    const int latitudeSegments = 20;
-    const int longitudeSegments = 20;
-    const float radius = 1.0f;
+    myGeneratedLods = CreateSphereLodChain(mySettings.type, mySettings.lodCount, mySettings.radius, mySettings.targetEdgePixels, someVertices, someIndices);
 
-    for (int i = 0; i <= latitudeSegments; ++i)
+    std::cout << (mySettings.type == SphereType::Icosphere ? "Icosphere" : "Cube sphere") << " LODs:";
+    for (const MeshLod& lod : myGeneratedLods)
     {
-        float theta = i * DirectX::XM_PI / latitudeSegments;
-        float sinTheta = sinf(theta);
-        float cosTheta = cosf(theta);
-
-        for (int j = 0; j <= longitudeSegments; ++j)
-        {
-            float phi = j * 2.0f * DirectX::XM_PI / longitudeSegments;
-            float sinPhi = sinf(phi);
-            float cosPhi = cosf(phi);
-
-            DirectX::XMFLOAT3 position = {
-                radius * sinTheta * cosPhi,
-                radius * cosTheta,
-                radius * sinTheta * sinPhi
-            };
-
-            DirectX::XMFLOAT2 texcoord = {
-                static_cast<float>(j) / longitudeSegments,
-                static_cast<float>(i) / latitudeSegments
-            };
-
-            someVertices.push_back({ position.x, position.y, position.z, 1.0f, 1.0f, 1.0f, 1.0f, texcoord.x, texcoord.y });
-        }
-    }
-
-    for (int i = 0; i < latitudeSegments; ++i)
-    {
-        for (int j = 0; j < longitudeSegments; ++j)
-        {
-            int first = (i * (longitudeSegments + 1)) + j;
-            int second = first + longitudeSegments + 1;
-
-            someIndices.push_back(first);
-            someIndices.push_back(first + 1);
-            someIndices.push_back(second);
-
-            someIndices.push_back(second);
-            someIndices.push_back(first + 1);
-            someIndices.push_back(second + 1);
-        }
+        std::cout << " " << lod.indexCount / 3;
     }
+    std::cout << " triangles" << std::endl;
+}
+std::string Sphere::GetGeometryKey() const
+{
+    return std::string(mySettings.type == SphereType::Icosphere ? "Icosphere:" : "CubeSphere:") + std::to_string(mySettings.lodCount) + ":" +
+        std::to_string(mySettings.radius) + ":" + std::to_string(mySettings.targetEdgePixels);
+}
+const VertexFormatDesc& Sphere::GetVertexFormat() const
+{
+    // The generator's normals and tangents are rebuilt from position and uv.x in Sphere_VS, no need to upload them
+    return GetVertexFormatDesc<PositionTexCoordVertexFormat>();
 }
 bool Sphere::InitObjectResources()
 {
@@ -60,6 +31,7 @@ bool Sphere::InitObjectResources()
 
     SetVertexShaderPath("Sphere_VS.cso");
     SetPixelShaderPath("Sphere_PS.cso");
+    SetInstancedVertexShaderPath("Sphere_Instanced_VS.cso");
 
     if (!textureManager.LoadTexture("Sphere", "sphere.jpg"))
     {
@@ -1,15 +1,30 @@
 #pragma once
 #include <directxmath.h>
 #include "Object3D.h"
+#include "SphereMesh.h"
 #include "Vertex.h"
 #include <d3d11.h>
 
+struct SphereSettings
+{
+	SphereType type = SphereType::Icosphere;
+	int lodCount = 5; // Icosphere levels go from 5120 triangles down to the bare 20 sided icosahedron
+	float radius = 1.0f;
+	float targetEdgePixels = 12.0f; // A coarser level takes over once its edges are shorter than this on screen
+};
+
 class Sphere : public Object3D
 {
 public:
 	Sphere() = default;
+	explicit Sphere(const SphereSettings& someSettings) : mySettings(someSettings) {}
 	~Sphere() = default;
 
 	void CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices) override;
 	bool InitObjectResources() override;
+	std::string GetGeometryKey() const override;
+	const VertexFormatDesc& GetVertexFormat() const override;
+
+private:
+	SphereSettings mySettings;
 };
@@ -0,0 +1,309 @@
+#include "SphereMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "Includes/MeehanVector3.hpp"
+
+namespace
+{
+    constexpr float locPi = 3.14159265358979323846f;
+
+    using Vector3 = CommonUtilities::Vector3<float>;
+
+    void CreateIcosahedron(int aSubdivisions, std::vector<Vector3>& somePositions, std::vector<UINT>& someTriangles)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+        somePositions = {
+            { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f }
+        };
+        for (Vector3& position : somePositions)
+        {
+            position = position.GetNormalized(); // Normalize() drops z when y is 0
+        }
+        someTriangles = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+        };
+
+        for (int level = 0; level < aSubdivisions; ++level)
+        {
+            // Every edge is split once, shared edges through the midpoint cache
+            std::map<std::pair<UINT, UINT>, UINT> midpoints;
+            auto getMidpoint = [&](UINT aFirst, UINT aSecond)
+            {
+                const std::pair<UINT, UINT> edge(std::min(aFirst, aSecond), std::max(aFirst, aSecond));
+                auto it = midpoints.find(edge);
+                if (it != midpoints.end())
+                {
+                    return it->second;
+                }
+                const UINT index = static_cast<UINT>(somePositions.size());
+                somePositions.push_back((somePositions[aFirst] + somePositions[aSecond]).GetNormalized());
+                midpoints[edge] = index;
+                return index;
+            };
+
+            std::vector<UINT> triangles;
+            triangles.reserve(someTriangles.size() * 4);
+            for (size_t i = 0; i < someTriangles.size(); i += 3)
+            {
+                const UINT a = someTriangles[i];
+                const UINT b = someTriangles[i + 1];
+                const UINT c = someTriangles[i + 2];
+                const UINT ab = getMidpoint(a, b);
+                const UINT bc = getMidpoint(b, c);
+                const UINT ca = getMidpoint(c, a);
+                triangles.insert(triangles.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            someTriangles.swap(triangles);
+        }
+    }
+
+    // Cube point to sphere with the mapping that spreads area evenly, instead of just normalizing
+    Vector3 SpherifyCubePoint(const Vector3& aPoint)
+    {
+        const float x2 = aPoint.x * aPoint.x;
+        const float y2 = aPoint.y * aPoint.y;
+        const float z2 = aPoint.z * aPoint.z;
+        return Vector3(
+            aPoint.x * std::sqrt(1.0f - y2 * 0.5f - z2 * 0.5f + y2 * z2 / 3.0f),
+            aPoint.y * std::sqrt(1.0f - z2 * 0.5f - x2 * 0.5f + z2 * x2 / 3.0f),
+            aPoint.z * std::sqrt(1.0f - x2 * 0.5f - y2 * 0.5f + x2 * y2 / 3.0f));
+    }
+
+    void CreateCubeSphere(int aSegments, std::vector<Vector3>& somePositions, std::vector<UINT>& someTriangles)
+    {
+        const Vector3 faces[6][3] = {
+            { { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+            { { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f } },
+            { { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+            { { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+            { { 0.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+            { { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } }
+        };
+
+        // Face borders are welded so neighbouring faces share their edge vertices
+        std::map<std::tuple<long, long, long>, UINT> welded;
+        auto addPosition = [&](const Vector3& aCubePoint)
+        {
+            const std::tuple<long, long, long> key(std::lround(aCubePoint.x * 65536.0f), std::lround(aCubePoint.y * 65536.0f), std::lround(aCubePoint.z * 65536.0f));
+            auto it = welded.find(key);
+            if (it != welded.end())
+            {
+                return it->second;
+            }
+            const UINT index = static_cast<UINT>(somePositions.size());
+            somePositions.push_back(SpherifyCubePoint(aCubePoint));
+            welded[key] = index;
+            return index;
+        };
+
+        std::vector<UINT> grid(static_cast<size_t>(aSegments + 1) * (aSegments + 1));
+        for (const auto& face : faces)
+        {
+            for (int j = 0; j <= aSegments; ++j)
+            {
+                for (int i = 0; i <= aSegments; ++i)
+                {
+                    const float s = 2.0f * static_cast<float>(i) / static_cast<float>(aSegments) - 1.0f;
+                    const float t = 2.0f * static_cast<float>(j) / static_cast<float>(aSegments) - 1.0f;
+                    grid[j * (aSegments + 1) + i] = addPosition(face[0] + face[1] * s + face[2] * t);
+                }
+            }
+            for (int j = 0; j < aSegments; ++j)
+            {
+                for (int i = 0; i < aSegments; ++i)
+                {
+                    const UINT corner00 = grid[j * (aSegments + 1) + i];
+                    const UINT corner10 = grid[j * (aSegments + 1) + i + 1];
+                    const UINT corner01 = grid[(j + 1) * (aSegments + 1) + i];
+                    const UINT corner11 = grid[(j + 1) * (aSegments + 1) + i + 1];
+                    someTriangles.insert(someTriangles.end(), { corner00, corner10, corner11, corner00, corner11, corner01 });
+                }
+            }
+        }
+    }
+
+    float ComputeU(const Vector3& aDirection)
+    {
+        const float u = std::atan2(aDirection.z, aDirection.x) / (2.0f * locPi);
+        return u < 0.0f ? u + 1.0f : u;
+    }
+
+    bool IsPole(const Vector3& aDirection)
+    {
+        return aDirection.x * aDirection.x + aDirection.z * aDirection.z < 1e-10f;
+    }
+
+    // Turns unit positions and triangles into engine vertices, splitting vertices where the uvs wrap
+    void EmitSphere(const std::vector<Vector3>& somePositions, const std::vector<UINT>& someTriangles, float aRadius,
+        std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+    {
+        const UINT firstVertex = static_cast<UINT>(someVertices.size());
+        std::unordered_map<unsigned long long, UINT> emitted;
+        auto emit = [&](UINT aPosition, float aU)
+        {
+            unsigned int uBits;
+            std::memcpy(&uBits, &aU, sizeof(uBits));
+            const unsigned long long key = (static_cast<unsigned long long>(aPosition) << 32) | uBits;
+            auto it = emitted.find(key);
+            if (it != emitted.end())
+            {
+                return it->second;
+            }
+
+            const Vector3& normal = somePositions[aPosition];
+            const float v = std::acos(std::clamp(normal.y, -1.0f, 1.0f)) / locPi;
+            const float longitude = aU * 2.0f * locPi;
+            const Vector3 tangent(-std::sin(longitude), 0.0f, std::cos(longitude));
+            const Vector3 bitangent = normal.Cross(tangent);
+
+            Vertex vertex = {};
+            vertex.x = normal.x * aRadius; vertex.y = normal.y * aRadius; vertex.z = normal.z * aRadius; vertex.w = 1.0f;
+            vertex.r = 1.0f; vertex.g = 1.0f; vertex.b = 1.0f; vertex.a = 1.0f;
+            vertex.u = aU; vertex.v = v;
+            vertex.nx = normal.x; vertex.ny = normal.y; vertex.nz = normal.z;
+            vertex.tx = tangent.x; vertex.ty = tangent.y; vertex.tz = tangent.z;
+            vertex.bx = bitangent.x; vertex.by = bitangent.y; vertex.bz = bitangent.z;
+
+            const UINT index = static_cast<UINT>(someVertices.size()) - firstVertex;
+            someVertices.push_back(vertex);
+            emitted[key] = index;
+            return index;
+        };
+
+        for (size_t i = 0; i < someTriangles.size(); i += 3)
+        {
+            UINT corners[3] = { someTriangles[i], someTriangles[i + 1], someTriangles[i + 2] };
+
+            // Wound like the rest of the engine's meshes, cross(b - a, c - a) points into the surface
+            const Vector3 faceNormal = (somePositions[corners[1]] - somePositions[corners[0]]).Cross(somePositions[corners[2]] - somePositions[corners[0]]);
+            if (faceNormal.Dot(somePositions[corners[0]] + somePositions[corners[1]] + somePositions[corners[2]]) > 0.0f)
+            {
+                std::swap(corners[1], corners[2]);
+            }
+
+            float u[3];
+            bool isPole[3];
+            float minU = 1.0f, maxU = 0.0f;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                isPole[corner] = IsPole(somePositions[corners[corner]]);
+                u[corner] = ComputeU(somePositions[corners[corner]]);
+                if (!isPole[corner])
+                {
+                    minU = std::min(minU, u[corner]);
+                    maxU = std::max(maxU, u[corner]);
+                }
+            }
+
+            // Triangles straddling u = 0 get the low side moved past 1, the sampler wraps it back
+            if (maxU - minU > 0.5f)
+            {
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    if (!isPole[corner] && u[corner] < 0.5f)
+                    {
+                        u[corner] += 1.0f;
+                    }
+                }
+            }
+
+            // A pole has no longitude of its own, give it the one of the triangle it belongs to
+            float sum = 0.0f;
+            int count = 0;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                if (!isPole[corner])
+                {
+                    sum += u[corner];
+                    ++count;
+                }
+            }
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                if (isPole[corner] && count > 0)
+                {
+                    u[corner] = sum / static_cast<float>(count);
+                }
+            }
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                someIndices.push_back(emit(corners[corner], u[corner]));
+            }
+        }
+    }
+
+    float ComputeAverageEdgeLength(const std::vector<Vector3>& somePositions, const std::vector<UINT>& someTriangles)
+    {
+        float total = 0.0f;
+        for (size_t i = 0; i < someTriangles.size(); i += 3)
+        {
+            const Vector3& a = somePositions[someTriangles[i]];
+            const Vector3& b = somePositions[someTriangles[i + 1]];
+            const Vector3& c = somePositions[someTriangles[i + 2]];
+            total += (b - a).Length() + (c - b).Length() + (a - c).Length();
+        }
+        return someTriangles.empty() ? 0.0f : total / static_cast<float>(someTriangles.size());
+    }
+
+    void CreateUnitSphere(SphereType aType, int aSubdivisions, std::vector<Vector3>& somePositions, std::vector<UINT>& someTriangles)
+    {
+        if (aType == SphereType::Icosphere)
+        {
+            CreateIcosahedron(aSubdivisions, somePositions, someTriangles);
+        }
+        else
+        {
+            // 12 * n^2 triangles, n picked to land closest to the icosphere's 20 * 4^subdivisions
+            const int segments = std::max(1, static_cast<int>(std::lround(std::sqrt(5.0f / 3.0f) * std::ldexp(1.0f, aSubdivisions))));
+            CreateCubeSphere(segments, somePositions, someTriangles);
+        }
+    }
+}
+
+void CreateSphereMesh(SphereType aType, int aSubdivisions, float aRadius, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    std::vector<Vector3> positions;
+    std::vector<UINT> triangles;
+    CreateUnitSphere(aType, aSubdivisions, positions, triangles);
+    EmitSphere(positions, triangles, aRadius, someVertices, someIndices);
+}
+
+std::vector<MeshLod> CreateSphereLodChain(SphereType aType, int aLevelCount, float aRadius, float aTargetEdgePixels,
+    std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    std::vector<MeshLod> lods;
+    for (int level = 0; level < aLevelCount; ++level)
+    {
+        std::vector<Vector3> positions;
+        std::vector<UINT> triangles;
+        CreateUnitSphere(aType, aLevelCount - 1 - level, positions, triangles);
+
+        MeshLod lod;
+        lod.startIndex = static_cast<UINT>(someIndices.size());
+        lod.baseVertex = static_cast<int>(someVertices.size());
+        EmitSphere(positions, triangles, aRadius, someVertices, someIndices);
+        lod.indexCount = static_cast<UINT>(someIndices.size()) - lod.startIndex;
+        lod.vertexCount = static_cast<UINT>(someVertices.size()) - lod.baseVertex;
+
+        // Edge length on the unit sphere relative to the diameter, the finest level covers everything above
+        if (level > 0)
+        {
+            lod.maxScreenSize = aTargetEdgePixels * 2.0f / ComputeAverageEdgeLength(positions, triangles);
+        }
+        lods.push_back(lod);
+    }
+    return lods;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+
+#include "MeshLod.h"
+#include "Vertex.h"
+
+typedef unsigned int UINT;
+
+enum class SphereType
+{
+    Icosphere,  // Subdivided icosahedron, near uniform triangles
+    CubeSphere  // Spherified cube, quads that line up with the texture axes
+};
+
+// Appends one sphere with normals, tangents and equirectangular uvs. Seam and pole vertices are split so the
+// texture doesn't smear. Indices are relative to the first appended vertex.
+// Icosphere: 20 * 4^aSubdivisions triangles. CubeSphere: about the same count, from quads on a spherified cube.
+void CreateSphereMesh(SphereType aType, int aSubdivisions, float aRadius, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
+
+// Levels 0..aLevelCount-1 back to back, finest first, each with its own vertices. maxScreenSize is where the
+// level's edges stay around aTargetEdgePixels long on screen.
+std::vector<MeshLod> CreateSphereLodChain(SphereType aType, int aLevelCount, float aRadius, float aTargetEdgePixels,
+    std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices);
@@ -0,0 +1,66 @@
+cbuffer FrameBuffer : register(b0)
+{
+    float4x4 worldToClipMatrix;
+    float time;
+    float padding1;
+    float padding2;
+    float padding3;
+}
+
+#define PI 3.14159265358979323846f
+
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float2 uv : TEXCOORD0;
+    float4 instanceRow0 : INSTANCE_TRANSFORM0; // Rows of the CPU side world matrix, one draw covers every instance
+    float4 instanceRow1 : INSTANCE_TRANSFORM1;
+    float4 instanceRow2 : INSTANCE_TRANSFORM2;
+    float4 instanceRow3 : INSTANCE_TRANSFORM3;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 worldPosition : POSITION;
+    float4 color : COLOR;
+    float2 uv : TEXCOORD0;
+    float3 normal : NORMAL;
+    float3 tangent : TANGENT;
+    float3 bitangent : BITANGENT;
+};
+
+PixelInputType main(VertexInputType input)
+{
+    PixelInputType output;
+
+    // Built from rows, so it multiplies from the right where the transposed cbuffer matrix multiplies from the left
+    float4x4 instanceToWorld = float4x4(input.instanceRow0, input.instanceRow1, input.instanceRow2, input.instanceRow3);
+
+    // Transform position
+    float4 vertexObjectPos = input.position;
+    float4 vertexWorldPos = mul(vertexObjectPos, instanceToWorld);
+    float4 vertexClipPos = mul(worldToClipMatrix, vertexWorldPos);
+
+    // The sphere is centred on its origin, so its frame follows from the position and the longitude in uv.x
+    float3 objectNormal = normalize(vertexObjectPos.xyz);
+    float longitude = input.uv.x * 2.0f * PI;
+    float3 objectTangent = float3(-sin(longitude), 0.0f, cos(longitude));
+    float3 objectBitangent = cross(objectNormal, objectTangent);
+
+    // Transform normal, tangent, and bitangent to world space
+    float3 normalWorld = mul(objectNormal, (float3x3) instanceToWorld);
+    float3 tangentWorld = mul(objectTangent, (float3x3) instanceToWorld);
+    float3 bitangentWorld = mul(objectBitangent, (float3x3) instanceToWorld);
+
+    // Pass data to the pixel shader
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    output.uv = input.uv;
+    output.normal = normalize(normalWorld); // Normalize the normal vector
+    output.tangent = normalize(tangentWorld); // Normalize the tangent vector
+    output.bitangent = normalize(bitangentWorld); // Normalize the bitangent vector
+
+    return output;
+}
\ No newline at end of file
@@ -12,14 +12,12 @@ cbuffer ObjectBuffer : register(b1)
     float4x4 modelToWorld;
 }
 
+#define PI 3.14159265358979323846f
+
 struct VertexInputType
 {
     float4 position : POSITION;
-    float4 color : COLOR;
     float2 uv : TEXCOORD0;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
-    float3 bitangent : BITANGENT;
 };
 
 struct PixelInputType
@@ -42,15 +40,21 @@ PixelInputType main(VertexInputType input)
     float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
     float4 vertexClipPos = mul(worldToClipMatrix, vertexWorldPos);
 
+    // The sphere is centred on its origin, so its frame follows from the position and the longitude in uv.x
+    float3 objectNormal = normalize(vertexObjectPos.xyz);
+    float longitude = input.uv.x * 2.0f * PI;
+    float3 objectTangent = float3(-sin(longitude), 0.0f, cos(longitude));
+    float3 objectBitangent = cross(objectNormal, objectTangent);
+
     // Transform normal, tangent, and bitangent to world space
-    float3 normalWorld = mul((float3x3) modelToWorld, input.normal);
-    float3 tangentWorld = mul((float3x3) modelToWorld, input.tangent);
-    float3 bitangentWorld = mul((float3x3) modelToWorld, input.bitangent);
+    float3 normalWorld = mul((float3x3) modelToWorld, objectNormal);
+    float3 tangentWorld = mul((float3x3) modelToWorld, objectTangent);
+    float3 bitangentWorld = mul((float3x3) modelToWorld, objectBitangent);
 
     // Pass data to the pixel shader
     output.position = vertexClipPos;
     output.worldPosition = vertexWorldPos;
-    output.color = input.color;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
     output.uv = input.uv;
     output.normal = normalize(normalWorld); // Normalize the normal vector
     output.tangent = normalize(tangentWorld); // Normalize the tangent vector
@@ -0,0 +1,294 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+
+#include "D3D11Types.h"
+
+// Slots past these are passed through without filtering, the engine binds far fewer
+constexpr UINT locFilteredVertexBufferSlots = 4;
+constexpr UINT locFilteredConstantBufferSlots = 14;
+constexpr UINT locFilteredShaderResourceSlots = 32;
+constexpr UINT locFilteredSamplerSlots = 16;
+
+struct StateFilterStats
+{
+    unsigned int issuedCalls = 0;   // State calls that reached the context
+    unsigned int filteredCalls = 0; // State calls dropped because they would set what is already bound
+};
+
+// Sits in front of a device context and drops state calls that would rebind what is already bound. Calls keep
+// their D3D11 names so render code reads the same, anything that isn't filtered goes through Get(). Multi-slot
+// calls are trimmed to the slots that change. Context only needs the ID3D11DeviceContext calls used here, so a
+// recording stand-in can check the filtering without a device.
+// Everything starts out unknown. Call Invalidate() after touching state on the context directly (ClearState,
+// deferred contexts, other libraries).
+template <class Context>
+class StateFilteringContext
+{
+public:
+    void SetContext(Context* aContext) { myContext = aContext; Invalidate(); }
+    Context* Get() const { return myContext; }
+
+    void Invalidate() { myState = BoundState(); }
+    const StateFilterStats& GetStats() const { return myStats; }
+    void ResetStats() { myStats = StateFilterStats(); }
+
+    void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY aTopology)
+    {
+        if (Update(myState.topology, aTopology))
+        {
+            myContext->IASetPrimitiveTopology(aTopology);
+        }
+    }
+    void IASetInputLayout(ID3D11InputLayout* anInputLayout)
+    {
+        if (Update(myState.inputLayout, anInputLayout))
+        {
+            myContext->IASetInputLayout(anInputLayout);
+        }
+    }
+    void IASetVertexBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers, const UINT* someStrides, const UINT* someOffsets)
+    {
+        UINT first;
+        UINT last;
+        auto binding = [&](UINT i) { return VertexBufferBinding{ someBuffers[i], someStrides[i], someOffsets[i] }; };
+        if (!TrimToChanges(myState.vertexBuffers, aStartSlot, aCount, binding, first, last))
+        {
+            return;
+        }
+        myContext->IASetVertexBuffers(aStartSlot + first, last - first, someBuffers + first, someStrides + first, someOffsets + first);
+    }
+    void IASetIndexBuffer(ID3D11Buffer* aBuffer, DXGI_FORMAT aFormat, UINT anOffset)
+    {
+        if (Update(myState.indexBuffer, IndexBufferBinding{ aBuffer, aFormat, anOffset }))
+        {
+            myContext->IASetIndexBuffer(aBuffer, aFormat, anOffset);
+        }
+    }
+
+    void VSSetShader(ID3D11VertexShader* aShader, ID3D11ClassInstance* const* someClassInstances, UINT aClassInstanceCount)
+    {
+        // Class linkage isn't tracked, those calls always go through
+        if (aClassInstanceCount == 0 ? Update(myState.vertexShader, aShader) : Forget(myState.vertexShader))
+        {
+            myContext->VSSetShader(aShader, someClassInstances, aClassInstanceCount);
+        }
+    }
+    void PSSetShader(ID3D11PixelShader* aShader, ID3D11ClassInstance* const* someClassInstances, UINT aClassInstanceCount)
+    {
+        if (aClassInstanceCount == 0 ? Update(myState.pixelShader, aShader) : Forget(myState.pixelShader))
+        {
+            myContext->PSSetShader(aShader, someClassInstances, aClassInstanceCount);
+        }
+    }
+
+    void VSSetConstantBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers)
+    {
+        SetSlots(myState.vsConstantBuffers, aStartSlot, aCount, someBuffers,
+            [this](UINT aSlot, UINT aSlotCount, ID3D11Buffer* const* someChanged) { myContext->VSSetConstantBuffers(aSlot, aSlotCount, someChanged); });
+    }
+    void PSSetConstantBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers)
+    {
+        SetSlots(myState.psConstantBuffers, aStartSlot, aCount, someBuffers,
+            [this](UINT aSlot, UINT aSlotCount, ID3D11Buffer* const* someChanged) { myContext->PSSetConstantBuffers(aSlot, aSlotCount, someChanged); });
+    }
+    // For constant buffers bound around the filter, e.g. at an offset with VSSetConstantBuffers1
+    void ForgetConstantBuffers(UINT aStartSlot, UINT aCount)
+    {
+        for (UINT slot = aStartSlot; slot < std::min(aStartSlot + aCount, locFilteredConstantBufferSlots); ++slot)
+        {
+            myState.vsConstantBuffers[slot].isKnown = false;
+            myState.psConstantBuffers[slot].isKnown = false;
+        }
+        ++myStats.issuedCalls;
+    }
+    void PSSetShaderResources(UINT aStartSlot, UINT aCount, ID3D11ShaderResourceView* const* someViews)
+    {
+        SetSlots(myState.psShaderResources, aStartSlot, aCount, someViews,
+            [this](UINT aSlot, UINT aSlotCount, ID3D11ShaderResourceView* const* someChanged) { myContext->PSSetShaderResources(aSlot, aSlotCount, someChanged); });
+    }
+    void PSSetSamplers(UINT aStartSlot, UINT aCount, ID3D11SamplerState* const* someSamplers)
+    {
+        SetSlots(myState.psSamplers, aStartSlot, aCount, someSamplers,
+            [this](UINT aSlot, UINT aSlotCount, ID3D11SamplerState* const* someChanged) { myContext->PSSetSamplers(aSlot, aSlotCount, someChanged); });
+    }
+
+    void RSSetState(ID3D11RasterizerState* aState)
+    {
+        if (Update(myState.rasterizerState, aState))
+        {
+            myContext->RSSetState(aState);
+        }
+    }
+    void OMSetBlendState(ID3D11BlendState* aState, const FLOAT aBlendFactor[4], UINT aSampleMask)
+    {
+        // A null factor means all ones
+        BlendBinding binding = { aState, { 1.0f, 1.0f, 1.0f, 1.0f }, aSampleMask };
+        if (aBlendFactor)
+        {
+            std::copy(aBlendFactor, aBlendFactor + 4, binding.factor);
+        }
+        if (Update(myState.blendState, binding))
+        {
+            myContext->OMSetBlendState(aState, aBlendFactor, aSampleMask);
+        }
+    }
+    void OMSetDepthStencilState(ID3D11DepthStencilState* aState, UINT aStencilRef)
+    {
+        if (Update(myState.depthStencilState, DepthStencilBinding{ aState, aStencilRef }))
+        {
+            myContext->OMSetDepthStencilState(aState, aStencilRef);
+        }
+    }
+    void OMSetRenderTargets(UINT aCount, ID3D11RenderTargetView* const* someViews, ID3D11DepthStencilView* aDepthView)
+    {
+        // The runtime unbinds shader resources that alias a new target without telling us, so forget them all
+        ++myStats.issuedCalls;
+        std::fill(std::begin(myState.psShaderResources), std::end(myState.psShaderResources), Slot<ID3D11ShaderResourceView*>());
+        myContext->OMSetRenderTargets(aCount, someViews, aDepthView);
+    }
+
+    void DrawIndexed(UINT anIndexCount, UINT aStartIndex, INT aBaseVertex)
+    {
+        myContext->DrawIndexed(anIndexCount, aStartIndex, aBaseVertex);
+    }
+    void DrawIndexedInstanced(UINT anIndexCount, UINT anInstanceCount, UINT aStartIndex, INT aBaseVertex, UINT aStartInstance)
+    {
+        myContext->DrawIndexedInstanced(anIndexCount, anInstanceCount, aStartIndex, aBaseVertex, aStartInstance);
+    }
+
+private:
+    template <class T>
+    struct Slot
+    {
+        T value = {};
+        bool isKnown = false;
+    };
+    struct VertexBufferBinding
+    {
+        ID3D11Buffer* buffer;
+        UINT stride;
+        UINT offset;
+        bool operator==(const VertexBufferBinding& anOther) const { return buffer == anOther.buffer && stride == anOther.stride && offset == anOther.offset; }
+    };
+    struct IndexBufferBinding
+    {
+        ID3D11Buffer* buffer;
+        DXGI_FORMAT format;
+        UINT offset;
+        bool operator==(const IndexBufferBinding& anOther) const { return buffer == anOther.buffer && format == anOther.format && offset == anOther.offset; }
+    };
+    struct BlendBinding
+    {
+        ID3D11BlendState* state;
+        FLOAT factor[4];
+        UINT sampleMask;
+        bool operator==(const BlendBinding& anOther) const
+        {
+            return state == anOther.state && std::equal(factor, factor + 4, anOther.factor) && sampleMask == anOther.sampleMask;
+        }
+    };
+    struct DepthStencilBinding
+    {
+        ID3D11DepthStencilState* state;
+        UINT stencilRef;
+        bool operator==(const DepthStencilBinding& anOther) const { return state == anOther.state && stencilRef == anOther.stencilRef; }
+    };
+    struct BoundState
+    {
+        Slot<D3D11_PRIMITIVE_TOPOLOGY> topology;
+        Slot<ID3D11InputLayout*> inputLayout;
+        Slot<VertexBufferBinding> vertexBuffers[locFilteredVertexBufferSlots];
+        Slot<IndexBufferBinding> indexBuffer;
+        Slot<ID3D11VertexShader*> vertexShader;
+        Slot<ID3D11PixelShader*> pixelShader;
+        Slot<ID3D11Buffer*> vsConstantBuffers[locFilteredConstantBufferSlots];
+        Slot<ID3D11Buffer*> psConstantBuffers[locFilteredConstantBufferSlots];
+        Slot<ID3D11ShaderResourceView*> psShaderResources[locFilteredShaderResourceSlots];
+        Slot<ID3D11SamplerState*> psSamplers[locFilteredSamplerSlots];
+        Slot<ID3D11RasterizerState*> rasterizerState;
+        Slot<BlendBinding> blendState;
+        Slot<DepthStencilBinding> depthStencilState;
+    };
+
+    // Records aValue and counts the call, false when it was bound already and the call can be dropped
+    template <class T>
+    bool Update(Slot<T>& aSlot, const T& aValue)
+    {
+        if (aSlot.isKnown && aSlot.value == aValue)
+        {
+            ++myStats.filteredCalls;
+            return false;
+        }
+        aSlot.value = aValue;
+        aSlot.isKnown = true;
+        ++myStats.issuedCalls;
+        return true;
+    }
+
+    template <class T>
+    bool Forget(Slot<T>& aSlot)
+    {
+        aSlot.isKnown = false;
+        ++myStats.issuedCalls;
+        return true;
+    }
+
+    // Narrows the call's [aFirst, aLast) to the slots whose binding changes and records them, false when none does.
+    // aBinding(i) is the value for slot aStartSlot + i
+    template <class T, size_t aSlotCount, class Binding>
+    bool TrimToChanges(Slot<T> (&someBound)[aSlotCount], UINT aStartSlot, UINT aCount, const Binding& aBinding, UINT& aFirst, UINT& aLast)
+    {
+        if (aStartSlot + aCount > aSlotCount)
+        {
+            // Reaches untracked slots, goes through whole and the tracked slots it overlaps become unknown
+            for (UINT slot = aStartSlot; slot < aSlotCount; ++slot)
+            {
+                someBound[slot].isKnown = false;
+            }
+            aFirst = 0;
+            aLast = aCount;
+            ++myStats.issuedCalls;
+            return true;
+        }
+
+        aFirst = aCount;
+        aLast = 0;
+        for (UINT i = 0; i < aCount; ++i)
+        {
+            Slot<T>& bound = someBound[aStartSlot + i];
+            const T value = aBinding(i);
+            if (!bound.isKnown || !(bound.value == value))
+            {
+                aFirst = std::min(aFirst, i);
+                aLast = i + 1;
+                bound.value = value;
+                bound.isKnown = true;
+            }
+        }
+        if (aFirst >= aLast)
+        {
+            ++myStats.filteredCalls;
+            return false;
+        }
+        ++myStats.issuedCalls;
+        return true;
+    }
+
+    template <class T, size_t aSlotCount, class Set>
+    void SetSlots(Slot<T> (&someBound)[aSlotCount], UINT aStartSlot, UINT aCount, T const* someValues, const Set& aSet)
+    {
+        UINT first;
+        UINT last;
+        if (TrimToChanges(someBound, aStartSlot, aCount, [someValues](UINT i) { return someValues[i]; }, first, last))
+        {
+            aSet(aStartSlot + first, last - first, someValues + first);
+        }
+    }
+
+    Context* myContext = nullptr;
+    BoundState myState;
+    StateFilterStats myStats;
+};
+
+using RenderContext = StateFilteringContext<ID3D11DeviceContext>;
@@ -0,0 +1,121 @@
+#include "StaticMesh.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "Engine.h"
+#include "GraphicsEngine.h"
+#include "MeshImporter.h"
+#include "MeshSimplifier.h"
+
+namespace
+{
+    constexpr int locImportedLodCount = 4;
+
+    struct FileVertexShader
+    {
+        const VertexFormatDesc& format;
+        const char* path;
+    };
+
+    // Converted files choose their layout, one vertex shader per layout the mesh converter writes
+    const FileVertexShader* FindFileVertexShader(const VertexFormatDesc& aFormat)
+    {
+        static const FileVertexShader shaders[] =
+        {
+            { GetVertexFormatDesc<StandardVertexFormat>(), "Mesh_VS.cso" },
+            { GetVertexFormatDesc<CompressedVertexFormat>(), "Mesh_Compressed_VS.cso" },
+            { GetVertexFormatDesc<PositionTexCoordVertexFormat>(), "Mesh_PositionTexCoord_VS.cso" }
+        };
+
+        for (const FileVertexShader& shader : shaders)
+        {
+            bool matches = shader.format.elementCount == aFormat.elementCount && shader.format.stride == aFormat.stride;
+            for (UINT i = 0; matches && i < aFormat.elementCount; ++i)
+            {
+                const D3D11_INPUT_ELEMENT_DESC& expected = shader.format.elements[i];
+                const D3D11_INPUT_ELEMENT_DESC& element = aFormat.elements[i];
+                matches = std::strcmp(expected.SemanticName, element.SemanticName) == 0 && expected.SemanticIndex == element.SemanticIndex &&
+                    expected.Format == element.Format && expected.AlignedByteOffset == element.AlignedByteOffset;
+            }
+            if (matches)
+            {
+                return &shader;
+            }
+        }
+        return nullptr;
+    }
+}
+
+StaticMesh::StaticMesh(const std::string& aMeshPath, const std::string& aTextureName)
+    : myMeshPath(aMeshPath), myTextureName(aTextureName)
+{
+}
+bool StaticMesh::Initialize(ID3D11Device* aDevice)
+{
+    if (IsImportableMesh(myMeshPath))
+    {
+        return Object3D::Initialize(aDevice);
+    }
+
+    if (!InitObjectResources())
+    {
+        return false;
+    }
+
+    // Files are optimized by the converter, the registry maps them and uploads as they are
+    GeometryRegistry& registry = Engine::GetInstance().GetGraphicsEngine().GetGeometryRegistry();
+    if (!UseSharedGeometry(registry.AcquireFile(myMeshPath)))
+    {
+        std::cerr << "Failed to load static mesh: " << myMeshPath << std::endl;
+        return false;
+    }
+
+    const FileVertexShader* vertexShader = FindFileVertexShader(myGeometry->vertexFormat);
+    if (!vertexShader)
+    {
+        std::cerr << "No vertex shader reads the vertex layout of mesh file: " << myMeshPath << std::endl;
+        return false;
+    }
+    SetVertexShaderPath(vertexShader->path);
+    return LoadShadersAndCreateInputLayout(aDevice);
+}
+bool StaticMesh::InitObjectResources()
+{
+    // Imported sources are uploaded compressed, files are switched over once their layout is known
+    SetVertexShaderPath("Mesh_Compressed_VS.cso");
+    SetPixelShaderPath("Mesh_PS.cso");
+
+    TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
+    SetTexture(textureManager.GetTexture(myTextureName));
+    return true;
+}
+const VertexFormatDesc& StaticMesh::GetVertexFormat() const
+{
+    return myGeometry ? myGeometry->vertexFormat : GetVertexFormatDesc<CompressedVertexFormat>();
+}
+void StaticMesh::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    MeshImportStats stats;
+    if (!ImportMesh(myMeshPath, someVertices, someIndices, &stats))
+    {
+        return;
+    }
+    std::cout << "Imported " << myMeshPath << ": " << stats.triangleCount << " triangles, " << stats.vertexCount << " vertices in "
+        << stats.totalMilliseconds << " ms (" << stats.readMilliseconds << " ms reading)" << std::endl;
+
+    // Authored meshes come with one level, the coarser ones share its vertices
+    MeshSimplifySettings settings;
+    settings.levelCount = locImportedLodCount;
+    myGeneratedLods = SimplifyMeshLods(someVertices, someIndices, settings);
+    std::cout << "Simplified " << myMeshPath << " into " << myGeneratedLods.size() << " levels:";
+    for (const MeshLod& lod : myGeneratedLods)
+    {
+        std::cout << " " << lod.indexCount / 3;
+    }
+    std::cout << " triangles" << std::endl;
+}
+std::string StaticMesh::GetGeometryKey() const
+{
+    return "Import:" + myMeshPath;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+#include "Object3D.h"
+
+// Authored geometry instead of generated. Converted mesh files (MeshFile.h, Tools/MeshConverter) are uploaded
+// straight from the mapped file, OBJ and glTF sources go through the importer and the usual optimization.
+// Every object created from the same file shares one upload.
+class StaticMesh : public Object3D
+{
+public:
+	explicit StaticMesh(const std::string& aMeshPath, const std::string& aTextureName = "Default");
+	~StaticMesh() = default;
+
+	bool Initialize(ID3D11Device* aDevice) override;
+	bool InitObjectResources() override;
+	const VertexFormatDesc& GetVertexFormat() const override;
+
+protected:
+	// Imports OBJ/glTF sources, converted mesh files never get here
+	void CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices) override;
+	std::string GetGeometryKey() const override;
+
+private:
+	std::string myMeshPath;
+	std::string myTextureName;
+};
@@ -3,140 +3,10 @@
 #include <cmath>
 #include <fstream>
 
-#include "Includes/PCG/PerlinNoise.hpp" // Include Perlin noise header
-
 #include "Engine.h"
 #include "GraphicsEngine.h"
-
-float GenerateHeight(float x, float z, const siv::PerlinNoise& perlin, float baseScale, float heightScale, int octaves, float persistence, float lacunarity)
-{
-    float frequency = baseScale;
-    float amplitude = heightScale;
-    float noiseHeight = 0.0f;
-
-    for (int i = 0; i < octaves; ++i)
-    {
-        noiseHeight += static_cast<float>(perlin.octave2D_01(x * frequency, z * frequency, 1)) * amplitude;
-        frequency *= lacunarity;
-        amplitude *= persistence;
-    }
-
-    return noiseHeight/* - (heightScale / 2.0f)*/; // Center the height
-}
-void ApplyRegionModifiers(std::vector<Vertex>& vertices, int gridSize, const siv::PerlinNoise& perlin, float regionScale, int numLakes, int numMountains, int numPlains)
-{
-    float regionSize = static_cast<float>(gridSize) * regionScale;
-
-    for (int z = 0; z <= gridSize; ++z)
-    {
-        for (int x = 0; x <= gridSize; ++x)
-        {
-            int index = z * (gridSize + 1) + x;
-            Vertex& vertex = vertices[index];
-
-            float heightAdjustment = 0.0f;
-
-            // Lakes
-            for (int i = 0; i < numLakes; ++i)
-            {
-                float lakeX = perlin.noise2D_01(i * 10.0f, 0.0f) * gridSize;
-                float lakeZ = perlin.noise2D_01(0.0f, i * 10.0f) * gridSize;
-                float distance = sqrt(pow(x - lakeX, 2) + pow(z - lakeZ, 2));
-                heightAdjustment -= 10.0f * exp(-distance / (regionSize * 0.25f)); // Smooth falloff
-            }
-
-            // Mountains
-            for (int i = 0; i < numMountains; ++i)
-            {
-                float mountainX = perlin.noise2D_01(i * 20.0f, 0.0f) * gridSize;
-                float mountainZ = perlin.noise2D_01(0.0f, i * 20.0f) * gridSize;
-                float distance = sqrt(pow(x - mountainX, 2) + pow(z - mountainZ, 2));
-                heightAdjustment += 50.0f * exp(-distance / (regionSize * 0.2f)); // Taller, sharper falloff
-            }
-
-            // Plains
-            for (int i = 0; i < numPlains; ++i)
-            {
-                float plainX = perlin.noise2D_01(i * 30.0f, 0.0f) * gridSize;
-                float plainZ = perlin.noise2D_01(0.0f, i * 30.0f) * gridSize;
-                float distance = sqrt(pow(x - plainX, 2) + pow(z - plainZ, 2));
-                heightAdjustment = std::lerp(vertex.y, 0.0f, exp(-distance / (regionSize * 0.3f))); // Flatten smoothly
-            }
-
-            vertex.y += heightAdjustment;
-        }
-    }
-}
-void ComputeTangentsAndBitangents(std::vector<Vertex>& vertices, const std::vector<UINT>& indices) {
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        UINT i0 = indices[i];
-        UINT i1 = indices[i + 1];
-        UINT i2 = indices[i + 2];
-
-        Vertex& v0 = vertices[i0];
-        Vertex& v1 = vertices[i1];
-        Vertex& v2 = vertices[i2];
-
-        // Position vectors
-        CommonUtilities::Vector3<float> pos0(v0.x, v0.y, v0.z);
-        CommonUtilities::Vector3<float> pos1(v1.x, v1.y, v1.z);
-        CommonUtilities::Vector3<float> pos2(v2.x, v2.y, v2.z);
-
-        // Texture coordinates
-        CommonUtilities::Vector2<float> uv0(v0.u, v0.v);
-        CommonUtilities::Vector2<float> uv1(v1.u, v1.v);
-        CommonUtilities::Vector2<float> uv2(v2.u, v2.v);
-
-        // Edges of the triangle
-        auto edge1 = pos1 - pos0;
-        auto edge2 = pos2 - pos0;
-
-        auto deltaUV1 = uv1 - uv0;
-        auto deltaUV2 = uv2 - uv0;
-
-        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-        // Compute tangent and bitangent
-        CommonUtilities::Vector3<float> tangent, bitangent;
-        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-
-        bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-        bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-        bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-
-        // Orthogonalize tangent to the normal
-        CommonUtilities::Vector3<float> normal(v0.nx, v0.ny, v0.nz);
-        tangent = tangent - (tangent.Dot(normal) * normal);
-        tangent.Normalize();
-
-        // Recalculate the bitangent
-        bitangent = normal.Cross(tangent);
-        bitangent.Normalize();
-
-        // Add tangent and bitangent to vertices
-        v0.tx += tangent.x; v0.ty += tangent.y; v0.tz += tangent.z;
-        v1.tx += tangent.x; v1.ty += tangent.y; v1.tz += tangent.z;
-        v2.tx += tangent.x; v2.ty += tangent.y; v2.tz += tangent.z;
-
-        v0.bx += bitangent.x; v0.by += bitangent.y; v0.bz += bitangent.z;
-        v1.bx += bitangent.x; v1.by += bitangent.y; v1.bz += bitangent.z;
-        v2.bx += bitangent.x; v2.by += bitangent.y; v2.bz += bitangent.z;
-    }
-
-    // Normalize tangents and bitangents
-    for (auto& v : vertices) {
-        CommonUtilities::Vector3<float> tangent(v.tx, v.ty, v.tz);
-        CommonUtilities::Vector3<float> bitangent(v.bx, v.by, v.bz);
-
-        tangent.Normalize();
-        bitangent.Normalize();
-
-        v.tx = tangent.x; v.ty = tangent.y; v.tz = tangent.z;
-        v.bx = bitangent.x; v.by = bitangent.y; v.bz = bitangent.z;
-    }
-}
+#include "TerrainBaker.h"
+#include "TerrainHeight.h"
 
 bool Terrain::Initialize(ID3D11Device* aDevice)
 {
@@ -144,6 +14,8 @@ bool Terrain::Initialize(ID3D11Device* aDevice)
     std::vector<UINT> indices;
     CreateGeometry(vertices, indices);
     InitObjectResources();
+    GenerateTangentFrames(vertices, indices);
+    OptimizeGeometry(vertices, indices);
     if (!CreateBuffers(aDevice, vertices, indices))
     {
         return false;
@@ -154,65 +26,50 @@ bool Terrain::Initialize(ID3D11Device* aDevice)
     }
     return LoadShadersAndCreateInputLayout(aDevice);
 }
-void Terrain::Render(ID3D11DeviceContext* aContext)
+void Terrain::Record(RenderCommandBuffer& aCommands, RenderState* aBoundState) const
 {
-    aContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    aContext->IASetInputLayout(myInputLayout.Get());
-    unsigned int stride = sizeof(Vertex);
-    unsigned int offset = 0;
-    aContext->IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
-    aContext->IASetIndexBuffer(myIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-    aContext->VSSetShader(myVertexShader.Get(), nullptr, 0);
-    aContext->PSSetShader(myPixelShader.Get(), nullptr, 0);
-    if (myTexture)
-    {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
-    }
-    /*else
-    {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
-    }*/
-    aContext->DrawIndexed(myIndexCount, 0, 0);
+    BindRenderState(aCommands, aBoundState);
+    aCommands.DrawIndexed(myIndexCount, 0, 0);
 }
-void Terrain::RenderDiffuse(ID3D11DeviceContext* aContext)
+void Terrain::RenderDiffuse(RenderContext& aContext)
 {
-    aContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    aContext->IASetInputLayout(myInputLayout.Get());
-    unsigned int stride = sizeof(Vertex);
+    aContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    aContext.IASetInputLayout(myInputLayout.Get());
+    unsigned int stride = myGeometry->vertexStride;
     unsigned int offset = 0;
-    aContext->IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
-    aContext->IASetIndexBuffer(myIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-    aContext->VSSetShader(myVertexShader.Get(), nullptr, 0);
-    aContext->PSSetShader(myDiffusePixelShader.Get(), nullptr, 0);
+    aContext.IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
+    aContext.IASetIndexBuffer(myIndexBuffer.Get(), myGeometry->indexFormat, 0);
+    aContext.VSSetShader(myVertexShader.Get(), nullptr, 0);
+    aContext.PSSetShader(myDiffusePixelShader.Get(), nullptr, 0);
     if (myTexture)
     {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
+        aContext.PSSetShaderResources(0, 1, GetTexture());
     }
     /*else
     {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
+        aContext.PSSetShaderResources(0, 1, GetTexture());
     }*/
-    aContext->DrawIndexed(myIndexCount, 0, 0);
+    aContext.DrawIndexed(myIndexCount, 0, 0);
 }
-void Terrain::RenderSpecular(ID3D11DeviceContext* aContext)
+void Terrain::RenderSpecular(RenderContext& aContext)
 {
-    aContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    aContext->IASetInputLayout(myInputLayout.Get());
-    unsigned int stride = sizeof(Vertex);
+    aContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    aContext.IASetInputLayout(myInputLayout.Get());
+    unsigned int stride = myGeometry->vertexStride;
     unsigned int offset = 0;
-    aContext->IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
-    aContext->IASetIndexBuffer(myIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-    aContext->VSSetShader(myVertexShader.Get(), nullptr, 0);
-    aContext->PSSetShader(mySpecularPixelShader.Get(), nullptr, 0);
+    aContext.IASetVertexBuffers(0, 1, myVertexBuffer.GetAddressOf(), &stride, &offset);
+    aContext.IASetIndexBuffer(myIndexBuffer.Get(), myGeometry->indexFormat, 0);
+    aContext.VSSetShader(myVertexShader.Get(), nullptr, 0);
+    aContext.PSSetShader(mySpecularPixelShader.Get(), nullptr, 0);
     if (myTexture)
     {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
+        aContext.PSSetShaderResources(0, 1, GetTexture());
     }
     /*else
     {
-        aContext->PSSetShaderResources(0, 1, GetTexture());
+        aContext.PSSetShaderResources(0, 1, GetTexture());
     }*/
-    aContext->DrawIndexed(myIndexCount, 0, 0);
+    aContext.DrawIndexed(myIndexCount, 0, 0);
 }
 
 void Terrain::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
@@ -220,26 +77,20 @@ void Terrain::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT
     myGridSize = 256;
     myTileSize = 1; // Resolution
 
-    const siv::PerlinNoise::seed_type seed = 123456u;
-    const siv::PerlinNoise perlin{ seed };
+    myHeightSettings.gridSize = myGridSize;
+    const TerrainHeightFunction heightFunction(myHeightSettings);
 
     int numVertices = myGridSize + 1; // One extra row/column for vertices
     someVertices.resize(numVertices * numVertices);
     someIndices.reserve(myGridSize * myGridSize * 6); // Two triangles per tile
 
-    float baseScale = 0.02f;      // Adjust for larger-scale features
-    float heightScale = 50.0f;    // Overall height range
-    int octaves = 6;              // More layers for detail
-    float persistence = 0.5f;     // Amplitude decay
-    float lacunarity = 2.0f;      // Frequency growth
-
     for (int z = 0; z <= myGridSize; ++z)
     {
         for (int x = 0; x <= myGridSize; ++x)
         {
             float fx = static_cast<float>(x) * static_cast<float>(myTileSize);
             float fz = static_cast<float>(z) * static_cast<float>(myTileSize);
-            float height = GenerateHeight(fx, fz, perlin, baseScale, heightScale, octaves, persistence, lacunarity);
+            float height = heightFunction.GetHeight(fx, fz);
 
             Vertex vertex = {};
             vertex.x = fx;
@@ -247,10 +98,6 @@ void Terrain::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT
             vertex.z = -fz;
             vertex.w = 1.0f;
 
-            // Set color based on height
-            vertex.r = 0.0f;
-            vertex.g = vertex.y > 0 ? 1.0f : 0.0f;
-            vertex.b = vertex.y < 0 ? 1.0f : 0.0f;
             vertex.a = 1.0f;
 
             vertex.nx = 0.0f; // Placeholder normal
@@ -262,7 +109,23 @@ void Terrain::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT
         }
     }
 
-    ApplyRegionModifiers(someVertices, myGridSize, perlin, 0.5f, 2, 2, 2);
+    // Keep the final heights around for the bakers and store horizon AO in the vertex color
+    myHeightfield.width = numVertices;
+    myHeightfield.depth = numVertices;
+    myHeightfield.spacing = static_cast<float>(myTileSize);
+    myHeightfield.heights.resize(someVertices.size());
+    for (size_t i = 0; i < someVertices.size(); ++i)
+    {
+        myHeightfield.heights[i] = someVertices[i].y;
+    }
+
+    std::vector<float> ambientOcclusion = BakeHorizonAmbientOcclusion(myHeightfield, myAmbientOcclusionSettings);
+    for (size_t i = 0; i < someVertices.size(); ++i)
+    {
+        someVertices[i].r = ambientOcclusion[i];
+        someVertices[i].g = ambientOcclusion[i];
+        someVertices[i].b = ambientOcclusion[i];
+    }
 
     for (int z = 0; z < myGridSize; ++z)
     {
@@ -335,20 +198,65 @@ void Terrain::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT
         someVertices[i].ny = accumulatedNormals[i].y;
         someVertices[i].nz = accumulatedNormals[i].z;
     }
-
-    // Compute tangents and bitangents for lighting and texture mapping
-    ComputeTangentsAndBitangents(someVertices, someIndices);
 }
 bool Terrain::InitObjectResources()
 {
     SetVertexShaderPath("Terrain_VS.cso");
     SetPixelShaderPath("Terrain_PS.cso");
+    myPassMask = PassMaskMain | PassMaskReflection | PassMaskDiffuseDebug | PassMaskSpecularDebug;
 
     TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
     SetTexture(textureManager.GetTexture("Default"));
 
     return true;
 }
+bool Terrain::BakeSunVisibility(const CommonUtilities::Vector3<float>& aSunAzimuth)
+{
+    // Heightfield rows run towards -z in world space
+    SunHorizonBakeSettings settings;
+    settings.directionX = aSunAzimuth.x;
+    settings.directionZ = -aSunAzimuth.z;
+
+    const std::uint64_t key = GetSunHorizonBakeKey(myHeightfield, settings);
+    const std::string cachePath = "Cache/TerrainSunHorizon_" + std::to_string(key) + ".bin";
+
+    const size_t expectedSize = static_cast<size_t>(myHeightfield.width) * myHeightfield.depth * 2;
+    if (!ReadBakeCache(cachePath, key, mySunHorizon) || mySunHorizon.size() != expectedSize)
+    {
+        mySunHorizon = BakeSunHorizon(myHeightfield, settings);
+        if (!WriteBakeCache(cachePath, key, mySunHorizon))
+        {
+            std::cerr << "Failed to write terrain sun horizon cache: " << cachePath << std::endl;
+        }
+    }
+
+    TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
+    return textureManager.CreateTextureFromMemory("TerrainSunHorizon", mySunHorizon.data(), myHeightfield.width, myHeightfield.depth, DXGI_FORMAT_R8G8_UNORM, 2);
+}
+bool Terrain::BakeNormalMap(int aResolution)
+{
+    // The whole grid is a single chunk for now, other chunks only need their own minX/minZ and cache file
+    NormalBakeSettings settings;
+    settings.size = static_cast<float>(myGridSize * myTileSize);
+    settings.resolution = aResolution;
+
+    const std::uint64_t key = GetNormalBakeKey(myHeightSettings, settings);
+    const std::string cachePath = "Cache/TerrainNormals_" + std::to_string(key) + ".bin";
+
+    std::vector<unsigned char> normals;
+    const size_t expectedSize = static_cast<size_t>(aResolution) * aResolution * 2;
+    if (!ReadBakeCache(cachePath, key, normals) || normals.size() != expectedSize)
+    {
+        normals = BakeTerrainNormals(TerrainHeightFunction(myHeightSettings), settings);
+        if (!WriteBakeCache(cachePath, key, normals))
+        {
+            std::cerr << "Failed to write terrain normal cache: " << cachePath << std::endl;
+        }
+    }
+
+    TextureManager& textureManager = Engine::GetInstance().GetGraphicsEngine().GetTextureManager();
+    return textureManager.CreateTextureFromMemory("TerrainNormals", normals.data(), aResolution, aResolution, DXGI_FORMAT_R8G8_SNORM, 2);
+}
 bool Terrain::LoadTestShaders(ID3D11Device* aDevice)
 {
     std::string solutionDir = SOLUTION_DIR;
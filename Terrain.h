@@ -1,5 +1,7 @@
 #pragma once
 #include "Object3D.h"
+#include "TerrainBaker.h"
+#include "TerrainHeight.h"
 
 class Terrain : public Object3D
 {
@@ -8,17 +10,27 @@ public:
 	~Terrain() = default;
 
 	bool Initialize(ID3D11Device* aDevice) override;
-	void Render(ID3D11DeviceContext* aContext) override;
-	void RenderDiffuse(ID3D11DeviceContext* aContext);
-	void RenderSpecular(ID3D11DeviceContext* aContext);
+	void Record(RenderCommandBuffer& aCommands, RenderState* aBoundState = nullptr) const override;
+	void RenderDiffuse(RenderContext& aContext);
+	void RenderSpecular(RenderContext& aContext);
 	void CreateGeometry(std::vector<Vertex>& vertices, std::vector<UINT>& indices) override;
 
 	bool InitObjectResources() override;
 	bool LoadTestShaders(ID3D11Device* aDevice);
+	bool BakeSunVisibility(const CommonUtilities::Vector3<float>& aSunAzimuth);
+	bool BakeNormalMap(int aResolution);
+	const Heightfield& GetHeightfield() const { return myHeightfield; }
+	const TerrainHeightSettings& GetHeightSettings() const { return myHeightSettings; }
+	// Side of the meshed grid in world units, it spans x and -z from the terrain position
+	float GetSize() const { return static_cast<float>(myGridSize * myTileSize); }
 
 
 	ComPtr<ID3D11PixelShader> myDiffusePixelShader;
 	ComPtr<ID3D11PixelShader> mySpecularPixelShader;
 	int myGridSize = 256;
 	int myTileSize = 256;
+	TerrainHeightSettings myHeightSettings;
+	Heightfield myHeightfield;
+	HorizonBakeSettings myAmbientOcclusionSettings;
+	std::vector<unsigned char> mySunHorizon;
 };
\ No newline at end of file
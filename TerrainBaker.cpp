@@ -0,0 +1,365 @@
+#include "TerrainBaker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <xmmintrin.h>
+
+#include "ParallelFor.h"
+
+namespace
+{
+    constexpr float locPi = 3.14159265358979323846f;
+    constexpr int locSimdWidth = 4;
+
+    // Copy of the heightfield with aBorder clamped samples on every side and extra columns on the right,
+    // so the SIMD loops can load four neighbours at any offset within aBorder without bounds checks.
+    struct PaddedHeights
+    {
+        int border = 0;
+        int pitch = 0;
+        std::vector<float> heights;
+
+        const float* GetRow(int z) const { return heights.data() + (z + border) * pitch + border; }
+    };
+
+    PaddedHeights BuildPaddedHeights(const Heightfield& aHeightfield, int aBorder)
+    {
+        PaddedHeights padded;
+        padded.border = aBorder;
+        padded.pitch = aHeightfield.width + aBorder * 2 + locSimdWidth;
+
+        const int paddedDepth = aHeightfield.depth + aBorder * 2;
+        padded.heights.resize(static_cast<size_t>(padded.pitch) * paddedDepth);
+
+        for (int z = 0; z < paddedDepth; ++z)
+        {
+            for (int x = 0; x < padded.pitch; ++x)
+            {
+                padded.heights[z * padded.pitch + x] = aHeightfield.GetHeight(x - aBorder, z - aBorder);
+            }
+        }
+        return padded;
+    }
+
+    struct HorizonStep
+    {
+        int offset;        // Offset into PaddedHeights::heights
+        float invDistance; // 1 / world distance to the stepped sample
+    };
+
+    // Snaps each march step to the grid and drops duplicates, so the inner loop only does contiguous loads.
+    std::vector<HorizonStep> BuildDirectionSteps(float aDirX, float aDirZ, int aStepCount, float aMaxDistance, float aSpacing, int aPitch)
+    {
+        std::vector<HorizonStep> steps;
+        int lastX = 0;
+        int lastZ = 0;
+
+        for (int step = 1; step <= aStepCount; ++step)
+        {
+            const float distance = aMaxDistance * static_cast<float>(step) / static_cast<float>(aStepCount);
+            const int offsetX = static_cast<int>(std::lround(aDirX * distance / aSpacing));
+            const int offsetZ = static_cast<int>(std::lround(aDirZ * distance / aSpacing));
+            if ((offsetX == 0 && offsetZ == 0) || (offsetX == lastX && offsetZ == lastZ))
+            {
+                continue;
+            }
+            lastX = offsetX;
+            lastZ = offsetZ;
+
+            const float gridDistance = std::sqrt(static_cast<float>(offsetX * offsetX + offsetZ * offsetZ)) * aSpacing;
+            steps.push_back({ offsetZ * aPitch + offsetX, 1.0f / gridDistance });
+        }
+        return steps;
+    }
+
+    constexpr std::uint32_t locBakeCacheMagic = 0x454B4142; // "BAKE"
+    constexpr std::uint32_t locNormalBakeVersion = 1;       // Bump when the normal bake output changes
+    constexpr std::uint32_t locSunHorizonBakeVersion = 1;   // Bump when the sun horizon bake output changes
+
+    // FNV-1a, only used to tell bake inputs apart
+    struct BakeKeyBuilder
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+
+        template <class T>
+        void Add(const T& aValue)
+        {
+            AddBytes(&aValue, sizeof(T));
+        }
+        void AddBytes(const void* someData, size_t aSize)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(someData);
+            for (size_t i = 0; i < aSize; ++i)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        }
+    };
+
+    signed char ToSignedByte(float aValue)
+    {
+        return static_cast<signed char>(std::lround(std::clamp(aValue, -1.0f, 1.0f) * 127.0f));
+    }
+
+    // Highest elevation tangent seen from four neighbouring samples, below-horizontal terrain never counts
+    __m128 MarchHorizon(const float* aCenter, __m128 aCenterHeight, const std::vector<HorizonStep>& someSteps)
+    {
+        __m128 horizon = _mm_setzero_ps();
+        for (const HorizonStep& step : someSteps)
+        {
+            const __m128 rise = _mm_sub_ps(_mm_loadu_ps(aCenter + step.offset), aCenterHeight);
+            horizon = _mm_max_ps(horizon, _mm_mul_ps(rise, _mm_set1_ps(step.invDistance)));
+        }
+        return horizon;
+    }
+}
+
+float Heightfield::GetHeight(int x, int z) const
+{
+    x = std::clamp(x, 0, width - 1);
+    z = std::clamp(z, 0, depth - 1);
+    return heights[z * width + x];
+}
+
+std::vector<float> BakeHorizonAmbientOcclusion(const Heightfield& aHeightfield, const HorizonBakeSettings& someSettings)
+{
+    std::vector<float> ambientOcclusion(aHeightfield.heights.size(), 1.0f);
+    if (aHeightfield.width <= 0 || aHeightfield.depth <= 0 || someSettings.directionCount <= 0)
+    {
+        return ambientOcclusion;
+    }
+
+    const int border = static_cast<int>(std::ceil(someSettings.maxDistance / aHeightfield.spacing));
+    const PaddedHeights padded = BuildPaddedHeights(aHeightfield, border);
+
+    std::vector<std::vector<HorizonStep>> directions(someSettings.directionCount);
+    for (int i = 0; i < someSettings.directionCount; ++i)
+    {
+        const float angle = (static_cast<float>(i) + 0.5f) * 2.0f * locPi / static_cast<float>(someSettings.directionCount);
+        directions[i] = BuildDirectionSteps(std::cos(angle), std::sin(angle), someSettings.stepCount, someSettings.maxDistance, aHeightfield.spacing, padded.pitch);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 maxTangent = _mm_set1_ps(std::tan(someSettings.maxHorizonAngle));
+    const __m128 invDirectionCount = _mm_set1_ps(1.0f / static_cast<float>(someSettings.directionCount));
+
+    ParallelFor(0, aHeightfield.depth, [&](int aFirstRow, int aLastRow)
+    {
+        for (int z = aFirstRow; z < aLastRow; ++z)
+        {
+            const float* row = padded.GetRow(z);
+            float* output = ambientOcclusion.data() + z * aHeightfield.width;
+
+            for (int x = 0; x < aHeightfield.width; x += locSimdWidth)
+            {
+                const float* center = row + x;
+                const __m128 centerHeight = _mm_loadu_ps(center);
+                __m128 occlusion = zero;
+
+                for (const auto& steps : directions)
+                {
+                    const __m128 horizon = _mm_min_ps(MarchHorizon(center, centerHeight, steps), maxTangent);
+
+                    // sin(atan(t)) = t / sqrt(1 + t^2)
+                    const __m128 sinHorizon = _mm_div_ps(horizon, _mm_sqrt_ps(_mm_add_ps(one, _mm_mul_ps(horizon, horizon))));
+                    occlusion = _mm_add_ps(occlusion, sinHorizon);
+                }
+
+                alignas(16) float result[locSimdWidth];
+                _mm_store_ps(result, _mm_sub_ps(one, _mm_mul_ps(occlusion, invDirectionCount)));
+
+                const int count = std::min(locSimdWidth, aHeightfield.width - x);
+                for (int i = 0; i < count; ++i)
+                {
+                    output[x + i] = result[i];
+                }
+            }
+        }
+    });
+
+    return ambientOcclusion;
+}
+
+std::vector<unsigned char> BakeSunHorizon(const Heightfield& aHeightfield, const SunHorizonBakeSettings& someSettings)
+{
+    std::vector<unsigned char> sunHorizon(aHeightfield.heights.size() * 2, 0);
+    const float length = std::sqrt(someSettings.directionX * someSettings.directionX + someSettings.directionZ * someSettings.directionZ);
+    if (aHeightfield.width <= 0 || aHeightfield.depth <= 0 || length == 0.0f)
+    {
+        return sunHorizon;
+    }
+
+    const float dirX = someSettings.directionX / length;
+    const float dirZ = someSettings.directionZ / length;
+    const int border = static_cast<int>(std::ceil(someSettings.maxDistance / aHeightfield.spacing));
+    const PaddedHeights padded = BuildPaddedHeights(aHeightfield, border);
+    const std::vector<HorizonStep> sunriseSteps = BuildDirectionSteps(dirX, dirZ, someSettings.stepCount, someSettings.maxDistance, aHeightfield.spacing, padded.pitch);
+    const std::vector<HorizonStep> sunsetSteps = BuildDirectionSteps(-dirX, -dirZ, someSettings.stepCount, someSettings.maxDistance, aHeightfield.spacing, padded.pitch);
+    const float angleToByte = 255.0f / (locPi * 0.5f);
+
+    ParallelFor(0, aHeightfield.depth, [&](int aFirstRow, int aLastRow)
+    {
+        for (int z = aFirstRow; z < aLastRow; ++z)
+        {
+            const float* row = padded.GetRow(z);
+            unsigned char* output = sunHorizon.data() + z * aHeightfield.width * 2;
+
+            for (int x = 0; x < aHeightfield.width; x += locSimdWidth)
+            {
+                const float* center = row + x;
+                const __m128 centerHeight = _mm_loadu_ps(center);
+
+                alignas(16) float sunrise[locSimdWidth];
+                alignas(16) float sunset[locSimdWidth];
+                _mm_store_ps(sunrise, MarchHorizon(center, centerHeight, sunriseSteps));
+                _mm_store_ps(sunset, MarchHorizon(center, centerHeight, sunsetSteps));
+
+                const int count = std::min(locSimdWidth, aHeightfield.width - x);
+                for (int i = 0; i < count; ++i)
+                {
+                    // Round up so the shader never lights a texel that is just barely shadowed
+                    output[(x + i) * 2 + 0] = static_cast<unsigned char>(std::min(255.0f, std::ceil(std::atan(sunrise[i]) * angleToByte)));
+                    output[(x + i) * 2 + 1] = static_cast<unsigned char>(std::min(255.0f, std::ceil(std::atan(sunset[i]) * angleToByte)));
+                }
+            }
+        }
+    });
+
+    return sunHorizon;
+}
+
+std::vector<unsigned char> BakeTerrainNormals(const TerrainHeightFunction& aHeightFunction, const NormalBakeSettings& someSettings)
+{
+    const int resolution = someSettings.resolution;
+    std::vector<unsigned char> normals(static_cast<size_t>(resolution) * resolution * 2, 0);
+    if (resolution <= 0 || someSettings.size <= 0.0f)
+    {
+        return normals;
+    }
+
+    // Heights at every texel center plus a one texel border
+    const float texelSize = someSettings.size / static_cast<float>(resolution);
+    const int pitch = resolution + 2;
+    std::vector<float> heights(static_cast<size_t>(pitch) * pitch);
+    ParallelFor(0, pitch, [&](int aFirstRow, int aLastRow)
+    {
+        for (int z = aFirstRow; z < aLastRow; ++z)
+        {
+            const float sampleZ = someSettings.minZ + (static_cast<float>(z) - 0.5f) * texelSize;
+            for (int x = 0; x < pitch; ++x)
+            {
+                const float sampleX = someSettings.minX + (static_cast<float>(x) - 0.5f) * texelSize;
+                heights[z * pitch + x] = aHeightFunction.GetHeight(sampleX, sampleZ);
+            }
+        }
+    });
+
+    const float invTwoTexels = 1.0f / (2.0f * texelSize);
+    ParallelFor(0, resolution, [&](int aFirstRow, int aLastRow)
+    {
+        for (int z = aFirstRow; z < aLastRow; ++z)
+        {
+            const float* row = heights.data() + (z + 1) * pitch + 1;
+            unsigned char* output = normals.data() + static_cast<size_t>(z) * resolution * 2;
+
+            for (int x = 0; x < resolution; ++x)
+            {
+                const float slopeX = (row[x + 1] - row[x - 1]) * invTwoTexels;
+                const float slopeZ = (row[x + pitch] - row[x - pitch]) * invTwoTexels;
+
+                // Heightfield rows run towards -z in world space
+                const float invLength = 1.0f / std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+                output[x * 2 + 0] = static_cast<unsigned char>(ToSignedByte(-slopeX * invLength));
+                output[x * 2 + 1] = static_cast<unsigned char>(ToSignedByte(slopeZ * invLength));
+            }
+        }
+    });
+
+    return normals;
+}
+
+std::uint64_t GetNormalBakeKey(const TerrainHeightSettings& someHeightSettings, const NormalBakeSettings& someSettings)
+{
+    BakeKeyBuilder key;
+    key.Add(locNormalBakeVersion);
+    key.Add(someHeightSettings.seed);
+    key.Add(someHeightSettings.baseScale);
+    key.Add(someHeightSettings.heightScale);
+    key.Add(someHeightSettings.octaves);
+    key.Add(someHeightSettings.persistence);
+    key.Add(someHeightSettings.lacunarity);
+    key.Add(someHeightSettings.gridSize);
+    key.Add(someHeightSettings.regionScale);
+    key.Add(someHeightSettings.lakeCount);
+    key.Add(someHeightSettings.mountainCount);
+    key.Add(someHeightSettings.plainCount);
+    key.Add(someSettings.minX);
+    key.Add(someSettings.minZ);
+    key.Add(someSettings.size);
+    key.Add(someSettings.resolution);
+    return key.hash;
+}
+std::uint64_t GetSunHorizonBakeKey(const Heightfield& aHeightfield, const SunHorizonBakeSettings& someSettings)
+{
+    BakeKeyBuilder key;
+    key.Add(locSunHorizonBakeVersion);
+    key.Add(aHeightfield.width);
+    key.Add(aHeightfield.depth);
+    key.Add(aHeightfield.spacing);
+    key.AddBytes(aHeightfield.heights.data(), aHeightfield.heights.size() * sizeof(float));
+    key.Add(someSettings.directionX);
+    key.Add(someSettings.directionZ);
+    key.Add(someSettings.stepCount);
+    key.Add(someSettings.maxDistance);
+    return key.hash;
+}
+
+bool ReadBakeCache(const std::string& aPath, std::uint64_t aKey, std::vector<unsigned char>& someData)
+{
+    std::ifstream file(aPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::uint32_t magic = 0;
+    std::uint64_t key = 0;
+    std::uint64_t size = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&key), sizeof(key));
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!file || magic != locBakeCacheMagic || key != aKey)
+    {
+        return false;
+    }
+
+    someData.resize(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(someData.data()), static_cast<std::streamsize>(size));
+    return static_cast<bool>(file);
+}
+
+bool WriteBakeCache(const std::string& aPath, std::uint64_t aKey, const std::vector<unsigned char>& someData)
+{
+    std::error_code error;
+    const std::filesystem::path path(aPath);
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    std::ofstream file(aPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    const std::uint64_t size = someData.size();
+    file.write(reinterpret_cast<const char*>(&locBakeCacheMagic), sizeof(locBakeCacheMagic));
+    file.write(reinterpret_cast<const char*>(&aKey), sizeof(aKey));
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char*>(someData.data()), static_cast<std::streamsize>(someData.size()));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TerrainHeight.h"
+
+struct Heightfield
+{
+    int width = 0;              // Samples along x
+    int depth = 0;              // Samples along z
+    float spacing = 1.0f;       // World units between neighbouring samples
+    std::vector<float> heights; // Row-major, heights[z * width + x]
+
+    float GetHeight(int x, int z) const; // Clamps to the border
+};
+
+struct HorizonBakeSettings
+{
+    int directionCount = 8;       // Azimuth directions marched per sample
+    int stepCount = 16;           // Height samples per direction
+    float maxDistance = 32.0f;    // World units searched for occluders
+    float maxHorizonAngle = 1.3f; // Radians, steeper horizons are clamped to this
+};
+
+struct NormalBakeSettings
+{
+    float minX = 0.0f;      // Heightfield-space corner of the baked chunk
+    float minZ = 0.0f;
+    float size = 256.0f;    // Chunk width and depth in heightfield units
+    int resolution = 1024;  // Texels along each side
+};
+
+struct SunHorizonBakeSettings
+{
+    float directionX = 1.0f;   // Heightfield-space direction towards the rising sun, it sets on the opposite side
+    float directionZ = 0.0f;
+    int stepCount = 32;
+    float maxDistance = 96.0f;
+};
+
+// Horizon-based ambient occlusion per heightfield sample, 1.0f is a fully open sky and 0.0f fully occluded.
+// Rows are split across threads and each row is processed four samples at a time with SSE.
+std::vector<float> BakeHorizonAmbientOcclusion(const Heightfield& aHeightfield, const HorizonBakeSettings& someSettings);
+
+// Horizon elevation along the sun's path per heightfield sample, packed as R8G8 where r looks towards the rising sun
+// and g towards the setting sun, 0 is flat and 255 is straight up. A texel is lit when the sun is above its horizon.
+std::vector<unsigned char> BakeSunHorizon(const Heightfield& aHeightfield, const SunHorizonBakeSettings& someSettings);
+// Hashes the heights themselves, the heightfield may come from anywhere
+std::uint64_t GetSunHorizonBakeKey(const Heightfield& aHeightfield, const SunHorizonBakeSettings& someSettings);
+
+// World-space normals of one terrain chunk sampled straight from the height function, so coarse geometry can be
+// shaded with full detail. Packed as R8G8_SNORM world x and z, y is always up for a heightfield and rebuilt in the
+// shader. Each texel costs one height evaluation, the grid is shared by neighbouring central differences.
+std::vector<unsigned char> BakeTerrainNormals(const TerrainHeightFunction& aHeightFunction, const NormalBakeSettings& someSettings);
+std::uint64_t GetNormalBakeKey(const TerrainHeightSettings& someHeightSettings, const NormalBakeSettings& someSettings);
+
+// Raw bake results on disk, tagged with the key of the inputs that produced them so stale files are ignored
+bool ReadBakeCache(const std::string& aPath, std::uint64_t aKey, std::vector<unsigned char>& someData);
+bool WriteBakeCache(const std::string& aPath, std::uint64_t aKey, const std::vector<unsigned char>& someData);
@@ -0,0 +1,77 @@
+#include "TerrainHeight.h"
+
+#include <cmath>
+
+namespace
+{
+    std::vector<CommonUtilities::Vector2<float>> ScatterRegions(const siv::PerlinNoise& aPerlin, int aCount, float aSeedStep, float aGridSize)
+    {
+        std::vector<CommonUtilities::Vector2<float>> centers;
+        for (int i = 0; i < aCount; ++i)
+        {
+            const float x = static_cast<float>(aPerlin.noise2D_01(i * aSeedStep, 0.0f)) * aGridSize;
+            const float z = static_cast<float>(aPerlin.noise2D_01(0.0f, i * aSeedStep)) * aGridSize;
+            centers.push_back(CommonUtilities::Vector2<float>(x, z));
+        }
+        return centers;
+    }
+
+    float Distance(float x, float z, const CommonUtilities::Vector2<float>& aCenter)
+    {
+        return std::sqrt((x - aCenter.x) * (x - aCenter.x) + (z - aCenter.y) * (z - aCenter.y));
+    }
+}
+
+TerrainHeightFunction::TerrainHeightFunction(const TerrainHeightSettings& someSettings)
+    : mySettings(someSettings)
+    , myPerlin(someSettings.seed)
+    , myRegionSize(static_cast<float>(someSettings.gridSize) * someSettings.regionScale)
+{
+    // Region centers only depend on the seed, so they are found once instead of per sample
+    const float gridSize = static_cast<float>(mySettings.gridSize);
+    myLakes = ScatterRegions(myPerlin, mySettings.lakeCount, 10.0f, gridSize);
+    myMountains = ScatterRegions(myPerlin, mySettings.mountainCount, 20.0f, gridSize);
+    myPlains = ScatterRegions(myPerlin, mySettings.plainCount, 30.0f, gridSize);
+}
+
+float TerrainHeightFunction::GetHeight(float x, float z) const
+{
+    const float noiseHeight = GetNoiseHeight(x, z);
+    float heightAdjustment = 0.0f;
+
+    // Lakes
+    for (const auto& lake : myLakes)
+    {
+        heightAdjustment -= 10.0f * std::exp(-Distance(x, z, lake) / (myRegionSize * 0.25f)); // Smooth falloff
+    }
+
+    // Mountains
+    for (const auto& mountain : myMountains)
+    {
+        heightAdjustment += 50.0f * std::exp(-Distance(x, z, mountain) / (myRegionSize * 0.2f)); // Taller, sharper falloff
+    }
+
+    // Plains
+    for (const auto& plain : myPlains)
+    {
+        heightAdjustment = std::lerp(noiseHeight, 0.0f, std::exp(-Distance(x, z, plain) / (myRegionSize * 0.3f))); // Flatten smoothly
+    }
+
+    return noiseHeight + heightAdjustment;
+}
+
+float TerrainHeightFunction::GetNoiseHeight(float x, float z) const
+{
+    float frequency = mySettings.baseScale;
+    float amplitude = mySettings.heightScale;
+    float noiseHeight = 0.0f;
+
+    for (int i = 0; i < mySettings.octaves; ++i)
+    {
+        noiseHeight += static_cast<float>(myPerlin.octave2D_01(x * frequency, z * frequency, 1)) * amplitude;
+        frequency *= mySettings.lacunarity;
+        amplitude *= mySettings.persistence;
+    }
+
+    return noiseHeight;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+
+#include "Includes/PCG/PerlinNoise.hpp"
+#include "Includes/MeehanVector2.hpp"
+
+struct TerrainHeightSettings
+{
+    unsigned int seed = 123456u;
+    float baseScale = 0.02f;   // Adjust for larger-scale features
+    float heightScale = 50.0f; // Overall height range
+    int octaves = 6;           // More layers for detail
+    float persistence = 0.5f;  // Amplitude decay
+    float lacunarity = 2.0f;   // Frequency growth
+
+    int gridSize = 256;        // Lakes, mountains and plains are scattered over this many units
+    float regionScale = 0.5f;
+    int lakeCount = 2;
+    int mountainCount = 2;
+    int plainCount = 2;
+};
+
+// The terrain's height at any point, noise plus the lake/mountain/plain modifiers, so bakers can sample
+// it at any resolution or far outside the meshed grid. x runs along world x, z along the grid rows (world -z).
+class TerrainHeightFunction
+{
+public:
+    explicit TerrainHeightFunction(const TerrainHeightSettings& someSettings);
+
+    float GetHeight(float x, float z) const;
+    const TerrainHeightSettings& GetSettings() const { return mySettings; }
+
+private:
+    float GetNoiseHeight(float x, float z) const;
+
+    TerrainHeightSettings mySettings;
+    siv::PerlinNoise myPerlin;
+    float myRegionSize;
+    std::vector<CommonUtilities::Vector2<float>> myLakes;
+    std::vector<CommonUtilities::Vector2<float>> myMountains;
+    std::vector<CommonUtilities::Vector2<float>> myPlains;
+};
@@ -0,0 +1,280 @@
+#include "TerrainImpostor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+#include "Engine.h"
+#include "GraphicsEngine.h"
+#include "ParallelFor.h"
+
+namespace
+{
+    constexpr float locPi = 3.14159265358979323846f;
+
+    struct Color
+    {
+        float r, g, b;
+    };
+
+    // Same grass/rock/snow split as Terrain_PS, without the textures
+    Color ShadeTerrain(float aWorldHeight, float aNormalY)
+    {
+        const Color grass = { 0.28f, 0.42f, 0.18f };
+        const Color rock = { 0.42f, 0.40f, 0.38f };
+        const Color snow = { 0.90f, 0.92f, 0.95f };
+
+        const float slope = std::clamp(1.0f - aNormalY, 0.0f, 1.0f);
+        const float snowBlend = std::clamp((aWorldHeight - 90.0f) / 20.0f, 0.0f, 1.0f);
+        const float grassWeight = (1.0f - slope) * (1.0f - snowBlend);
+        const float rockWeight = slope * (1.0f - snowBlend);
+
+        // Bake in a little relief so slopes still read once the texture is tiny on screen
+        const float relief = 0.55f + 0.45f * aNormalY;
+        return {
+            (grass.r * grassWeight + rock.r * rockWeight + snow.r * snowBlend) * relief,
+            (grass.g * grassWeight + rock.g * rockWeight + snow.g * snowBlend) * relief,
+            (grass.b * grassWeight + rock.b * rockWeight + snow.b * snowBlend) * relief
+        };
+    }
+
+    // Where a ray from (anOriginX, anOriginZ) runs over the square [0, aSize] x [0, aSize], false when it misses it
+    bool IntersectSquare(float anOriginX, float anOriginZ, float aDirX, float aDirZ, float aSize, float& anEnter, float& anExit)
+    {
+        const float origins[2] = { anOriginX, anOriginZ };
+        const float directions[2] = { aDirX, aDirZ };
+        anEnter = 0.0f;
+        anExit = FLT_MAX;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (std::fabs(directions[axis]) < 1e-6f)
+            {
+                if (origins[axis] < 0.0f || origins[axis] > aSize)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            const float toLow = (0.0f - origins[axis]) / directions[axis];
+            const float toHigh = (aSize - origins[axis]) / directions[axis];
+            anEnter = std::max(anEnter, std::min(toLow, toHigh));
+            anExit = std::min(anExit, std::max(toLow, toHigh));
+        }
+        return anEnter < anExit;
+    }
+
+    unsigned char ToByte(float aValue)
+    {
+        return static_cast<unsigned char>(std::clamp(aValue, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+TerrainPanorama BakeTerrainPanorama(const TerrainHeightFunction& aHeightFunction, const TerrainImpostorSettings& someSettings, const CommonUtilities::Vector3<float>& aTerrainPosition, const CommonUtilities::Vector3<float>& anEye)
+{
+    TerrainPanorama panorama;
+    panorama.width = someSettings.columnCount;
+    panorama.height = someSettings.rowCount;
+    panorama.eye = anEye;
+    panorama.texels.assign(static_cast<size_t>(panorama.width) * panorama.height * 4, 0);
+
+    // Heightfield space, rows run towards -z in world space
+    const float eyeX = anEye.x - aTerrainPosition.x;
+    const float eyeZ = -(anEye.z - aTerrainPosition.z);
+    const float eyeHeight = anEye.y - aTerrainPosition.y;
+    const float tangentStep = (someSettings.maxTangent - someSettings.minTangent) / static_cast<float>(panorama.height);
+    const float hazeFalloff = std::log(2.0f) / someSettings.hazeDistance;
+
+    ParallelFor(0, panorama.width, [&](int aFirstColumn, int aLastColumn)
+    {
+        for (int column = aFirstColumn; column < aLastColumn; ++column)
+        {
+            const float angle = (static_cast<float>(column) + 0.5f) * 2.0f * locPi / static_cast<float>(panorama.width);
+            const float dirX = std::cos(angle);
+            const float dirZ = -std::sin(angle);
+
+            // The meshed grid draws itself, in its direction the panorama starts where the mesh ends
+            float meshedEnter = 0.0f;
+            float meshedExit = 0.0f;
+            const bool crossesMesh = someSettings.meshedSize > 0.0f &&
+                IntersectSquare(eyeX, eyeZ, dirX, dirZ, someSettings.meshedSize, meshedEnter, meshedExit);
+
+            int row = panorama.height - 1;
+            float distance = someSettings.nearestDistance;
+            while (row >= 0 && distance < someSettings.outerRadius)
+            {
+                if (crossesMesh && distance >= meshedEnter && distance < meshedExit)
+                {
+                    distance = meshedExit;
+                    continue;
+                }
+
+                const float step = std::max(1.0f, distance * someSettings.stepGrowth);
+                const float x = eyeX + dirX * distance;
+                const float z = eyeZ + dirZ * distance;
+                const float height = aHeightFunction.GetHeight(x, z);
+                const float tangent = (height - eyeHeight) / distance;
+
+                // Rows are linear in view slope, so a sample covers every row its slope has climbed past
+                const float rowTangent = someSettings.maxTangent - (static_cast<float>(row) + 0.5f) * tangentStep;
+                if (rowTangent <= tangent)
+                {
+                    const float slopeX = (aHeightFunction.GetHeight(x + step, z) - aHeightFunction.GetHeight(x - step, z)) / (2.0f * step);
+                    const float slopeZ = (aHeightFunction.GetHeight(x, z + step) - aHeightFunction.GetHeight(x, z - step)) / (2.0f * step);
+                    const float normalY = 1.0f / std::sqrt(1.0f + slopeX * slopeX + slopeZ * slopeZ);
+                    const Color color = ShadeTerrain(height + aTerrainPosition.y, normalY);
+                    const float transmittance = std::exp(-distance * hazeFalloff);
+
+                    while (row >= 0 && someSettings.maxTangent - (static_cast<float>(row) + 0.5f) * tangentStep <= tangent)
+                    {
+                        unsigned char* texel = panorama.texels.data() + (static_cast<size_t>(row) * panorama.width + column) * 4;
+                        texel[0] = ToByte(color.r);
+                        texel[1] = ToByte(color.g);
+                        texel[2] = ToByte(color.b);
+                        texel[3] = static_cast<unsigned char>(1 + std::lround(transmittance * 254.0f)); // 0 is reserved for sky
+                        --row;
+                    }
+                }
+                distance += step;
+            }
+        }
+    });
+
+    return panorama;
+}
+
+TerrainImpostor::TerrainImpostor(const TerrainHeightSettings& someHeightSettings, const CommonUtilities::Vector3<float>& aTerrainPosition,
+    const TerrainImpostorSettings& someSettings)
+    : mySettings(someSettings)
+    , myHeightFunction(std::make_shared<TerrainHeightFunction>(someHeightSettings))
+    , myTerrainPosition(aTerrainPosition)
+{
+}
+TerrainImpostor::~TerrainImpostor()
+{
+    // The bake holds on to the height function through its own shared_ptr, but don't leave it running past shutdown
+    if (myPendingBake.valid())
+    {
+        myPendingBake.wait();
+    }
+}
+bool TerrainImpostor::Initialize(ID3D11Device* aDevice)
+{
+    if (!Object3D::Initialize(aDevice))
+    {
+        return false;
+    }
+
+    // The first panorama is baked up front from wherever the ring was placed, so the horizon is never empty
+    myBakedCameraPosition = myPosition;
+    const TerrainPanorama panorama = BakeTerrainPanorama(*myHeightFunction, mySettings, myTerrainPosition, myBakedCameraPosition);
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = panorama.width;
+    textureDesc.Height = panorama.height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = panorama.texels.data();
+    initData.SysMemPitch = panorama.width * 4;
+
+    HRESULT hr = aDevice->CreateTexture2D(&textureDesc, &initData, &myPanoramaTexture);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create terrain impostor texture. Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+
+    ComPtr<ID3D11ShaderResourceView> panoramaSRV;
+    hr = aDevice->CreateShaderResourceView(myPanoramaTexture.Get(), nullptr, &panoramaSRV);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create terrain impostor SRV. Error: " << std::hex << hr << std::endl;
+        return false;
+    }
+    SetTexture(panoramaSRV.Get());
+
+    return true;
+}
+bool TerrainImpostor::InitObjectResources()
+{
+    SetVertexShaderPath("Impostor_VS.cso");
+    SetPixelShaderPath("Impostor_PS.cso");
+    return true;
+}
+void TerrainImpostor::CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+{
+    // Open cylinder around the origin, its walls span the panorama's slope range
+    const float radius = mySettings.ringRadius;
+    const float top = radius * mySettings.maxTangent;
+    const float bottom = radius * mySettings.minTangent;
+
+    for (int segment = 0; segment <= mySettings.ringSegments; ++segment)
+    {
+        const float u = static_cast<float>(segment) / static_cast<float>(mySettings.ringSegments);
+        const float x = std::cos(u * 2.0f * locPi) * radius;
+        const float z = std::sin(u * 2.0f * locPi) * radius;
+
+        someVertices.push_back({ x, top, z, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, u, 0.0f });
+        someVertices.push_back({ x, bottom, z, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, u, 1.0f });
+    }
+
+    for (int segment = 0; segment < mySettings.ringSegments; ++segment)
+    {
+        const UINT top0 = segment * 2;
+        const UINT bottom0 = top0 + 1;
+        const UINT top1 = top0 + 2;
+        const UINT bottom1 = top0 + 3;
+
+        // Faces the inside of the ring
+        someIndices.insert(someIndices.end(), { bottom0, top0, top1, bottom0, top1, bottom1 });
+    }
+}
+std::string TerrainImpostor::GetGeometryKey() const
+{
+    return "TerrainImpostorRing:" + std::to_string(mySettings.ringRadius) + ":" + std::to_string(mySettings.ringSegments) + ":" +
+        std::to_string(mySettings.minTangent) + ":" + std::to_string(mySettings.maxTangent);
+}
+const VertexFormatDesc& TerrainImpostor::GetVertexFormat() const
+{
+    return GetVertexFormatDesc<PositionTexCoordVertexFormat>();
+}
+void TerrainImpostor::Update(const CommonUtilities::Vector3<float>& aCameraPosition)
+{
+    // The ring travels with the camera, the panorama only has to catch up once the parallax would show
+    SetPosition(aCameraPosition);
+
+    if (myPendingBake.valid())
+    {
+        return;
+    }
+
+    const CommonUtilities::Vector3<float> travelled = aCameraPosition - myBakedCameraPosition;
+    if (travelled.LengthSqr() > mySettings.rebakeDistance * mySettings.rebakeDistance)
+    {
+        StartBake(aCameraPosition);
+    }
+}
+void TerrainImpostor::UploadFinishedBake(ID3D11DeviceContext* aContext)
+{
+    if (myPendingBake.valid() && myPendingBake.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        const TerrainPanorama panorama = myPendingBake.get();
+        aContext->UpdateSubresource(myPanoramaTexture.Get(), 0, nullptr, panorama.texels.data(), panorama.width * 4, 0);
+    }
+}
+void TerrainImpostor::StartBake(const CommonUtilities::Vector3<float>& aCameraPosition)
+{
+    myBakedCameraPosition = aCameraPosition;
+    myPendingBake = std::async(std::launch::async,
+        [heightFunction = myHeightFunction, settings = mySettings, terrainPosition = myTerrainPosition, eye = aCameraPosition]()
+        {
+            return BakeTerrainPanorama(*heightFunction, settings, terrainPosition, eye);
+        });
+}
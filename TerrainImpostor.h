@@ -0,0 +1,69 @@
+#pragma once
+#include <future>
+#include <memory>
+
+#include "Object3D.h"
+#include "TerrainHeight.h"
+
+struct TerrainImpostorSettings
+{
+    int columnCount = 1024;         // Panorama texels around the horizon
+    int rowCount = 128;             // Panorama texels from minTangent to maxTangent
+    float minTangent = -0.6f;       // Lowest view slope the ring covers
+    float maxTangent = 0.4f;        // Highest view slope the ring covers
+    float meshedSize = 0.0f;        // Side of the meshed grid from the terrain position, the bake skips over it
+    float nearestDistance = 1.0f;   // First march sample from the eye
+    float outerRadius = 20000.0f;   // How far out the horizon is traced
+    float stepGrowth = 0.01f;       // Each march step is this fraction of the distance travelled
+    float hazeDistance = 6000.0f;   // Distance where half of the terrain color has faded into the sky
+    float ringRadius = 900.0f;      // Must stay inside the camera's far plane
+    int ringSegments = 48;
+    float rebakeDistance = 64.0f;   // Camera travel that triggers a background re-bake
+};
+
+// RGBA8 cylindrical panorama of the terrain around anEye, rows top to bottom and columns counterclockwise from +x.
+// rgb is the terrain albedo, a is 0 for sky and otherwise the fraction of the color that survives the haze.
+struct TerrainPanorama
+{
+    int width = 0;
+    int height = 0;
+    CommonUtilities::Vector3<float> eye;
+    std::vector<unsigned char> texels;
+};
+
+// Traces the silhouette and color of the terrain placed at aTerrainPosition as seen from the world space anEye.
+// Columns are split across threads and each marches front to back filling the panorama bottom-up,
+// so the cost is columns * march steps no matter how far out the horizon is.
+TerrainPanorama BakeTerrainPanorama(const TerrainHeightFunction& aHeightFunction, const TerrainImpostorSettings& someSettings,
+    const CommonUtilities::Vector3<float>& aTerrainPosition, const CommonUtilities::Vector3<float>& anEye);
+
+// Stand-in for the terrain beyond the meshed grid: a ring of quads around the camera textured with a baked panorama.
+// The panorama is re-baked on a background thread once the camera has moved rebakeDistance from the last bake.
+class TerrainImpostor : public Object3D
+{
+public:
+    TerrainImpostor(const TerrainHeightSettings& someHeightSettings, const CommonUtilities::Vector3<float>& aTerrainPosition,
+        const TerrainImpostorSettings& someSettings = TerrainImpostorSettings());
+    ~TerrainImpostor() override;
+
+    bool Initialize(ID3D11Device* aDevice) override;
+    bool InitObjectResources() override;
+    void CreateGeometry(std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices) override;
+    std::string GetGeometryKey() const override;
+    const VertexFormatDesc& GetVertexFormat() const override;
+
+    void Update(const CommonUtilities::Vector3<float>& aCameraPosition);
+    // Copies a finished bake into the panorama texture, on the thread that owns aContext before the impostor is recorded
+    void UploadFinishedBake(ID3D11DeviceContext* aContext);
+    const TerrainImpostorSettings& GetSettings() const { return mySettings; }
+
+private:
+    void StartBake(const CommonUtilities::Vector3<float>& aCameraPosition);
+
+    TerrainImpostorSettings mySettings;
+    std::shared_ptr<const TerrainHeightFunction> myHeightFunction;
+    CommonUtilities::Vector3<float> myTerrainPosition;
+    CommonUtilities::Vector3<float> myBakedCameraPosition;
+    std::future<TerrainPanorama> myPendingBake;
+    ComPtr<ID3D11Texture2D> myPanoramaTexture;
+};
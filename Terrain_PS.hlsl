@@ -4,13 +4,7 @@
 PixelOutput main(PixelInputType input)
 {
     PixelOutput result;
-    
-    float waterHeightOffset = 0.099f;
-
-    if (input.worldPosition.y < waterHeight - waterHeightOffset)
-    {
-        clip(-1);
-    }
+    ApplyBakedTerrainNormal(input);
 
     float2 scaledUV = input.uv;
 	
@@ -111,6 +105,7 @@ PixelOutput main(PixelInputType input)
     float blendedAO = grassAO * grassWeight +
                       rockAO * rockWeight +
                       snowAO * snowWeight;
+    blendedAO *= input.color.r; // Baked horizon occlusion from Terrain::CreateGeometry
 
     float3 blendedNormal = normalize(grassNormal * grassWeight +
                                      rockNormal * rockWeight +
@@ -125,7 +120,7 @@ PixelOutput main(PixelInputType input)
 		blendedAO, diffuseColor, specularColor
 	);
 
-    float3 directionalLightColorAndIntensity = directionalLightColor * directionalLightIntensity;
+    float3 directionalLightColorAndIntensity = directionalLightColor * directionalLightIntensity * SampleSunVisibility(input.uv);
 
     float3 directionalLight = EvaluateDirectionalLight(
 		diffuseColor, specularColor, blendedNormal, blendedRoughness,
@@ -4,6 +4,7 @@
 PixelOutput main(PixelInputType input) // Specular only, no diffuse
 {
     PixelOutput result;
+    ApplyBakedTerrainNormal(input);
 
     float2 scaledUV = input.uv;
 	
@@ -104,6 +105,7 @@ PixelOutput main(PixelInputType input) // Specular only, no diffuse
     float blendedAO = grassAO * grassWeight +
                       rockAO * rockWeight +
                       snowAO * snowWeight;
+    blendedAO *= input.color.r; // Baked horizon occlusion from Terrain::CreateGeometry
 
     float3 blendedNormal = normalize(grassNormal * grassWeight +
                                      rockNormal * rockWeight +
@@ -117,7 +119,7 @@ PixelOutput main(PixelInputType input) // Specular only, no diffuse
 		toEye, blendedRoughness,
 		blendedAO, diffuseColor, specularColor);
        
-    float3 directionalLightColorAndIntensity = directionalLightColor * directionalLightIntensity;
+    float3 directionalLightColorAndIntensity = directionalLightColor * directionalLightIntensity * SampleSunVisibility(input.uv);
 
     float3 directionalLight = EvaluateDirectionalLight(
 		diffuseColor, specularColor, blendedNormal, blendedRoughness,
@@ -0,0 +1,142 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ConstantRingAllocator.h"
+
+TEST(AllocationsAreAlignedAndPacked)
+{
+    ConstantRingAllocator ring;
+    ring.Init(1024, 256);
+    ConstantRingAllocation allocation;
+
+    // The first allocation always discards, a dynamic buffer starts out without memory
+    CHECK(ring.Allocate(96, allocation));
+    CHECK(allocation.offset == 0 && allocation.isDiscard);
+    CHECK(ring.Allocate(300, allocation));
+    CHECK(allocation.offset == 256 && !allocation.isDiscard);
+    CHECK(ring.GetUsedBytes() == 768);
+    CHECK(ring.GetDiscardCount() == 0);
+
+    CHECK(!ring.Allocate(0, allocation));
+    CHECK(!ring.Allocate(2048, allocation));
+}
+
+TEST(AllocationsWrapOnceOlderFramesRetire)
+{
+    ConstantRingAllocator ring;
+    ring.Init(1024, 256);
+    ConstantRingAllocation allocation;
+
+    ring.Allocate(512, allocation);
+    ring.EndFrame(1);
+    ring.Allocate(256, allocation);
+    CHECK(allocation.offset == 512);
+    ring.EndFrame(2);
+    ring.Retire(1);
+    CHECK(ring.GetFramesInFlight() == 1);
+    CHECK(ring.GetUsedBytes() == 256);
+
+    // Doesn't fit behind frame 2, the last 256 bytes are skipped and it goes to the front
+    CHECK(ring.Allocate(512, allocation));
+    CHECK(allocation.offset == 0 && !allocation.isDiscard);
+    CHECK(ring.GetUsedBytes() == 1024);
+    ring.EndFrame(3);
+
+    ring.Retire(3);
+    CHECK(ring.GetFramesInFlight() == 0);
+    CHECK(ring.GetUsedBytes() == 0);
+}
+
+TEST(FramesRetireUpToTheCompletedFence)
+{
+    ConstantRingAllocator ring;
+    ring.Init(4096, 256);
+    ConstantRingAllocation allocation;
+
+    for (uint64_t fence = 1; fence <= 4; ++fence)
+    {
+        ring.Allocate(256, allocation);
+        ring.EndFrame(fence);
+    }
+    // Frames without allocations aren't tracked
+    ring.EndFrame(5);
+    CHECK(ring.GetFramesInFlight() == 4);
+
+    ring.Retire(0);
+    CHECK(ring.GetFramesInFlight() == 4);
+    ring.Retire(2);
+    CHECK(ring.GetFramesInFlight() == 2);
+    CHECK(ring.GetUsedBytes() == 512);
+    ring.Retire(5);
+    CHECK(ring.GetFramesInFlight() == 0);
+    CHECK(ring.GetUsedBytes() == 0);
+}
+
+TEST(FullRingFallsBackToDiscard)
+{
+    ConstantRingAllocator ring;
+    ring.Init(1024, 256);
+    ConstantRingAllocation allocation;
+
+    ring.Allocate(768, allocation);
+    ring.EndFrame(1);
+    ring.Allocate(256, allocation);
+    ring.EndFrame(2);
+
+    // Both frames are still in flight, so the only room left is fresh memory
+    CHECK(ring.Allocate(16, allocation));
+    CHECK(allocation.offset == 0 && allocation.isDiscard);
+    CHECK(ring.GetDiscardCount() == 1);
+    CHECK(ring.GetFramesInFlight() == 0);
+    CHECK(ring.GetUsedBytes() == 256);
+
+    // After the discard allocation carries on behind it
+    CHECK(ring.Allocate(16, allocation));
+    CHECK(allocation.offset == 256 && !allocation.isDiscard);
+}
+
+TEST(InFlightRangesNeverOverlap)
+{
+    struct Range
+    {
+        uint32_t offset;
+        uint32_t size;
+        uint64_t fence;
+    };
+
+    // The GPU lags two frames behind, nothing it may still read can be handed out again without a discard
+    ConstantRingAllocator ring;
+    ring.Init(64 * 1024, 256);
+    std::vector<Range> inFlight;
+    uint32_t seed = 1;
+    auto random = [&seed]() { seed = seed * 1103515245 + 12345; return seed >> 8; };
+
+    for (uint64_t frame = 1; frame <= 2000; ++frame)
+    {
+        const uint32_t allocationCount = random() % 40;
+        for (uint32_t i = 0; i < allocationCount; ++i)
+        {
+            const uint32_t size = 16 + random() % 700;
+            ConstantRingAllocation allocation;
+            CHECK(ring.Allocate(size, allocation));
+            if (allocation.isDiscard)
+            {
+                inFlight.clear();
+            }
+            for (const Range& range : inFlight)
+            {
+                CHECK(allocation.offset + size <= range.offset || range.offset + range.size <= allocation.offset);
+            }
+            inFlight.push_back({ allocation.offset, (size + 255) & ~255u, frame });
+        }
+
+        ring.EndFrame(frame);
+        if (frame > 2)
+        {
+            ring.Retire(frame - 2);
+            inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(), [frame](const Range& aRange) { return aRange.fence <= frame - 2; }), inFlight.end());
+        }
+    }
+}
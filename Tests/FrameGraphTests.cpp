@@ -0,0 +1,111 @@
+#include "Test.h"
+
+#include <string>
+
+#include "FrameGraph.h"
+
+namespace
+{
+    const FrameGraphTextureDesc locColorDesc = { 1280, 720, 28, FrameGraphUsageRenderTarget | FrameGraphUsageShaderResource };
+    const FrameGraphTextureDesc locDepthDesc = { 1280, 720, 40, FrameGraphUsageDepthStencil };
+}
+
+TEST(PassesNobodyReadsAreCulled)
+{
+    FrameGraph graph;
+    std::vector<std::string> executed;
+    const FrameGraphResource backBuffer = graph.ImportTexture("BackBuffer");
+
+    FrameGraphPassBuilder shadow = graph.AddPass("Shadow");
+    shadow.Create("ShadowMap", locDepthDesc);
+    shadow.SetExecute([&executed]() { executed.push_back("Shadow"); });
+
+    // Feeds only the culled pass after it, so it goes too
+    FrameGraphPassBuilder blurSource = graph.AddPass("BlurSource");
+    const FrameGraphResource source = blurSource.Create("Source", locColorDesc);
+    blurSource.SetExecute([&executed]() { executed.push_back("BlurSource"); });
+    FrameGraphPassBuilder blur = graph.AddPass("Blur");
+    blur.Read(source);
+    blur.Create("Blurred", locColorDesc);
+    blur.SetExecute([&executed]() { executed.push_back("Blur"); });
+
+    FrameGraphPassBuilder main = graph.AddPass("Main");
+    main.Create("Depth", locDepthDesc);
+    main.Write(backBuffer);
+    main.SetExecute([&executed]() { executed.push_back("Main"); });
+
+    CHECK(graph.Compile());
+    CHECK(graph.GetCulledPassCount() == 3);
+    CHECK(graph.IsPassCulled(0) && graph.IsPassCulled(1) && graph.IsPassCulled(2));
+    CHECK(!graph.IsPassCulled(3));
+    // Only the main pass's depth needs memory
+    CHECK(graph.GetPhysicalTextures().size() == 1);
+    CHECK(graph.GetPhysicalTexture(source) == locNoPhysicalTexture);
+
+    graph.Execute();
+    CHECK(executed.size() == 1 && executed[0] == "Main");
+}
+
+TEST(DisjointLifetimesShareATexture)
+{
+    FrameGraph graph;
+    const FrameGraphResource backBuffer = graph.ImportTexture("BackBuffer");
+
+    // First lives over passes 0-1, second over passes 2-3
+    FrameGraphPassBuilder drawFirst = graph.AddPass("DrawFirst");
+    const FrameGraphResource first = drawFirst.Create("First", locColorDesc);
+    FrameGraphPassBuilder resolveFirst = graph.AddPass("ResolveFirst");
+    resolveFirst.Read(first);
+    resolveFirst.Write(backBuffer);
+
+    FrameGraphPassBuilder drawSecond = graph.AddPass("DrawSecond");
+    const FrameGraphResource second = drawSecond.Create("Second", locColorDesc);
+    FrameGraphPassBuilder resolveSecond = graph.AddPass("ResolveSecond");
+    resolveSecond.Read(second);
+    resolveSecond.Write(backBuffer);
+
+    CHECK(graph.Compile());
+    CHECK(graph.GetCulledPassCount() == 0);
+    CHECK(graph.GetPhysicalTexture(first) != locNoPhysicalTexture);
+    CHECK(graph.GetPhysicalTexture(first) == graph.GetPhysicalTexture(second));
+    CHECK(graph.GetPhysicalTextures().size() == 1);
+    CHECK(graph.GetPhysicalTexture(backBuffer) == locNoPhysicalTexture);
+}
+
+TEST(OverlappingOrDifferentTexturesDontShare)
+{
+    FrameGraph graph;
+    const FrameGraphResource backBuffer = graph.ImportTexture("BackBuffer");
+
+    FrameGraphPassBuilder drawBoth = graph.AddPass("DrawBoth");
+    const FrameGraphResource color = drawBoth.Create("Color", locColorDesc);
+    const FrameGraphResource bloom = drawBoth.Create("Bloom", locColorDesc);
+    FrameGraphPassBuilder composite = graph.AddPass("Composite");
+    composite.Read(color);
+    composite.Read(bloom);
+    composite.Write(backBuffer);
+
+    // Starts after both are done but has another desc
+    FrameGraphPassBuilder overlay = graph.AddPass("Overlay");
+    const FrameGraphResource depth = overlay.Create("OverlayDepth", locDepthDesc);
+    overlay.Write(backBuffer);
+
+    CHECK(graph.Compile());
+    CHECK(graph.GetPhysicalTexture(color) != graph.GetPhysicalTexture(bloom));
+    CHECK(graph.GetPhysicalTexture(depth) != graph.GetPhysicalTexture(color));
+    CHECK(graph.GetPhysicalTexture(depth) != graph.GetPhysicalTexture(bloom));
+    CHECK(graph.GetPhysicalTextures().size() == 3);
+    CHECK(graph.GetPhysicalTextures()[graph.GetPhysicalTexture(depth)] == locDepthDesc);
+}
+
+TEST(ReadingAnUnwrittenTextureFails)
+{
+    FrameGraph graph;
+    FrameGraphPassBuilder early = graph.AddPass("Early");
+    FrameGraphPassBuilder late = graph.AddPass("Late");
+    const FrameGraphResource texture = late.Create("Texture", locColorDesc);
+    early.Read(texture);
+    early.Write(graph.ImportTexture("BackBuffer"));
+
+    CHECK(!graph.Compile());
+}
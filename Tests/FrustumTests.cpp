@@ -0,0 +1,128 @@
+#include "Test.h"
+
+#include <cmath>
+
+#include "Frustum.h"
+
+namespace
+{
+    using Matrix = CommonUtilities::Matrix4x4<float>;
+    using Vector3 = CommonUtilities::Vector3<float>;
+    using Vector4 = CommonUtilities::Vector4<float>;
+
+    constexpr float locWaterHeight = 50.0f;
+
+    // Left handed, depth to [0, 1], row vectors, like the camera's
+    Matrix CreatePerspective(float aFovY, float anAspectRatio, float aNear, float aFar)
+    {
+        Matrix projection;
+        const float yScale = 1.0f / std::tan(aFovY * 0.5f);
+        projection(1, 1) = yScale / anAspectRatio;
+        projection(2, 2) = yScale;
+        projection(3, 3) = aFar / (aFar - aNear);
+        projection(3, 4) = 1.0f;
+        projection(4, 3) = -aNear * aFar / (aFar - aNear);
+        projection(4, 4) = 0.0f;
+        return projection;
+    }
+
+    // Camera at aPosition looking along +z, pitched up by aPitch
+    Matrix CreateView(const Vector3& aPosition, float aPitch)
+    {
+        Matrix cameraToWorld;
+        cameraToWorld(2, 2) = std::cos(aPitch);
+        cameraToWorld(2, 3) = -std::sin(aPitch);
+        cameraToWorld(3, 2) = std::sin(aPitch);
+        cameraToWorld(3, 3) = std::cos(aPitch);
+        cameraToWorld(4, 1) = aPosition.x;
+        cameraToWorld(4, 2) = aPosition.y;
+        cameraToWorld(4, 3) = aPosition.z;
+        return Matrix::GetFastInverse(cameraToWorld);
+    }
+
+    Vector4 ToClip(const Vector3& aPoint, const Matrix& aWorldToClip)
+    {
+        return Vector4(aPoint.x, aPoint.y, aPoint.z, 1.0f) * aWorldToClip;
+    }
+
+    bool IsInsideClip(const Vector4& aClip)
+    {
+        return std::fabs(aClip.x) <= aClip.w && std::fabs(aClip.y) <= aClip.w && aClip.z >= 0.0f && aClip.z <= aClip.w;
+    }
+}
+
+TEST(PlanesMatchTheClipVolume)
+{
+    const Matrix worldToClip = CreateView(Vector3(0.0f, 10.0f, 0.0f), 0.0f) * CreatePerspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const Frustum frustum = Frustum::FromWorldToClip(worldToClip);
+
+    // Every plane keeps a point in view and is normalized so distances are in world units
+    const Vector3 inView(0.0f, 10.0f, 100.0f);
+    for (int side = 0; side < Frustum::SideCount; ++side)
+    {
+        const FrustumPlane& plane = frustum.GetPlane(static_cast<Frustum::Side>(side));
+        CHECK(plane.GetSignedDistance(inView) > 0.0f);
+        CHECK_NEAR(plane.normal.Length(), 1.0f, 1e-4f);
+    }
+    CHECK_NEAR(frustum.GetPlane(Frustum::Near).GetSignedDistance(Vector3(0.0f, 10.0f, 5.0f)), 4.9f, 1e-3f);
+    // w - z cancels most of the far plane's normal in float, it is only good to a tenth of a unit
+    CHECK_NEAR(frustum.GetPlane(Frustum::Far).GetSignedDistance(Vector3(0.0f, 10.0f, 900.0f)), 100.0f, 0.1f);
+    CHECK(frustum.GetPlane(Frustum::Left).normal.x > 0.0f);
+    CHECK(frustum.GetPlane(Frustum::Right).normal.x < 0.0f);
+    CHECK(frustum.GetPlane(Frustum::Bottom).normal.y > 0.0f);
+    CHECK(frustum.GetPlane(Frustum::Top).normal.y < 0.0f);
+
+    CHECK(frustum.IntersectsSphere(inView, 1.0f));
+    CHECK(!frustum.IntersectsSphere(Vector3(0.0f, 10.0f, -20.0f), 5.0f));
+    CHECK(!frustum.IntersectsSphere(Vector3(0.0f, 10.0f, 1100.0f), 5.0f));
+    CHECK(!frustum.IntersectsSphere(Vector3(500.0f, 10.0f, 100.0f), 5.0f));
+    CHECK(frustum.IntersectsSphere(Vector3(0.0f, 10.0f, -4.0f), 5.0f));
+}
+
+TEST(PlaneToViewKeepsDistances)
+{
+    const Vector3 cameraPosition(3.0f, 70.0f, -20.0f);
+    const Matrix view = CreateView(cameraPosition, 0.4f);
+    const Vector4 viewPlane = TransformPlaneToView(Vector4(0.0f, 1.0f, 0.0f, -locWaterHeight), view);
+
+    // The camera sits at the view space origin, the plane's distance there is the camera's height over the water
+    CHECK_NEAR(viewPlane.w, cameraPosition.y - locWaterHeight, 1e-4f);
+
+    // Any world point is as far from the plane in view space as in world space
+    const Vector3 point(-12.0f, 35.0f, 80.0f);
+    const Vector4 viewPoint = Vector4(point.x, point.y, point.z, 1.0f) * view;
+    const float viewDistance = viewPlane.x * viewPoint.x + viewPlane.y * viewPoint.y + viewPlane.z * viewPoint.z + viewPlane.w;
+    CHECK_NEAR(viewDistance, point.y - locWaterHeight, 1e-3f);
+}
+
+TEST(ObliqueProjectionClipsBelowTheWater)
+{
+    // The reflected camera, under the water looking up at what is above it
+    const float pitch = 0.5f;
+    const Vector3 cameraPosition(0.0f, 2.0f * locWaterHeight - 100.0f, 0.0f);
+    const Matrix view = CreateView(cameraPosition, pitch);
+    const Matrix projection = CreatePerspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const Vector4 viewPlane = TransformPlaneToView(Vector4(0.0f, 1.0f, 0.0f, -locWaterHeight), view);
+    CHECK(viewPlane.w < 0.0f);
+
+    const Matrix worldToClip = view * MakeObliqueProjection(projection, viewPlane);
+    CHECK(IsInsideClip(ToClip(Vector3(0.0f, locWaterHeight + 1.0f, 150.0f), worldToClip)));
+    CHECK(ToClip(Vector3(0.0f, locWaterHeight - 1.0f, 150.0f), worldToClip).z < 0.0f);
+
+    // The far end of the view stays in front of the tilted far plane
+    const Vector3 forward(0.0f, std::sin(pitch), std::cos(pitch));
+    const Vector4 farPoint = ToClip(cameraPosition + forward * 900.0f, worldToClip);
+    CHECK(farPoint.z <= farPoint.w);
+
+    // Culling against the oblique matrix uses the water as its near plane
+    const Frustum frustum = Frustum::FromWorldToClip(worldToClip);
+    const FrustumPlane& nearPlane = frustum.GetPlane(Frustum::Near);
+    CHECK_NEAR(nearPlane.normal.y, 1.0f, 1e-3f);
+    CHECK_NEAR(nearPlane.distance, -locWaterHeight, 1e-2f);
+    CHECK(!frustum.IntersectsSphere(Vector3(0.0f, locWaterHeight - 10.0f, 150.0f), 5.0f));
+    CHECK(frustum.IntersectsSphere(Vector3(0.0f, locWaterHeight + 10.0f, 150.0f), 5.0f));
+    CHECK(frustum.IntersectsSphere(Vector3(0.0f, locWaterHeight - 4.0f, 150.0f), 5.0f));
+
+    // The plain projection would have kept the underwater sphere
+    CHECK(Frustum::FromWorldToClip(view * projection).IntersectsSphere(Vector3(0.0f, locWaterHeight - 10.0f, 150.0f), 5.0f));
+}
@@ -0,0 +1,138 @@
+#include "Test.h"
+
+#include <string>
+
+#include "InstanceSubmission.h"
+
+namespace
+{
+    // Stands in for the immediate context, keeps what was uploaded and the order of the calls
+    struct RecordingContext
+    {
+        HRESULT Map(ID3D11Buffer* aBuffer, UINT, D3D11_MAP aMapType, UINT, D3D11_MAPPED_SUBRESOURCE* aMappedResource)
+        {
+            calls += "Map ";
+            mappedBuffer = aBuffer;
+            mapType = aMapType;
+            memory.assign(1024, CommonUtilities::Matrix4x4<float>());
+            aMappedResource->pData = memory.data();
+            return failMap ? -1 : 0;
+        }
+        void Unmap(ID3D11Buffer*, UINT)
+        {
+            calls += "Unmap ";
+        }
+
+        std::string calls;
+        ID3D11Buffer* mappedBuffer = nullptr;
+        D3D11_MAP mapType = D3D11_MAP_READ;
+        std::vector<CommonUtilities::Matrix4x4<float>> memory;
+        bool failMap = false;
+    };
+
+    CommonUtilities::Matrix4x4<float> CreateTranslation(float anX)
+    {
+        CommonUtilities::Matrix4x4<float> transform;
+        transform(4, 1) = anX;
+        return transform;
+    }
+
+    ID3D11Buffer* const locInstanceBuffer = reinterpret_cast<ID3D11Buffer*>(0x10);
+}
+
+TEST(BatchesGroupEqualKeysInSubmissionOrder)
+{
+    int sphere = 0;
+    int cube = 0;
+    InstanceBatcher batcher;
+    for (int i = 0; i < 6; ++i)
+    {
+        batcher.Add({ i % 2 == 0 ? &sphere : &cube }, CreateTranslation(static_cast<float>(i)), i);
+    }
+    batcher.Build();
+
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    CHECK(batches.size() == 2);
+    for (const InstanceBatch& batch : batches)
+    {
+        CHECK(batch.instanceCount == 3);
+        const float firstObject = batch.key.geometry == &sphere ? 0.0f : 1.0f;
+        CHECK(batch.objectIndex == static_cast<size_t>(firstObject));
+        for (unsigned int i = 0; i < batch.instanceCount; ++i)
+        {
+            CHECK(batcher.GetTransforms()[batch.firstInstance + i](4, 1) == firstObject + 2.0f * i);
+        }
+    }
+}
+
+TEST(BatchesSplitAtTheInstanceLimit)
+{
+    int geometry = 0;
+    InstanceBatcher batcher;
+    for (int i = 0; i < 7; ++i)
+    {
+        batcher.Add({ &geometry }, CreateTranslation(static_cast<float>(i)), i);
+    }
+    batcher.Build(3);
+
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    CHECK(batches.size() == 3);
+    CHECK(batches[0].firstInstance == 0 && batches[0].instanceCount == 3);
+    CHECK(batches[1].firstInstance == 3 && batches[1].instanceCount == 3 && batches[1].objectIndex == 3);
+    CHECK(batches[2].firstInstance == 6 && batches[2].instanceCount == 1 && batches[2].objectIndex == 6);
+}
+
+TEST(SubmitUploadsOnceThenDrawsEveryBatch)
+{
+    int sphere = 0;
+    int cube = 0;
+    InstanceBatcher batcher;
+    for (int i = 0; i < 7; ++i)
+    {
+        batcher.Add({ i % 3 == 0 ? &cube : &sphere }, CreateTranslation(static_cast<float>(i)), i);
+    }
+    batcher.Build(2);
+
+    RecordingContext context;
+    std::vector<InstanceBatch> drawn;
+    const bool submitted = SubmitInstanceBatches(context, locInstanceBuffer, batcher, [&](const InstanceBatch& aBatch)
+    {
+        context.calls += "Draw ";
+        drawn.push_back(aBatch);
+    });
+
+    CHECK(submitted);
+    CHECK(context.calls == "Map Unmap Draw Draw Draw Draw ");
+    CHECK(context.mappedBuffer == locInstanceBuffer);
+    CHECK(context.mapType == D3D11_MAP_WRITE_DISCARD);
+    CHECK(drawn.size() == batcher.GetBatches().size());
+    for (size_t i = 0; i < batcher.GetTransforms().size(); ++i)
+    {
+        CHECK(context.memory[i](4, 1) == batcher.GetTransforms()[i](4, 1));
+    }
+}
+
+TEST(SubmitSkipsDrawsWhenTheMapFails)
+{
+    int geometry = 0;
+    InstanceBatcher batcher;
+    batcher.Add({ &geometry }, CreateTranslation(1.0f), 0);
+    batcher.Build();
+
+    RecordingContext context;
+    context.failMap = true;
+    int drawCount = 0;
+    CHECK(!SubmitInstanceBatches(context, locInstanceBuffer, batcher, [&](const InstanceBatch&) { ++drawCount; }));
+    CHECK(drawCount == 0);
+    CHECK(context.calls == "Map ");
+}
+
+TEST(SubmitWithoutInstancesTouchesNothing)
+{
+    InstanceBatcher batcher;
+    batcher.Build();
+
+    RecordingContext context;
+    CHECK(SubmitInstanceBatches(context, locInstanceBuffer, batcher, [](const InstanceBatch&) {}));
+    CHECK(context.calls.empty());
+}
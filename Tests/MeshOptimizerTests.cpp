@@ -0,0 +1,99 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <array>
+
+#include "MeshOptimizer.h"
+
+namespace
+{
+    // aSize x aSize quads in rows, the order a heightfield is usually generated in
+    void CreateGrid(int aSize, std::vector<Vertex>& someVertices, std::vector<UINT>& someIndices)
+    {
+        const int rowLength = aSize + 1;
+        someVertices.assign(rowLength * rowLength, Vertex{});
+        for (int z = 0; z < rowLength; ++z)
+        {
+            for (int x = 0; x < rowLength; ++x)
+            {
+                Vertex& vertex = someVertices[z * rowLength + x];
+                vertex.x = static_cast<float>(x);
+                vertex.z = -static_cast<float>(z);
+                vertex.ny = 1.0f;
+            }
+        }
+
+        someIndices.clear();
+        for (int z = 0; z < aSize; ++z)
+        {
+            for (int x = 0; x < aSize; ++x)
+            {
+                const UINT topLeft = z * rowLength + x;
+                const UINT bottomLeft = topLeft + rowLength;
+                someIndices.insert(someIndices.end(), { topLeft, bottomLeft, topLeft + 1, topLeft + 1, bottomLeft, bottomLeft + 1 });
+            }
+        }
+    }
+
+    // Triangles by position, sorted, so two index buffers can be compared regardless of order and numbering
+    std::vector<std::array<float, 9>> GetSortedTriangles(const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices)
+    {
+        std::vector<std::array<float, 9>> triangles;
+        for (size_t i = 0; i < someIndices.size(); i += 3)
+        {
+            std::array<float, 9> triangle;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const Vertex& vertex = someVertices[someIndices[i + corner]];
+                triangle[corner * 3 + 0] = vertex.x;
+                triangle[corner * 3 + 1] = vertex.y;
+                triangle[corner * 3 + 2] = vertex.z;
+            }
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+TEST(GridAcmrDropsAfterOptimization)
+{
+    std::vector<Vertex> vertices;
+    std::vector<UINT> indices;
+    CreateGrid(256, vertices, indices);
+
+    const MeshOptimizationStats stats = OptimizeMesh(vertices, indices);
+
+    // Row order misses about once per triangle with a 16 entry cache, reordered it should land around 0.68
+    CHECK_NEAR(stats.acmrBefore, 1.0f, 0.02f);
+    CHECK(stats.acmrAfter < 0.75f);
+    CHECK_NEAR(ComputeACMR(indices, vertices.size()), stats.acmrAfter, 1e-5f);
+    CHECK(stats.removedVertices == 0);
+}
+
+TEST(OptimizationKeepsTriangles)
+{
+    std::vector<Vertex> vertices;
+    std::vector<UINT> indices;
+    CreateGrid(32, vertices, indices);
+    const std::vector<std::array<float, 9>> before = GetSortedTriangles(vertices, indices);
+
+    OptimizeMesh(vertices, indices);
+
+    CHECK(GetSortedTriangles(vertices, indices) == before);
+}
+
+TEST(UnreferencedVerticesAreRemoved)
+{
+    std::vector<Vertex> vertices;
+    std::vector<UINT> indices;
+    CreateGrid(4, vertices, indices);
+    vertices.push_back(Vertex{});
+    vertices.push_back(Vertex{});
+
+    const MeshOptimizationStats stats = OptimizeMesh(vertices, indices);
+
+    CHECK(stats.removedVertices == 2);
+    CHECK(vertices.size() == 25);
+    CHECK(*std::max_element(indices.begin(), indices.end()) == 24);
+}
@@ -0,0 +1,140 @@
+#include "Test.h"
+
+#include <cmath>
+
+#include "ReflectionScheduler.h"
+
+namespace
+{
+    ReflectionView CreateView()
+    {
+        ReflectionView view;
+        view.forward = CommonUtilities::Vector3<float>(0.0f, 0.0f, 1.0f);
+        view.timeOfDay = 12.0;
+        return view;
+    }
+
+    // Only the threshold under test can trigger a redraw
+    ReflectionUpdatePolicy CreatePolicyWithoutInterval()
+    {
+        ReflectionUpdatePolicy policy;
+        policy.maxFrameInterval = 1000;
+        return policy;
+    }
+}
+
+TEST(FirstFrameAndInvalidateDraw)
+{
+    ReflectionScheduler scheduler;
+    const ReflectionView view = CreateView();
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::Invalidated);
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+
+    scheduler.Invalidate();
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::Invalidated);
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+}
+
+TEST(StillCameraDrawsEveryInterval)
+{
+    ReflectionScheduler scheduler;
+    ReflectionUpdatePolicy policy;
+    policy.maxFrameInterval = 4;
+    scheduler.SetPolicy(policy);
+
+    const ReflectionView view = CreateView();
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::Invalidated);
+    for (int cycle = 0; cycle < 3; ++cycle)
+    {
+        CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+        CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+        CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+        CHECK(scheduler.Update(view) == ReflectionUpdateReason::Interval);
+    }
+
+    // An interval of one draws every frame
+    policy.maxFrameInterval = 1;
+    scheduler.SetPolicy(policy);
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::Interval);
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::Interval);
+}
+
+TEST(MovementIsMeasuredFromTheLastDrawnView)
+{
+    ReflectionScheduler scheduler;
+    scheduler.SetPolicy(CreatePolicyWithoutInterval());
+
+    ReflectionView view = CreateView();
+    scheduler.Update(view);
+
+    // Small steps add up until they pass maxCameraMovement (0.5)
+    view.position.x += 0.3f;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.position.x += 0.15f;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.position.x += 0.1f;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::CameraMoved);
+
+    // The new view is the reference now
+    view.position.y += 0.45f;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+}
+
+TEST(RotationIsMeasuredFromTheLastDrawnView)
+{
+    ReflectionScheduler scheduler;
+    scheduler.SetPolicy(CreatePolicyWithoutInterval());
+
+    ReflectionView view = CreateView();
+    scheduler.Update(view);
+
+    const float angles[] = { 0.01f, 0.019f, 0.03f };
+    view.forward = CommonUtilities::Vector3<float>(std::sin(angles[0]), 0.0f, std::cos(angles[0]));
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.forward = CommonUtilities::Vector3<float>(std::sin(angles[1]), 0.0f, std::cos(angles[1]));
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.forward = CommonUtilities::Vector3<float>(std::sin(angles[2]), 0.0f, std::cos(angles[2]));
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::CameraRotated);
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+}
+
+TEST(TimeOfDayWrapsAtMidnight)
+{
+    ReflectionScheduler scheduler;
+    scheduler.SetPolicy(CreatePolicyWithoutInterval());
+
+    ReflectionView view = CreateView();
+    view.timeOfDay = 23.97;
+    scheduler.Update(view);
+
+    // Five hundredths of an hour apart across midnight, not 23.95
+    view.timeOfDay = 0.02;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.timeOfDay = 0.09;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::TimeOfDay);
+
+    view.timeOfDay = 0.15;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::None);
+    view.timeOfDay = 0.2;
+    CHECK(scheduler.Update(view) == ReflectionUpdateReason::TimeOfDay);
+}
+
+TEST(StatsCountDrawnAndReusedFrames)
+{
+    ReflectionScheduler scheduler;
+    const ReflectionView view = CreateView();
+    for (int frame = 0; frame < 400; ++frame)
+    {
+        scheduler.Update(view);
+    }
+
+    const ReflectionStats& stats = scheduler.GetStats();
+    CHECK(stats.renderedFrames == 100);
+    CHECK(stats.reusedFrames == 300);
+    CHECK(stats.reasonCounts[static_cast<int>(ReflectionUpdateReason::Invalidated)] == 1);
+    CHECK(stats.reasonCounts[static_cast<int>(ReflectionUpdateReason::Interval)] == 99);
+    CHECK(stats.reasonCounts[static_cast<int>(ReflectionUpdateReason::None)] == 300);
+
+    scheduler.ResetStats();
+    CHECK(scheduler.GetStats().renderedFrames == 0);
+}
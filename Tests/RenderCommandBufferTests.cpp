@@ -0,0 +1,179 @@
+#include "Test.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "RenderCommandBuffer.h"
+#include "StateFilteringContext.h"
+
+namespace
+{
+    // The engine records this many queued objects per job
+    constexpr size_t locObjectsPerJob = 256;
+
+    // Stands in for the device context, writes every call that reaches it into a log
+    struct LogContext
+    {
+        void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY aTopology) { log << "topology " << aTopology << "\n"; }
+        void IASetInputLayout(ID3D11InputLayout* anInputLayout) { log << "layout " << anInputLayout << "\n"; }
+        void IASetVertexBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const* someBuffers, const UINT* someStrides, const UINT* someOffsets)
+        {
+            log << "vertices " << aStartSlot << " " << aCount << " " << someBuffers[0] << " " << someStrides[0] << " " << someOffsets[0] << "\n";
+        }
+        void IASetIndexBuffer(ID3D11Buffer* aBuffer, DXGI_FORMAT aFormat, UINT anOffset) { log << "indices " << aBuffer << " " << aFormat << " " << anOffset << "\n"; }
+        void VSSetShader(ID3D11VertexShader* aShader, ID3D11ClassInstance* const*, UINT) { log << "vs " << aShader << "\n"; }
+        void PSSetShader(ID3D11PixelShader* aShader, ID3D11ClassInstance* const*, UINT) { log << "ps " << aShader << "\n"; }
+        void PSSetShaderResources(UINT aStartSlot, UINT aCount, ID3D11ShaderResourceView* const* someViews) { log << "srv " << aStartSlot << " " << aCount << " " << someViews[0] << "\n"; }
+        void DrawIndexed(UINT anIndexCount, UINT aStartIndex, INT aBaseVertex) { log << "draw " << anIndexCount << " " << aStartIndex << " " << aBaseVertex << "\n"; }
+
+        std::ostringstream log;
+    };
+
+    struct TestObject
+    {
+        uintptr_t mesh;
+        uintptr_t shader;
+        uintptr_t texture;
+        float constants[3];
+    };
+
+    template <class T>
+    T* MakeHandle(uintptr_t aKind, uintptr_t anId)
+    {
+        return reinterpret_cast<T*>((aKind << 12) + anId * 16);
+    }
+
+    std::vector<TestObject> CreateObjects(size_t aCount)
+    {
+        std::vector<TestObject> objects;
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            const float value = static_cast<float>(i);
+            objects.push_back({ (i / 7) % 13, (i / 50) % 4, (i / 3) % 5, { value, value * 0.5f, -value } });
+        }
+        return objects;
+    }
+
+    // Records like Object3D::Record: a range starts without knowing what is bound and binds everything on its first
+    // object, later objects only bind what differs from the one before
+    void RecordObjects(RenderCommandBuffer& someCommands, const std::vector<TestObject>& someObjects, size_t aFirst, size_t aLast)
+    {
+        const TestObject* previous = nullptr;
+        for (size_t i = aFirst; i < aLast; ++i)
+        {
+            const TestObject& object = someObjects[i];
+            someCommands.UpdateConstants(1, 1, object.constants, sizeof(object.constants));
+            if (!previous)
+            {
+                someCommands.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            }
+            if (!previous || previous->shader != object.shader)
+            {
+                someCommands.IASetInputLayout(MakeHandle<ID3D11InputLayout>(1, object.shader));
+                someCommands.VSSetShader(MakeHandle<ID3D11VertexShader>(2, object.shader));
+                someCommands.PSSetShader(MakeHandle<ID3D11PixelShader>(3, object.shader));
+            }
+            if (!previous || previous->mesh != object.mesh)
+            {
+                ID3D11Buffer* vertexBuffer = MakeHandle<ID3D11Buffer>(4, object.mesh);
+                const UINT stride = 32;
+                const UINT offset = 0;
+                someCommands.IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+                someCommands.IASetIndexBuffer(MakeHandle<ID3D11Buffer>(5, object.mesh), DXGI_FORMAT_R32_UINT, 0);
+            }
+            if (!previous || previous->texture != object.texture)
+            {
+                ID3D11ShaderResourceView* texture = MakeHandle<ID3D11ShaderResourceView>(6, object.texture);
+                someCommands.PSSetShaderResources(0, 1, &texture);
+            }
+            someCommands.DrawIndexed(36 + static_cast<UINT>(object.mesh), 0, 0);
+            previous = &object;
+        }
+    }
+
+    // What reaches the device when aCommands is replayed through the state filter the engine uses
+    template <class Commands>
+    std::string ReplayToLog(const Commands& someCommands)
+    {
+        LogContext log;
+        StateFilteringContext<LogContext> context;
+        context.SetContext(&log);
+        someCommands.Replay(context, [&log](const UpdateConstantsCommand& aCommand, const void* someData)
+        {
+            float constants[3];
+            std::memcpy(constants, someData, sizeof(constants));
+            log.log << "constants " << aCommand.slot << " " << aCommand.stages << " " << aCommand.size << " "
+                << constants[0] << " " << constants[1] << " " << constants[2] << "\n";
+        });
+        return log.log.str();
+    }
+}
+
+TEST(ParallelReplayMatchesSerialRecording)
+{
+    // Around the job size: one short job, exactly one, one item over, and the same at two jobs
+    const size_t itemCounts[] = { 1, 255, 256, 257, 511, 512, 513, 5000 };
+    // More threads than most of these have jobs, and one pool for every recording the way the engine keeps it
+    WorkerPool pool(3);
+    for (size_t itemCount : itemCounts)
+    {
+        const std::vector<TestObject> objects = CreateObjects(itemCount);
+
+        RenderCommandBuffer serial;
+        RecordObjects(serial, objects, 0, objects.size());
+        const std::string expected = ReplayToLog(serial);
+
+        ParallelRenderCommands parallel;
+        parallel.Record(pool, objects.size(), locObjectsPerJob, [&objects](RenderCommandBuffer& someCommands, size_t aFirst, size_t aLast)
+        {
+            RecordObjects(someCommands, objects, aFirst, aLast);
+        });
+
+        CHECK(parallel.GetJobCount() == (itemCount + locObjectsPerJob - 1) / locObjectsPerJob);
+        CHECK(parallel.GetConstantsCount() == itemCount);
+        CHECK(parallel.GetLargestConstants() == sizeof(TestObject::constants));
+        CHECK(ReplayToLog(parallel) == expected);
+    }
+}
+
+TEST(ConstantsAreVisitedInRecordingOrder)
+{
+    const std::vector<TestObject> objects = CreateObjects(1000);
+    WorkerPool pool(3);
+    ParallelRenderCommands parallel;
+    parallel.Record(pool, objects.size(), locObjectsPerJob, [&objects](RenderCommandBuffer& someCommands, size_t aFirst, size_t aLast)
+    {
+        RecordObjects(someCommands, objects, aFirst, aLast);
+    });
+
+    size_t visited = 0;
+    parallel.ForEachConstants([&visited](const UpdateConstantsCommand& aCommand, const void* someData)
+    {
+        float first;
+        std::memcpy(&first, someData, sizeof(first));
+        CHECK(first == static_cast<float>(visited));
+        CHECK(aCommand.size == sizeof(TestObject::constants));
+        ++visited;
+    });
+    CHECK(visited == objects.size());
+}
+
+TEST(RecordingAgainShrinksTheJobs)
+{
+    const std::vector<TestObject> objects = CreateObjects(600);
+    WorkerPool pool(3);
+    ParallelRenderCommands parallel;
+    auto record = [&objects](RenderCommandBuffer& someCommands, size_t aFirst, size_t aLast) { RecordObjects(someCommands, objects, aFirst, aLast); };
+
+    parallel.Record(pool, 600, locObjectsPerJob, record);
+    CHECK(parallel.GetJobCount() == 3);
+    parallel.Record(pool, 10, locObjectsPerJob, record);
+    CHECK(parallel.GetJobCount() == 1);
+    CHECK(parallel.GetConstantsCount() == 10);
+    CHECK(parallel.GetCommands(0).GetConstantsCount() == 10);
+    parallel.Record(pool, 0, locObjectsPerJob, record);
+    CHECK(parallel.GetJobCount() == 0);
+    CHECK(ReplayToLog(parallel).empty());
+}
@@ -0,0 +1,179 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+
+#include "RenderQueue.h"
+
+namespace
+{
+    bool MatchesStableSort(std::vector<RenderItem> someItems)
+    {
+        std::vector<RenderItem> expected = someItems;
+        std::stable_sort(expected.begin(), expected.end(), [](const RenderItem& aLeft, const RenderItem& aRight) { return aLeft.key < aRight.key; });
+
+        std::vector<RenderItem> buffer;
+        RadixSortRenderItems(someItems, buffer);
+        return std::equal(someItems.begin(), someItems.end(), expected.begin(), expected.end(), [](const RenderItem& aLeft, const RenderItem& aRight)
+        {
+            return aLeft.key == aRight.key && aLeft.objectIndex == aRight.objectIndex;
+        });
+    }
+
+    RenderPass GetPass(const RenderItem& anItem)
+    {
+        return static_cast<RenderPass>(anItem.key >> 60);
+    }
+
+    // A scene with a handful of programs and textures, every tenth draw blended. Depth of draw i is someDepths[i]
+    void FillQueue(RenderQueue& aQueue, std::vector<float>& someDepths)
+    {
+        static int shaders[8];
+        static int textures[32];
+        static int meshes[16];
+
+        std::mt19937 random(7);
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            RenderState state;
+            state.inputLayout = &shaders[i % 8];
+            state.vertexShader = &shaders[i % 8];
+            state.pixelShader = &shaders[(i / 8) % 8];
+            state.texture = &textures[random() % 32];
+            state.geometry = &meshes[random() % 16];
+            const float depth = static_cast<float>(random() % 10000) / 10.0f;
+
+            aQueue.Add(i % 10 == 0 ? RenderPass::Blended : RenderPass::Opaque, aQueue.GetStateIds(state), depth, i);
+            someDepths.push_back(depth);
+        }
+    }
+}
+
+TEST(OpaqueDrawsComeBeforeBlended)
+{
+    RenderQueue queue;
+    std::vector<float> depths;
+    FillQueue(queue, depths);
+    queue.Sort();
+
+    const std::vector<RenderItem>& items = queue.GetItems();
+    CHECK(items.size() == 1000);
+    const auto firstBlended = std::find_if(items.begin(), items.end(), [](const RenderItem& anItem) { return GetPass(anItem) == RenderPass::Blended; });
+    CHECK(firstBlended - items.begin() == 900);
+    CHECK(std::all_of(firstBlended, items.end(), [](const RenderItem& anItem) { return GetPass(anItem) == RenderPass::Blended; }));
+}
+
+TEST(OpaqueDrawsAreGroupedByState)
+{
+    RenderQueue queue;
+    std::vector<float> depths;
+    FillQueue(queue, depths);
+    queue.Sort();
+
+    // Every program is bound once in the opaque pass, and within one full state draws go front to back
+    std::vector<uint64_t> seenPrograms;
+    uint64_t previousState = ~0ull;
+    float previousDepth = 0.0f;
+    for (const RenderItem& item : queue.GetItems())
+    {
+        if (GetPass(item) != RenderPass::Opaque)
+        {
+            break;
+        }
+
+        const uint64_t program = (item.key >> 48) & 0xFFF;
+        if (seenPrograms.empty() || seenPrograms.back() != program)
+        {
+            CHECK(std::find(seenPrograms.begin(), seenPrograms.end(), program) == seenPrograms.end());
+            seenPrograms.push_back(program);
+        }
+
+        const uint64_t state = item.key >> 24;
+        if (state == previousState)
+        {
+            CHECK(depths[item.objectIndex] >= previousDepth);
+        }
+        previousState = state;
+        previousDepth = depths[item.objectIndex];
+    }
+    CHECK(seenPrograms.size() == queue.GetProgramCount());
+}
+
+TEST(BlendedDrawsGoBackToFront)
+{
+    RenderQueue queue;
+    std::vector<float> depths;
+    FillQueue(queue, depths);
+    queue.Sort();
+
+    float previousDepth = 1e9f;
+    for (const RenderItem& item : queue.GetItems())
+    {
+        if (GetPass(item) == RenderPass::Blended)
+        {
+            CHECK(depths[item.objectIndex] <= previousDepth);
+            previousDepth = depths[item.objectIndex];
+        }
+    }
+}
+
+TEST(RadixSortMatchesStableSort)
+{
+    // Few distinct keys, so equal keys have to keep submission order
+    std::mt19937 random(1);
+    std::vector<RenderItem> items;
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        const uint64_t key = (static_cast<uint64_t>(random() % 16) << 56) | (static_cast<uint64_t>(random() % 64) << 20) | (random() % 4);
+        items.push_back({ key, i });
+    }
+    CHECK(MatchesStableSort(items));
+
+    items.clear();
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        items.push_back({ (static_cast<uint64_t>(random()) << 32) | random(), i });
+    }
+    CHECK(MatchesStableSort(items));
+}
+
+TEST(RadixSortSkipsSharedBytes)
+{
+    // Only the lowest byte differs, one scatter pass runs and the result has to land back in the items
+    std::vector<RenderItem> items;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        items.push_back({ 0xABCD000000000000ull | ((i * 37) % 7), i });
+    }
+    CHECK(MatchesStableSort(items));
+
+    // Only the top byte differs
+    items.clear();
+    for (size_t i = 0; i < 300; ++i)
+    {
+        items.push_back({ (static_cast<uint64_t>((i * 11) % 5) << 56) | 0x1234, i });
+    }
+    CHECK(MatchesStableSort(items));
+
+    // Nothing differs, no pass runs and the order is untouched
+    items.assign(50, RenderItem{ 42, 0 });
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        items[i].objectIndex = i;
+    }
+    std::vector<RenderItem> buffer;
+    RadixSortRenderItems(items, buffer);
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        CHECK(items[i].objectIndex == i);
+    }
+}
+
+TEST(DepthKeysOrderByPass)
+{
+    CHECK(MakeRenderSortKey(RenderPass::Opaque, 0, 0, 0, 1.0f) < MakeRenderSortKey(RenderPass::Opaque, 0, 0, 0, 100.0f));
+    CHECK(MakeRenderSortKey(RenderPass::Blended, 0, 0, 0, 100.0f) < MakeRenderSortKey(RenderPass::Blended, 0, 0, 0, 1.0f));
+    CHECK(MakeRenderSortKey(RenderPass::Opaque, 4095, 4095, 4095, 1e30f) < MakeRenderSortKey(RenderPass::Blended, 0, 0, 0, 1e30f));
+    // Negative depths clamp to the camera plane
+    CHECK(MakeRenderSortKey(RenderPass::Opaque, 0, 0, 0, -5.0f) == MakeRenderSortKey(RenderPass::Opaque, 0, 0, 0, 0.0f));
+}
@@ -0,0 +1,156 @@
+#include "Test.h"
+
+#include <string>
+
+#include "StateFilteringContext.h"
+
+namespace
+{
+    // Stands in for the device context, writes down every call that reaches it with the slots it covers
+    struct RecordingContext
+    {
+        void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) { calls.push_back("IASetPrimitiveTopology"); }
+        void IASetInputLayout(ID3D11InputLayout*) { calls.push_back("IASetInputLayout"); }
+        void IASetVertexBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const*, const UINT*, const UINT*) { Record("IASetVertexBuffers", aStartSlot, aCount); }
+        void IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) { calls.push_back("IASetIndexBuffer"); }
+        void VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) { calls.push_back("VSSetShader"); }
+        void PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) { calls.push_back("PSSetShader"); }
+        void VSSetConstantBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const*) { Record("VSSetConstantBuffers", aStartSlot, aCount); }
+        void PSSetConstantBuffers(UINT aStartSlot, UINT aCount, ID3D11Buffer* const*) { Record("PSSetConstantBuffers", aStartSlot, aCount); }
+        void PSSetShaderResources(UINT aStartSlot, UINT aCount, ID3D11ShaderResourceView* const*) { Record("PSSetShaderResources", aStartSlot, aCount); }
+        void PSSetSamplers(UINT aStartSlot, UINT aCount, ID3D11SamplerState* const*) { Record("PSSetSamplers", aStartSlot, aCount); }
+        void RSSetState(ID3D11RasterizerState*) { calls.push_back("RSSetState"); }
+        void OMSetBlendState(ID3D11BlendState*, const FLOAT*, UINT) { calls.push_back("OMSetBlendState"); }
+        void OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) { calls.push_back("OMSetDepthStencilState"); }
+        void OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) { calls.push_back("OMSetRenderTargets"); }
+        void DrawIndexed(UINT, UINT, INT) { calls.push_back("DrawIndexed"); }
+        void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) { calls.push_back("DrawIndexedInstanced"); }
+
+        void Record(const char* aName, UINT aStartSlot, UINT aCount)
+        {
+            calls.push_back(std::string(aName) + " " + std::to_string(aStartSlot) + "+" + std::to_string(aCount));
+        }
+
+        std::vector<std::string> calls;
+    };
+
+    template <class T>
+    T* MakeHandle(size_t anId)
+    {
+        return reinterpret_cast<T*>(anId * 16);
+    }
+}
+
+TEST(RepeatedBindsAreDropped)
+{
+    RecordingContext recording;
+    StateFilteringContext<RecordingContext> context;
+    context.SetContext(&recording);
+
+    ID3D11RasterizerState* rasterizer = MakeHandle<ID3D11RasterizerState>(1);
+    context.RSSetState(rasterizer);
+    context.RSSetState(rasterizer);
+    context.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context.VSSetShader(MakeHandle<ID3D11VertexShader>(2), nullptr, 0);
+    context.VSSetShader(MakeHandle<ID3D11VertexShader>(2), nullptr, 0);
+    context.IASetIndexBuffer(MakeHandle<ID3D11Buffer>(3), DXGI_FORMAT_R32_UINT, 0);
+    context.IASetIndexBuffer(MakeHandle<ID3D11Buffer>(3), DXGI_FORMAT_R16_UINT, 0);
+    // The index format is part of the binding
+    CHECK(recording.calls.size() == 5);
+
+    // A null blend factor is all ones, so both spellings are the same binding
+    const FLOAT ones[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    context.OMSetBlendState(nullptr, nullptr, ~0u);
+    context.OMSetBlendState(nullptr, ones, ~0u);
+    CHECK(recording.calls.size() == 6);
+
+    // Changing the value goes through, and so does everything after Invalidate
+    context.RSSetState(nullptr);
+    CHECK(recording.calls.size() == 7);
+    context.Invalidate();
+    context.RSSetState(nullptr);
+    CHECK(recording.calls.size() == 8);
+    CHECK(recording.calls.back() == "RSSetState");
+}
+
+TEST(MultiSlotCallsAreTrimmedToChanges)
+{
+    RecordingContext recording;
+    StateFilteringContext<RecordingContext> context;
+    context.SetContext(&recording);
+
+    ID3D11ShaderResourceView* views[16];
+    for (size_t i = 0; i < 16; ++i)
+    {
+        views[i] = MakeHandle<ID3D11ShaderResourceView>(i + 1);
+    }
+    context.PSSetShaderResources(0, 16, views);
+    context.PSSetShaderResources(0, 16, views);
+    views[12] = nullptr;
+    context.PSSetShaderResources(0, 16, views);
+    CHECK(recording.calls.size() == 2);
+    CHECK(recording.calls[0] == "PSSetShaderResources 0+16");
+    CHECK(recording.calls[1] == "PSSetShaderResources 12+1");
+
+    // Calls reaching past the tracked slots go through whole and leave the overlapped slots unknown
+    ID3D11Buffer* buffers[2] = { MakeHandle<ID3D11Buffer>(1), MakeHandle<ID3D11Buffer>(2) };
+    const UINT strides[2] = { 24, 64 };
+    const UINT offsets[2] = {};
+    context.IASetVertexBuffers(3, 2, buffers, strides, offsets);
+    context.IASetVertexBuffers(3, 1, buffers, strides, offsets);
+    context.IASetVertexBuffers(3, 1, buffers, strides, offsets);
+    CHECK(recording.calls.size() == 4);
+    CHECK(recording.calls[2] == "IASetVertexBuffers 3+2");
+    CHECK(recording.calls[3] == "IASetVertexBuffers 3+1");
+}
+
+TEST(RenderTargetChangesForgetShaderResources)
+{
+    RecordingContext recording;
+    StateFilteringContext<RecordingContext> context;
+    context.SetContext(&recording);
+
+    ID3D11ShaderResourceView* reflection = MakeHandle<ID3D11ShaderResourceView>(1);
+    ID3D11SamplerState* sampler = MakeHandle<ID3D11SamplerState>(2);
+    context.PSSetShaderResources(12, 1, &reflection);
+    context.PSSetSamplers(0, 1, &sampler);
+
+    // The runtime may have unbound the view when it became a target, so binding it again has to reach the context
+    context.OMSetRenderTargets(0, nullptr, nullptr);
+    context.PSSetShaderResources(12, 1, &reflection);
+    CHECK(recording.calls.back() == "PSSetShaderResources 12+1");
+
+    // Samplers can't alias a target and stay known
+    const size_t callCount = recording.calls.size();
+    context.PSSetSamplers(0, 1, &sampler);
+    CHECK(recording.calls.size() == callCount);
+}
+
+TEST(StatsCountIssuedAndFilteredCalls)
+{
+    RecordingContext recording;
+    StateFilteringContext<RecordingContext> context;
+    context.SetContext(&recording);
+
+    ID3D11PixelShader* shader = MakeHandle<ID3D11PixelShader>(1);
+    context.PSSetShader(shader, nullptr, 0);
+    context.PSSetShader(shader, nullptr, 0);
+    context.PSSetShader(shader, nullptr, 0);
+    ID3D11Buffer* constants = MakeHandle<ID3D11Buffer>(2);
+    context.PSSetConstantBuffers(1, 1, &constants);
+    context.PSSetConstantBuffers(1, 1, &constants);
+    context.OMSetRenderTargets(0, nullptr, nullptr);
+    context.ForgetConstantBuffers(1, 1);
+    context.PSSetConstantBuffers(1, 1, &constants);
+    // Draws aren't state calls
+    context.DrawIndexed(3, 0, 0);
+
+    CHECK(context.GetStats().issuedCalls == 5);
+    CHECK(context.GetStats().filteredCalls == 3);
+    CHECK(recording.calls.size() == 5);
+
+    context.ResetStats();
+    CHECK(context.GetStats().issuedCalls == 0);
+    CHECK(context.GetStats().filteredCalls == 0);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Just enough of a test framework for the engine code that runs without a device. Every TEST registers itself,
+// RunTests runs them in file order and returns non-zero when a CHECK failed
+
+struct TestCase
+{
+    const char* name;
+    void (*function)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+inline int& GetFailedCheckCount()
+{
+    static int failedChecks = 0;
+    return failedChecks;
+}
+
+struct TestRegistration
+{
+    TestRegistration(const char* aName, void (*aFunction)())
+    {
+        GetTestCases().push_back({ aName, aFunction });
+    }
+};
+
+inline void ReportFailedCheck(const char* aFile, int aLine, const char* anExpression)
+{
+    std::fprintf(stderr, "%s(%d): CHECK failed: %s\n", aFile, aLine, anExpression);
+    ++GetFailedCheckCount();
+}
+
+inline int RunTests()
+{
+    int failedTests = 0;
+    for (const TestCase& testCase : GetTestCases())
+    {
+        const int failedChecksBefore = GetFailedCheckCount();
+        testCase.function();
+        const bool passed = GetFailedCheckCount() == failedChecksBefore;
+        std::printf("%s %s\n", passed ? "[ OK ]" : "[FAIL]", testCase.name);
+        failedTests += passed ? 0 : 1;
+    }
+    std::printf("%zu tests, %d failed\n", GetTestCases().size(), failedTests);
+    return failedTests == 0 ? 0 : 1;
+}
+
+#define TEST(aName) \
+    static void aName(); \
+    static const TestRegistration aName##Registration(#aName, &aName); \
+    static void aName()
+
+#define CHECK(anExpression) \
+    do { if (!(anExpression)) ReportFailedCheck(__FILE__, __LINE__, #anExpression); } while (false)
+
+#define CHECK_NEAR(aValue, anExpected, aTolerance) \
+    do { if (!(std::fabs((aValue) - (anExpected)) <= (aTolerance))) ReportFailedCheck(__FILE__, __LINE__, #aValue " near " #anExpected); } while (false)
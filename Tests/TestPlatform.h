@@ -0,0 +1,13 @@
+#pragma once
+// Included ahead of every test source, the engine headers expect what windows.h declares to already be there
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdio>
+
+// Matrix4x4 reports singular inverses through the debugger output
+inline void OutputDebugStringA(const char* aMessage)
+{
+    std::fputs(aMessage, stderr);
+}
+#endif
@@ -0,0 +1,84 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkerPool.h"
+
+TEST(EveryIndexIsVisitedOnce)
+{
+    WorkerPool pool(3);
+    const int counts[] = { 1, 2, 3, 4, 5, 7, 100, 1001 };
+    for (int count : counts)
+    {
+        std::vector<int> visits(count, 0);
+        pool.ParallelFor(0, count, [&visits](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                ++visits[i];
+            }
+        });
+
+        bool allOnce = true;
+        for (int visit : visits)
+        {
+            allOnce = allOnce && visit == 1;
+        }
+        CHECK(allOnce);
+    }
+}
+
+TEST(EmptyRangeCallsNothing)
+{
+    WorkerPool pool(3);
+    bool called = false;
+    pool.ParallelFor(5, 5, [&called](int, int) { called = true; });
+    pool.ParallelFor(5, 2, [&called](int, int) { called = true; });
+    CHECK(!called);
+}
+
+TEST(WorkersAreReusedAcrossJobs)
+{
+    // Frame after frame on the same threads, a job only returns once all of its ranges are done
+    WorkerPool pool(3);
+    CHECK(pool.GetThreadCount() == 4);
+
+    std::vector<std::thread::id> seenThreads;
+    std::mutex seenMutex;
+    for (int frame = 0; frame < 500; ++frame)
+    {
+        std::atomic<int> sum{ 0 };
+        pool.ParallelFor(0, 64, [&](int aFirst, int aLast)
+        {
+            for (int i = aFirst; i < aLast; ++i)
+            {
+                sum += i;
+            }
+            std::lock_guard<std::mutex> lock(seenMutex);
+            if (std::find(seenThreads.begin(), seenThreads.end(), std::this_thread::get_id()) == seenThreads.end())
+            {
+                seenThreads.push_back(std::this_thread::get_id());
+            }
+        });
+        CHECK(sum == 64 * 63 / 2);
+    }
+    CHECK(seenThreads.size() <= pool.GetThreadCount());
+}
+
+TEST(WithoutWorkersTheCallerDoesEverything)
+{
+    WorkerPool pool(0);
+    CHECK(pool.GetThreadCount() == 1);
+
+    int calls = 0;
+    pool.ParallelFor(0, 10, [&calls](int aFirst, int aLast)
+    {
+        CHECK(aFirst == 0 && aLast == 10);
+        ++calls;
+    });
+    CHECK(calls == 1);
+}
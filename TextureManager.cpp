@@ -217,6 +217,40 @@ bool TextureManager::GenerateAndLoadNoiseTexture(const std::string& aName, int w
     myTextures[aName] = noiseTextureSRV;
     return true;
 }
+bool TextureManager::CreateTextureFromMemory(const std::string& aName, const void* someData, int aWidth, int aHeight, DXGI_FORMAT aFormat, UINT aBytesPerPixel)
+{
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = aWidth;
+    textureDesc.Height = aHeight;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = aFormat;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = someData;
+    initData.SysMemPitch = aWidth * aBytesPerPixel;
+
+    ComPtr<ID3D11Texture2D> texture;
+    HRESULT hr = myDevice->CreateTexture2D(&textureDesc, &initData, &texture);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create texture from memory: " << aName << "\n";
+        return false;
+    }
+
+    ComPtr<ID3D11ShaderResourceView> srv;
+    hr = myDevice->CreateShaderResourceView(texture.Get(), nullptr, &srv);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    myTextures[aName] = srv;
+    return true;
+}
 ID3D11ShaderResourceView* TextureManager::GetTexture(const std::string& aName) const
 {
     auto it = myTextures.find(aName);
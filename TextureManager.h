@@ -13,6 +13,7 @@ public:
 
     bool LoadTexture(const std::string& aName, const std::string& aFilename);
     bool GenerateAndLoadNoiseTexture(const std::string& aName, int width, int height, float scale);
+    bool CreateTextureFromMemory(const std::string& aName, const void* someData, int aWidth, int aHeight, DXGI_FORMAT aFormat, UINT aBytesPerPixel);
 
     ID3D11ShaderResourceView* GetTexture(const std::string& aName) const;
     bool LoadCubemap(const std::string& aName, const std::string& aFilename);
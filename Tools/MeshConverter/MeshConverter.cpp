@@ -0,0 +1,209 @@
+// Offline converter from OBJ/glTF to the engine's binary mesh format (MeshFile.h). Builds without the D3D headers:
+//   g++ -std=c++17 -O2 -pthread -I../.. -I<directory holding Includes/> MeshConverter.cpp ../../MeshFile.cpp ../../MeshImporter.cpp
+//       ../../MeshOptimizer.cpp ../../MeshSimplifier.cpp ../../MeshTangents.cpp -o meshconverter
+// Usage:
+//   meshconverter <input.obj|.gltf|.glb> <output.mesh> [--layout standard|compressed|position-texcoord] [--lods <count>] [--no-optimize]
+// Space, winding and missing normals/tangents are handled by the importer, see MeshImporter.h. --lods adds that many
+// simplified levels sharing the vertices (default 4, 0 for none), see MeshSimplifier.h. The compressed layout quantizes
+// positions to the bounds in the header and packs the rest (VertexEncoding.h), 24 bytes per vertex instead of 72.
+// Indices are written as 16 bit whenever the mesh allows it.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MeshFile.h"
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Vertex.h"
+#include "VertexEncoding.h"
+
+namespace
+{
+    struct LayoutAttribute
+    {
+        const char* semantic;
+        MeshElementFormat format;
+        uint32_t size;
+        void (*write)(const Vertex& aVertex, const PositionQuantization& aQuantization, unsigned char* aDestination);
+    };
+
+    // Copies aFloatCount floats starting at anOffset in Vertex
+    template <size_t anOffset, size_t aFloatCount>
+    void WriteFloats(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination)
+    {
+        std::memcpy(aDestination, reinterpret_cast<const unsigned char*>(&aVertex) + anOffset, aFloatCount * sizeof(float));
+    }
+
+    void WriteQuantizedPosition(const Vertex& aVertex, const PositionQuantization& aQuantization, unsigned char* aDestination)
+    {
+        EncodeQuantizedPosition(aVertex, aQuantization, aDestination);
+    }
+    void WritePackedColor(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedColor(aVertex, aDestination); }
+    void WriteHalfTexCoord(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodeHalfTexCoord(aVertex, aDestination); }
+    void WritePackedNormal(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedNormal(aVertex, aDestination); }
+    void WritePackedTangent(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedTangent(aVertex, aDestination); }
+
+    // Same element order and packing as StandardVertexFormat, CompressedVertexFormat and PositionTexCoordVertexFormat in VertexFormat.h
+    const std::vector<LayoutAttribute> locStandardLayout =
+    {
+        { "POSITION", MeshElementFloat3, 3 * sizeof(float), &WriteFloats<offsetof(Vertex, x), 3> },
+        { "COLOR", MeshElementFloat4, 4 * sizeof(float), &WriteFloats<offsetof(Vertex, r), 4> },
+        { "TEXCOORD", MeshElementFloat2, 2 * sizeof(float), &WriteFloats<offsetof(Vertex, u), 2> },
+        { "NORMAL", MeshElementFloat3, 3 * sizeof(float), &WriteFloats<offsetof(Vertex, nx), 3> },
+        { "TANGENT", MeshElementFloat3, 3 * sizeof(float), &WriteFloats<offsetof(Vertex, tx), 3> },
+        { "BITANGENT", MeshElementFloat3, 3 * sizeof(float), &WriteFloats<offsetof(Vertex, bx), 3> }
+    };
+    const std::vector<LayoutAttribute> locCompressedLayout =
+    {
+        { "POSITION", MeshElementUnorm16x4, 4 * sizeof(uint16_t), &WriteQuantizedPosition },
+        { "COLOR", MeshElementUnorm8x4, sizeof(uint32_t), &WritePackedColor },
+        { "TEXCOORD", MeshElementHalf2, 2 * sizeof(uint16_t), &WriteHalfTexCoord },
+        { "NORMAL", MeshElementUnorm1010102, sizeof(uint32_t), &WritePackedNormal },
+        { "TANGENT", MeshElementUnorm1010102, sizeof(uint32_t), &WritePackedTangent }
+    };
+    const std::vector<LayoutAttribute> locPositionTexCoordLayout =
+    {
+        { "POSITION", MeshElementFloat3, 3 * sizeof(float), &WriteFloats<offsetof(Vertex, x), 3> },
+        { "TEXCOORD", MeshElementFloat2, 2 * sizeof(float), &WriteFloats<offsetof(Vertex, u), 2> }
+    };
+
+    MeshFileData BuildMeshFileData(const std::vector<Vertex>& someVertices, const std::vector<UINT>& someIndices, const std::vector<LayoutAttribute>& aLayout)
+    {
+        MeshFileData data;
+        for (const LayoutAttribute& attribute : aLayout)
+        {
+            data.elements.push_back(MakeMeshFileElement(attribute.semantic, attribute.format, data.vertexStride));
+            data.vertexStride += attribute.size;
+        }
+
+        if (!someVertices.empty())
+        {
+            std::copy(&someVertices[0].x, &someVertices[0].x + 3, data.boundsMin);
+            std::copy(&someVertices[0].x, &someVertices[0].x + 3, data.boundsMax);
+        }
+        for (const Vertex& vertex : someVertices)
+        {
+            const float position[3] = { vertex.x, vertex.y, vertex.z };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                data.boundsMin[axis] = std::min(data.boundsMin[axis], position[axis]);
+                data.boundsMax[axis] = std::max(data.boundsMax[axis], position[axis]);
+            }
+            data.boundingRadius = std::max(data.boundingRadius, std::sqrt(vertex.x * vertex.x + vertex.y * vertex.y + vertex.z * vertex.z));
+        }
+
+        // Quantized to the same bounds the header stores, GeometryRegistry::AcquireFile decodes with those
+        const PositionQuantization quantization = ComputePositionQuantization(someVertices);
+        data.vertices.resize(someVertices.size() * data.vertexStride);
+        unsigned char* destination = data.vertices.data();
+        for (const Vertex& vertex : someVertices)
+        {
+            for (size_t i = 0; i < aLayout.size(); ++i)
+            {
+                aLayout[i].write(vertex, quantization, destination + data.elements[i].offset);
+            }
+            destination += data.vertexStride;
+        }
+        data.indices.assign(someIndices.begin(), someIndices.end());
+        return data;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: meshconverter <input.obj|.gltf|.glb> <output.mesh> [--layout standard|compressed|position-texcoord] [--lods <count>] [--no-optimize]"
+            << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::string inputPath = argv[1];
+    const std::string outputPath = argv[2];
+    const std::vector<LayoutAttribute>* layout = &locStandardLayout;
+    bool optimize = true;
+    MeshSimplifySettings simplifySettings;
+    simplifySettings.levelCount = 4;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--layout" && i + 1 < argc)
+        {
+            const std::string name = argv[++i];
+            if (name == "standard")
+            {
+                layout = &locStandardLayout;
+            }
+            else if (name == "compressed")
+            {
+                layout = &locCompressedLayout;
+            }
+            else if (name == "position-texcoord")
+            {
+                layout = &locPositionTexCoordLayout;
+            }
+            else
+            {
+                std::cerr << "Unknown layout: " << name << std::endl;
+                return 1;
+            }
+        }
+        else if (argument == "--lods" && i + 1 < argc)
+        {
+            simplifySettings.levelCount = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (argument == "--no-optimize")
+        {
+            optimize = false;
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<UINT> indices;
+    MeshImportStats importStats;
+    if (!ImportMesh(inputPath, vertices, indices, &importStats))
+    {
+        return 1;
+    }
+    std::cout << "Imported " << importStats.triangleCount << " triangles, " << importStats.cornerCount << " corners merged into "
+        << importStats.vertexCount << " vertices in " << importStats.totalMilliseconds << " ms (" << importStats.readMilliseconds << " ms reading)"
+        << (importStats.generatedNormals ? ", generated normals" : "") << (importStats.generatedTangents ? ", generated tangents" : "") << std::endl;
+
+    std::vector<MeshLod> lods = SimplifyMeshLods(vertices, indices, simplifySettings);
+    for (size_t level = 0; level < lods.size(); ++level)
+    {
+        std::cout << "Level " << level << ": " << lods[level].indexCount / 3 << " triangles, up to " << lods[level].maxScreenSize << " pixels" << std::endl;
+    }
+
+    if (optimize)
+    {
+        const MeshOptimizationStats stats = OptimizeSharedLods(vertices, indices, lods);
+        std::cout << "ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << ", " << stats.removedVertices << " unused vertices removed" << std::endl;
+    }
+
+    MeshFileData data = BuildMeshFileData(vertices, indices, *layout);
+    data.lods = lods;
+    if (!WriteMeshFile(outputPath, data))
+    {
+        return 1;
+    }
+    std::cout << "Wrote " << outputPath << ": " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles" << std::endl;
+    return 0;
+}
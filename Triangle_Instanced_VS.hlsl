@@ -0,0 +1,53 @@
+cbuffer FrameBuffer : register(b0)
+{
+    float4x4 worldToClipMatrix;
+    float time;
+    float padding1;
+    float padding2;
+    float padding3;
+}
+
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float2 uv : TEXCOORD0;
+    float4 instanceRow0 : INSTANCE_TRANSFORM0; // Rows of the CPU side world matrix, one draw covers every instance
+    float4 instanceRow1 : INSTANCE_TRANSFORM1;
+    float4 instanceRow2 : INSTANCE_TRANSFORM2;
+    float4 instanceRow3 : INSTANCE_TRANSFORM3;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 worldPosition : POSITION;
+    float4 color : COLOR;
+    float2 uv : TEXCOORD0;
+    float3 normal : NORMAL;
+    float3 tangent : TANGENT;
+    float3 bitangent : BITANGENT;
+};
+
+PixelInputType main(VertexInputType input)
+{
+    PixelInputType output;
+
+    // Built from rows, so it multiplies from the right where the transposed cbuffer matrix multiplies from the left
+    float4x4 instanceToWorld = float4x4(input.instanceRow0, input.instanceRow1, input.instanceRow2, input.instanceRow3);
+
+    // Transform position
+    float4 vertexObjectPos = input.position;
+    float4 vertexWorldPos = mul(vertexObjectPos, instanceToWorld);
+    float4 vertexClipPos = mul(worldToClipMatrix, vertexWorldPos);
+
+    // Pass data to the pixel shader
+    output.position = vertexClipPos;
+    output.worldPosition = vertexWorldPos;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
+    output.uv = input.uv;
+    output.normal = float3(0.0f, 0.0f, 0.0f); // The pyramid carries no lighting frame
+    output.tangent = float3(0.0f, 0.0f, 0.0f);
+    output.bitangent = float3(0.0f, 0.0f, 0.0f);
+
+    return output;
+}
\ No newline at end of file
@@ -15,11 +15,7 @@ cbuffer ObjectBuffer : register(b1)
 struct VertexInputType
 {
     float4 position : POSITION;
-    float4 color : COLOR;
     float2 uv : TEXCOORD0;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
-    float3 bitangent : BITANGENT;
 };
 
 struct PixelInputType
@@ -42,19 +38,14 @@ PixelInputType main(VertexInputType input)
     float4 vertexWorldPos = mul(modelToWorld, vertexObjectPos);
     float4 vertexClipPos = mul(worldToClipMatrix, vertexWorldPos);
 
-    // Transform normal, tangent, and bitangent to world space
-    float3 normalWorld = mul((float3x3) modelToWorld, input.normal);
-    float3 tangentWorld = mul((float3x3) modelToWorld, input.tangent);
-    float3 bitangentWorld = mul((float3x3) modelToWorld, input.bitangent);
-
     // Pass data to the pixel shader
     output.position = vertexClipPos;
     output.worldPosition = vertexWorldPos;
-    output.color = input.color;
+    output.color = float4(1.0f, 1.0f, 1.0f, 1.0f);
     output.uv = input.uv;
-    output.normal = normalize(normalWorld); // Normalize the normal vector
-    output.tangent = normalize(tangentWorld); // Normalize the tangent vector
-    output.bitangent = normalize(bitangentWorld); // Normalize the bitangent vector
+    output.normal = float3(0.0f, 0.0f, 0.0f); // The pyramid carries no lighting frame
+    output.tangent = float3(0.0f, 0.0f, 0.0f);
+    output.bitangent = float3(0.0f, 0.0f, 0.0f);
 
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Vertex.h"
+
+// Compact encodings for vertex attributes, shared by VertexFormat.h and the offline mesh converter, so it stays free
+// of the D3D headers. Every encoding is one the input assembler expands to floats on its own, the shader only
+// remaps ranges (DecodePosition/DecodeUnitVector in Common.hlsli).
+
+// Positions are stored as 16 bit unorm inside the mesh bounds, the shader decodes offset + stored * scale
+struct PositionQuantization
+{
+    float offset[3] = { 0.0f, 0.0f, 0.0f };
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+inline PositionQuantization ComputePositionQuantization(const std::vector<Vertex>& someVertices)
+{
+    PositionQuantization quantization;
+    if (someVertices.empty())
+    {
+        return quantization;
+    }
+
+    float boundsMin[3] = { someVertices[0].x, someVertices[0].y, someVertices[0].z };
+    float boundsMax[3] = { someVertices[0].x, someVertices[0].y, someVertices[0].z };
+    for (const Vertex& vertex : someVertices)
+    {
+        const float position[3] = { vertex.x, vertex.y, vertex.z };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+        }
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        // Flat axes still need a scale the shader can multiply with
+        quantization.offset[axis] = boundsMin[axis];
+        quantization.scale[axis] = boundsMax[axis] > boundsMin[axis] ? boundsMax[axis] - boundsMin[axis] : 1.0f;
+    }
+    return quantization;
+}
+
+inline uint16_t EncodeUnorm16(float aValue)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(aValue, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline uint32_t EncodeUnorm8(float aValue)
+{
+    return static_cast<uint32_t>(std::lround(std::clamp(aValue, 0.0f, 1.0f) * 255.0f));
+}
+
+// IEEE half, rounded to nearest. Values past the half range clamp to its largest finite value, tiny ones flush to zero
+inline uint16_t EncodeHalf(float aValue)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude > 0x7F800000u)
+    {
+        return static_cast<uint16_t>(sign | 0x7E00u); // NaN stays NaN
+    }
+    if (magnitude >= 0x477FF000u)
+    {
+        return static_cast<uint16_t>(sign | 0x7BFFu); // Anything that would round to 65536 or more
+    }
+    if (magnitude < 0x38800000u)
+    {
+        return sign; // Below the smallest normal half
+    }
+
+    // Rebias the exponent from 127 to 15 and round the 23 bit mantissa to 10 bits, ties to even
+    const uint32_t rebiased = magnitude - 0x38000000u;
+    const uint32_t rounded = rebiased + 0x0FFFu + ((rebiased >> 13) & 1u);
+    return static_cast<uint16_t>(sign | (rounded >> 13));
+}
+
+// Unit vector in DXGI_FORMAT_R10G10B10A2_UNORM, xyz remapped from [-1, 1]. aSign goes to the two alpha bits,
+// 1 for positive and 0 for negative, the tangent uses it for the bitangent's direction
+inline uint32_t EncodeUnitVector1010102(float x, float y, float z, float aSign = 1.0f)
+{
+    auto encode = [](float aComponent) { return static_cast<uint32_t>(std::lround((std::clamp(aComponent, -1.0f, 1.0f) * 0.5f + 0.5f) * 1023.0f)); };
+    return encode(x) | (encode(y) << 10) | (encode(z) << 20) | ((aSign >= 0.0f ? 3u : 0u) << 30);
+}
+
+inline void EncodeQuantizedPosition(const Vertex& aVertex, const PositionQuantization& aQuantization, unsigned char* aDestination)
+{
+    const float position[3] = { aVertex.x, aVertex.y, aVertex.z };
+    uint16_t encoded[4] = { 0, 0, 0, 65535 }; // w decodes to 1
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        encoded[axis] = EncodeUnorm16((position[axis] - aQuantization.offset[axis]) / aQuantization.scale[axis]);
+    }
+    std::memcpy(aDestination, encoded, sizeof(encoded));
+}
+
+inline void EncodePackedColor(const Vertex& aVertex, unsigned char* aDestination)
+{
+    const uint32_t encoded = EncodeUnorm8(aVertex.r) | (EncodeUnorm8(aVertex.g) << 8) | (EncodeUnorm8(aVertex.b) << 16) | (EncodeUnorm8(aVertex.a) << 24);
+    std::memcpy(aDestination, &encoded, sizeof(encoded));
+}
+
+inline void EncodeHalfTexCoord(const Vertex& aVertex, unsigned char* aDestination)
+{
+    const uint16_t encoded[2] = { EncodeHalf(aVertex.u), EncodeHalf(aVertex.v) };
+    std::memcpy(aDestination, encoded, sizeof(encoded));
+}
+
+inline void EncodePackedNormal(const Vertex& aVertex, unsigned char* aDestination)
+{
+    const uint32_t encoded = EncodeUnitVector1010102(aVertex.nx, aVertex.ny, aVertex.nz);
+    std::memcpy(aDestination, &encoded, sizeof(encoded));
+}
+
+// The bitangent isn't stored, the shader rebuilds it as cross(normal, tangent) times the sign kept in alpha
+inline void EncodePackedTangent(const Vertex& aVertex, unsigned char* aDestination)
+{
+    const float crossX = aVertex.ny * aVertex.tz - aVertex.nz * aVertex.ty;
+    const float crossY = aVertex.nz * aVertex.tx - aVertex.nx * aVertex.tz;
+    const float crossZ = aVertex.nx * aVertex.ty - aVertex.ny * aVertex.tx;
+    const float sign = crossX * aVertex.bx + crossY * aVertex.by + crossZ * aVertex.bz < 0.0f ? -1.0f : 1.0f;
+    const uint32_t encoded = EncodeUnitVector1010102(aVertex.tx, aVertex.ty, aVertex.tz, sign);
+    std::memcpy(aDestination, &encoded, sizeof(encoded));
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <d3d11.h>
+
+#include "Vertex.h"
+#include "VertexEncoding.h"
+
+// Generators keep filling the full Vertex, a format decides which parts of it reach the GPU. Each attribute
+// knows its input layout declaration and how to copy itself out of a Vertex. Compressed attributes encode with
+// VertexEncoding.h, quantized positions need the mesh's PositionQuantization to decode.
+
+template <size_t Count>
+void WriteVertexFloats(unsigned char* aDestination, const float (&someValues)[Count])
+{
+    std::memcpy(aDestination, someValues, sizeof(someValues));
+}
+
+struct PositionAttribute
+{
+    static constexpr const char* semantic = "POSITION";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT; // The input assembler fills in w = 1
+    static constexpr UINT size = 3 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.x, aVertex.y, aVertex.z }); }
+};
+
+struct ColorAttribute
+{
+    static constexpr const char* semantic = "COLOR";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    static constexpr UINT size = 4 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.r, aVertex.g, aVertex.b, aVertex.a }); }
+};
+
+struct TexCoordAttribute
+{
+    static constexpr const char* semantic = "TEXCOORD";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32_FLOAT;
+    static constexpr UINT size = 2 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.u, aVertex.v }); }
+};
+
+struct NormalAttribute
+{
+    static constexpr const char* semantic = "NORMAL";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+    static constexpr UINT size = 3 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.nx, aVertex.ny, aVertex.nz }); }
+};
+
+struct TangentAttribute
+{
+    static constexpr const char* semantic = "TANGENT";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+    static constexpr UINT size = 3 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.tx, aVertex.ty, aVertex.tz }); }
+};
+
+struct BitangentAttribute
+{
+    static constexpr const char* semantic = "BITANGENT";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+    static constexpr UINT size = 3 * sizeof(float);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { WriteVertexFloats(aDestination, { aVertex.bx, aVertex.by, aVertex.bz }); }
+};
+
+// Compressed counterparts, 24 bytes per vertex instead of 72. Shaders read them through Common.hlsli's decode helpers
+struct QuantizedPositionAttribute
+{
+    static constexpr const char* semantic = "POSITION";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16B16A16_UNORM;
+    static constexpr UINT size = 4 * sizeof(uint16_t);
+    static void Write(const Vertex& aVertex, const PositionQuantization& aQuantization, unsigned char* aDestination)
+    {
+        EncodeQuantizedPosition(aVertex, aQuantization, aDestination);
+    }
+};
+
+struct PackedColorAttribute
+{
+    static constexpr const char* semantic = "COLOR";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    static constexpr UINT size = sizeof(uint32_t);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedColor(aVertex, aDestination); }
+};
+
+struct HalfTexCoordAttribute
+{
+    static constexpr const char* semantic = "TEXCOORD";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16_FLOAT;
+    static constexpr UINT size = 2 * sizeof(uint16_t);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodeHalfTexCoord(aVertex, aDestination); }
+};
+
+struct PackedNormalAttribute
+{
+    static constexpr const char* semantic = "NORMAL";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R10G10B10A2_UNORM;
+    static constexpr UINT size = sizeof(uint32_t);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedNormal(aVertex, aDestination); }
+};
+
+// Tangent with the bitangent's sign in alpha
+struct PackedTangentAttribute
+{
+    static constexpr const char* semantic = "TANGENT";
+    static constexpr DXGI_FORMAT format = DXGI_FORMAT_R10G10B10A2_UNORM;
+    static constexpr UINT size = sizeof(uint32_t);
+    static void Write(const Vertex& aVertex, const PositionQuantization&, unsigned char* aDestination) { EncodePackedTangent(aVertex, aDestination); }
+};
+
+namespace VertexFormatDetail
+{
+    template <class... Attributes>
+    constexpr std::array<UINT, sizeof...(Attributes)> ComputeOffsets()
+    {
+        const UINT sizes[] = { Attributes::size... };
+        std::array<UINT, sizeof...(Attributes)> offsets = {};
+        UINT offset = 0;
+        for (size_t i = 0; i < sizeof...(Attributes); ++i)
+        {
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offsets;
+    }
+
+    template <class... Attributes, size_t... Indices>
+    constexpr std::array<D3D11_INPUT_ELEMENT_DESC, sizeof...(Attributes)> MakeElements(const std::array<UINT, sizeof...(Attributes)>& someOffsets,
+        std::index_sequence<Indices...>)
+    {
+        return { { { Attributes::semantic, 0, Attributes::format, 0, someOffsets[Indices], D3D11_INPUT_PER_VERTEX_DATA, 0 }... } };
+    }
+}
+
+// Type-list of attributes, tightly packed in the order given. Stride, offsets and the input layout are all
+// known at compile time, Pack turns generated vertices into the bytes the vertex buffer expects and returns how
+// the shader gets positions back (identity unless they are quantized).
+template <class... Attributes>
+struct VertexFormat
+{
+    static_assert(sizeof...(Attributes) > 0, "A vertex format needs at least one attribute");
+
+    static constexpr bool quantizesPositions = (std::is_same_v<Attributes, QuantizedPositionAttribute> || ...);
+    static constexpr UINT elementCount = sizeof...(Attributes);
+    static constexpr UINT stride = (Attributes::size + ...);
+    static constexpr std::array<UINT, elementCount> offsets = VertexFormatDetail::ComputeOffsets<Attributes...>();
+    static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, elementCount> elements =
+        VertexFormatDetail::MakeElements<Attributes...>(offsets, std::index_sequence_for<Attributes...>());
+
+    static PositionQuantization Pack(const std::vector<Vertex>& someVertices, std::vector<unsigned char>& someBytes)
+    {
+        const PositionQuantization quantization = quantizesPositions ? ComputePositionQuantization(someVertices) : PositionQuantization();
+        someBytes.resize(someVertices.size() * stride);
+        unsigned char* destination = someBytes.data();
+        for (const Vertex& vertex : someVertices)
+        {
+            size_t attribute = 0;
+            (Attributes::Write(vertex, quantization, destination + offsets[attribute++]), ...);
+            destination += stride;
+        }
+        return quantization;
+    }
+};
+
+// What every mesh uploaded before formats existed, minus the unused position w
+using StandardVertexFormat = VertexFormat<PositionAttribute, ColorAttribute, TexCoordAttribute, NormalAttribute, TangentAttribute, BitangentAttribute>;
+// Meshes whose shaders only need a position and a texture coordinate
+using PositionTexCoordVertexFormat = VertexFormat<PositionAttribute, TexCoordAttribute>;
+// Standard attributes in compressed encodings, read by Mesh_Compressed_VS
+using CompressedVertexFormat = VertexFormat<QuantizedPositionAttribute, PackedColorAttribute, HalfTexCoordAttribute, PackedNormalAttribute, PackedTangentAttribute>;
+
+static_assert(StandardVertexFormat::stride == 72, "Standard format is expected to be tightly packed");
+static_assert(PositionTexCoordVertexFormat::stride == 20, "Position/texcoord format is expected to be tightly packed");
+static_assert(CompressedVertexFormat::stride == 24, "Compressed format is expected to be tightly packed");
+
+// Type-erased view of a format so objects can pick theirs through a virtual
+struct VertexFormatDesc
+{
+    const D3D11_INPUT_ELEMENT_DESC* elements = nullptr;
+    UINT elementCount = 0;
+    UINT stride = 0;
+    PositionQuantization (*pack)(const std::vector<Vertex>&, std::vector<unsigned char>&) = nullptr;
+};
+
+template <class Format>
+const VertexFormatDesc& GetVertexFormatDesc()
+{
+    static const VertexFormatDesc desc = { Format::elements.data(), Format::elementCount, Format::stride, &Format::Pack };
+    return desc;
+}
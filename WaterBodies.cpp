@@ -0,0 +1,149 @@
+#include "WaterBodies.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace
+{
+    struct Run
+    {
+        int firstX;
+        int lastX;
+    };
+
+    struct CellRect
+    {
+        int firstX, lastX; // Inclusive cell ranges
+        int firstZ, lastZ;
+    };
+
+    // Stacks identical runs of consecutive rows into rectangles, which turns most lakes into a handful of quads
+    std::vector<CellRect> MergeRuns(const std::vector<std::vector<Run>>& someRowRuns, int aFirstRow)
+    {
+        std::vector<CellRect> rects;
+        std::map<std::pair<int, int>, size_t> openRects;
+
+        for (size_t row = 0; row < someRowRuns.size(); ++row)
+        {
+            const int z = aFirstRow + static_cast<int>(row);
+            std::map<std::pair<int, int>, size_t> stillOpen;
+            for (const Run& run : someRowRuns[row])
+            {
+                const std::pair<int, int> key(run.firstX, run.lastX);
+                auto it = openRects.find(key);
+                if (it != openRects.end())
+                {
+                    rects[it->second].lastZ = z;
+                    stillOpen[key] = it->second;
+                }
+                else
+                {
+                    rects.push_back({ run.firstX, run.lastX, z, z });
+                    stillOpen[key] = rects.size() - 1;
+                }
+            }
+            openRects = std::move(stillOpen);
+        }
+        return rects;
+    }
+}
+
+std::vector<WaterBody> DetectWaterBodies(const Heightfield& aHeightfield, const CommonUtilities::Vector3<float>& anOrigin, float aWaterHeight)
+{
+    std::vector<WaterBody> bodies;
+    const int cellsX = aHeightfield.width - 1;
+    const int cellsZ = aHeightfield.depth - 1;
+    if (cellsX <= 0 || cellsZ <= 0)
+    {
+        return bodies;
+    }
+
+    // A cell is wet if any corner dips below the water, so the surface never misses a shoreline pixel
+    const float localWaterHeight = aWaterHeight - anOrigin.y;
+    std::vector<char> isWet(static_cast<size_t>(cellsX) * cellsZ, 0);
+    for (int z = 0; z < cellsZ; ++z)
+    {
+        for (int x = 0; x < cellsX; ++x)
+        {
+            const float lowest = std::min(std::min(aHeightfield.GetHeight(x, z), aHeightfield.GetHeight(x + 1, z)),
+                std::min(aHeightfield.GetHeight(x, z + 1), aHeightfield.GetHeight(x + 1, z + 1)));
+            isWet[z * cellsX + x] = lowest < localWaterHeight ? 1 : 0;
+        }
+    }
+
+    std::vector<int> labels(isWet.size(), -1);
+    std::vector<int> stack;
+    for (int seed = 0; seed < static_cast<int>(isWet.size()); ++seed)
+    {
+        if (!isWet[seed] || labels[seed] != -1)
+        {
+            continue;
+        }
+
+        const int label = static_cast<int>(bodies.size());
+        int minX = cellsX, maxX = -1, minZ = cellsZ, maxZ = -1;
+        int cellCount = 0;
+
+        labels[seed] = label;
+        stack.push_back(seed);
+        while (!stack.empty())
+        {
+            const int cell = stack.back();
+            stack.pop_back();
+            const int x = cell % cellsX;
+            const int z = cell / cellsX;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minZ = std::min(minZ, z); maxZ = std::max(maxZ, z);
+            ++cellCount;
+
+            const int neighbours[4][2] = { { x - 1, z }, { x + 1, z }, { x, z - 1 }, { x, z + 1 } };
+            for (const auto& neighbour : neighbours)
+            {
+                if (neighbour[0] < 0 || neighbour[0] >= cellsX || neighbour[1] < 0 || neighbour[1] >= cellsZ)
+                {
+                    continue;
+                }
+                const int index = neighbour[1] * cellsX + neighbour[0];
+                if (isWet[index] && labels[index] == -1)
+                {
+                    labels[index] = label;
+                    stack.push_back(index);
+                }
+            }
+        }
+
+        // Collect this region's runs row by row inside its bounding box
+        std::vector<std::vector<Run>> rowRuns(maxZ - minZ + 1);
+        for (int z = minZ; z <= maxZ; ++z)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                if (labels[z * cellsX + x] != label)
+                {
+                    continue;
+                }
+                const int firstX = x;
+                while (x + 1 <= maxX && labels[z * cellsX + x + 1] == label)
+                {
+                    ++x;
+                }
+                rowRuns[z - minZ].push_back({ firstX, x });
+            }
+        }
+
+        const float spacing = aHeightfield.spacing;
+        WaterBody body;
+        for (const CellRect& rect : MergeRuns(rowRuns, minZ))
+        {
+            body.rects.push_back({ anOrigin.x + rect.firstX * spacing, anOrigin.x + (rect.lastX + 1) * spacing,
+                anOrigin.z - (rect.lastZ + 1) * spacing, anOrigin.z - rect.firstZ * spacing });
+        }
+        body.cellCount = cellCount;
+        body.boundsMin = CommonUtilities::Vector3<float>(anOrigin.x + minX * spacing, aWaterHeight, anOrigin.z - (maxZ + 1) * spacing);
+        body.boundsMax = CommonUtilities::Vector3<float>(anOrigin.x + (maxX + 1) * spacing, aWaterHeight, anOrigin.z - minZ * spacing);
+        bodies.push_back(std::move(body));
+    }
+
+    return bodies;
+}
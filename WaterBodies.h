@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+
+#include "Includes/MeehanVector3.hpp"
+#include "TerrainBaker.h"
+
+struct WaterRect
+{
+    float minX, maxX; // World space extents
+    float minZ, maxZ;
+};
+
+struct WaterBody
+{
+    std::vector<WaterRect> rects;
+    int cellCount = 0;
+    CommonUtilities::Vector3<float> boundsMin; // World space
+    CommonUtilities::Vector3<float> boundsMax;
+    unsigned int startIndex = 0; // Filled in when the body is turned into geometry
+    unsigned int indexCount = 0;
+};
+
+// Flood fills the heightfield cells that have at least one corner below aWaterHeight and returns one body per
+// 4-connected region, covered by the few rectangles a row-merging pass finds. anOrigin is the heightfield's
+// world position, rows run towards -z like in Terrain::CreateGeometry.
+std::vector<WaterBody> DetectWaterBodies(const Heightfield& aHeightfield, const CommonUtilities::Vector3<float>& anOrigin, float aWaterHeight);
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int aWorkerCount)
+{
+    myWorkers.reserve(aWorkerCount);
+    for (unsigned int i = 0; i < aWorkerCount; ++i)
+    {
+        myWorkers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(myMutex);
+        myIsStopping = true;
+    }
+    myWake.notify_all();
+    for (std::thread& worker : myWorkers)
+    {
+        worker.join();
+    }
+}
+unsigned int WorkerPool::DefaultWorkerCount()
+{
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+void WorkerPool::Dispatch(int aRangeCount, RunRange aRun, const void* aJob)
+{
+    {
+        // A worker that woke up late for the previous job may still be on its way out
+        std::unique_lock<std::mutex> lock(myMutex);
+        myIdle.wait(lock, [this]() { return myActiveWorkers == 0; });
+        myRun = aRun;
+        myJob = aJob;
+        myRangeCount = aRangeCount;
+        myNextRange = 0;
+        ++myGeneration;
+    }
+    myWake.notify_all();
+
+    RunRanges(aRangeCount, aRun, aJob);
+
+    // Every range has been claimed, the ones on workers are done once those workers have left the job
+    std::unique_lock<std::mutex> lock(myMutex);
+    myIdle.wait(lock, [this]() { return myActiveWorkers == 0; });
+}
+void WorkerPool::RunRanges(int aRangeCount, RunRange aRun, const void* aJob)
+{
+    for (int range = myNextRange++; range < aRangeCount; range = myNextRange++)
+    {
+        aRun(aJob, range);
+    }
+}
+void WorkerPool::WorkerLoop()
+{
+    uint64_t takenGeneration = 0;
+    for (;;)
+    {
+        RunRange run = nullptr;
+        const void* job = nullptr;
+        int rangeCount = 0;
+        {
+            std::unique_lock<std::mutex> lock(myMutex);
+            myWake.wait(lock, [&]() { return myIsStopping || myGeneration != takenGeneration; });
+            if (myIsStopping)
+            {
+                return;
+            }
+            takenGeneration = myGeneration;
+            run = myRun;
+            job = myJob;
+            rangeCount = myRangeCount;
+            ++myActiveWorkers;
+        }
+
+        RunRanges(rangeCount, run, job);
+
+        {
+            std::lock_guard<std::mutex> lock(myMutex);
+            --myActiveWorkers;
+        }
+        myIdle.notify_all();
+    }
+}
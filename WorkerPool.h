@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads started once and parked between jobs, for work that is split up every frame where spawning threads per
+// call would cost more than the work. One-off jobs such as bakes and imports can keep using ParallelFor.
+class WorkerPool
+{
+public:
+    // aWorkerCount threads besides the caller, by default one less than the hardware threads
+    explicit WorkerPool(unsigned int aWorkerCount = DefaultWorkerCount());
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static unsigned int DefaultWorkerCount();
+    // Workers plus the calling thread
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(myWorkers.size()) + 1; }
+
+    // Same contract as ParallelFor: splits [aBegin, anEnd) into one contiguous range per thread and calls
+    // aFunction(rangeBegin, rangeEnd) for each. The caller works on ranges too and returns once all are done.
+    // Not reentrant, one job runs at a time
+    template <class Function>
+    void ParallelFor(int aBegin, int anEnd, const Function& aFunction);
+
+private:
+    using RunRange = void (*)(const void* aJob, int aRange);
+
+    void Dispatch(int aRangeCount, RunRange aRun, const void* aJob);
+    void RunRanges(int aRangeCount, RunRange aRun, const void* aJob);
+    void WorkerLoop();
+
+    std::vector<std::thread> myWorkers;
+    std::mutex myMutex;
+    std::condition_variable myWake;
+    std::condition_variable myIdle;
+    uint64_t myGeneration = 0;      // Bumped for every job, workers compare it with the last one they took
+    int myActiveWorkers = 0;        // Workers inside the current job, it can't be replaced until they have left
+    bool myIsStopping = false;
+
+    RunRange myRun = nullptr;
+    const void* myJob = nullptr;
+    int myRangeCount = 0;
+    std::atomic<int> myNextRange{ 0 };
+};
+
+template <class Function>
+void WorkerPool::ParallelFor(int aBegin, int anEnd, const Function& aFunction)
+{
+    const int count = anEnd - aBegin;
+    if (count <= 0)
+    {
+        return;
+    }
+
+    const int threadCount = std::min(count, static_cast<int>(GetThreadCount()));
+    if (threadCount == 1)
+    {
+        aFunction(aBegin, anEnd);
+        return;
+    }
+
+    const int rangeSize = (count + threadCount - 1) / threadCount;
+    const int rangeCount = (count + rangeSize - 1) / rangeSize;
+    auto runRange = [&](int aRange)
+    {
+        const int rangeBegin = aBegin + aRange * rangeSize;
+        aFunction(rangeBegin, std::min(rangeBegin + rangeSize, anEnd));
+    };
+    Dispatch(rangeCount, [](const void* aJob, int aRange) { (*static_cast<const decltype(runRange)*>(aJob))(aRange); }, &runRange);
+}
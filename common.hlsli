@@ -19,6 +19,9 @@ Texture2D noiseTexture : register(t10);
 TextureCube environmentTexture : register(t11);
 Texture2D reflectionTexture : register(t12);
 Texture2D fftWaveTexture : register(t13); // Precomputed FFT wave texture
+Texture2D sunHorizonTexture : register(t14); // Baked terrain horizon towards sunrise (r) and sunset (g)
+Texture2D terrainNormalTexture : register(t15); // Baked world space terrain normal, x in r and z in g
+Texture2D<float> reflectionDepthTexture : register(t16); // Depth of the reflection, at its own resolution
 
 SamplerState defaultSampler : register(s0);
 
@@ -31,6 +34,20 @@ struct VertexInputType
     float3 tangent : TANGENT;
     float3 bitangent : BITANGENT;
 };
+struct PositionTexCoordVertexInputType
+{
+    float4 position : POSITION;
+    float2 uv : TEXCOORD0;
+};
+// CompressedVertexFormat, the input assembler expands every element to [0, 1] floats
+struct CompressedVertexInputType
+{
+    float4 position : POSITION;     // 16 bit unorm inside the mesh bounds
+    float4 color : COLOR;           // 8 bit unorm
+    float2 uv : TEXCOORD0;          // half
+    float4 normal : NORMAL;         // 10:10:10 unorm
+    float4 tangent : TANGENT;       // 10:10:10 unorm, bitangent sign in w
+};
 struct PixelInputType
 {
     float4 position : SV_POSITION;
@@ -59,11 +76,13 @@ cbuffer FrameBuffer : register(b0)
 
     float2 resolution;
     float waterHeight;
-    float padding;
+    float hasTerrainNormals;
 }
 cbuffer ObjectBuffer : register(b1)
 {
     float4x4 modelToWorld;
+    float4 positionScale;   // Quantized positions decode to positionOffset + stored * positionScale
+    float4 positionOffset;
 }
 cbuffer LightBuffer : register(b2)
 {
@@ -75,7 +94,7 @@ cbuffer LightBuffer : register(b2)
     float ambientIntensity1;
     float ambientIntensity2;
     float renderMode;
-    float padding1;
+    float sunElevation;
 }
 
 float3 s_curve(float3 x)
@@ -102,6 +121,34 @@ float3 GerstnerWave(float3 position, float amplitude, float wavelength, float sp
     return newPosition;
 }
 
+// 1 when the sun clears the baked terrain horizon at this texel, fades to 0 when it is behind it or below the ground
+float SampleSunVisibility(float2 uv)
+{
+    float2 horizon = sunHorizonTexture.Sample(defaultSampler, uv).rg * (PI * 0.5f);
+    bool isRising = sunElevation <= PI * 0.5f;
+    float elevation = isRising ? sunElevation : PI - sunElevation;
+    float horizonAngle = isRising ? horizon.r : horizon.g;
+    return smoothstep(horizonAngle - 0.02f, horizonAngle + 0.02f, elevation);
+}
+
+// Swaps the interpolated vertex normal for the one baked from the full resolution height function
+// and keeps the tangent frame orthogonal to it, falls back to the vertex normal when no bake is bound.
+// The flag comes from the engine, a flat texel decodes to (0, 0) just like an unbound texture
+void ApplyBakedTerrainNormal(inout PixelInputType input)
+{
+    if (hasTerrainNormals == 0.0f)
+    {
+        return;
+    }
+
+    float2 bakedNormal = terrainNormalTexture.Sample(defaultSampler, input.uv).rg;
+
+    float3 normal = float3(bakedNormal.x, sqrt(saturate(1.0f - dot(bakedNormal, bakedNormal))), bakedNormal.y);
+    input.normal = normalize(normal);
+    input.tangent = normalize(input.tangent - dot(input.tangent, input.normal) * input.normal);
+    input.bitangent = cross(input.normal, input.tangent) * sign(dot(cross(input.normal, input.tangent), input.bitangent));
+}
+
 float3 tonemap_s_gamut3_cine(float3 c)
 {
     // based on Sony's s gamut3 cine
@@ -142,6 +189,22 @@ float GetLogDepth(float4 worldPosition)
     return projectionPos.z / projectionPos.w;
 }
 
+// Decoders for CompressedVertexInputType, see VertexEncoding.h for the encodings
+float4 DecodePosition(float4 storedPosition)
+{
+    return float4(positionOffset.xyz + storedPosition.xyz * positionScale.xyz, 1.0f);
+}
+
+float3 DecodeUnitVector(float4 storedVector)
+{
+    return normalize(storedVector.xyz * 2.0f - 1.0f);
+}
+
+float3 DecodeBitangent(float3 normal, float3 tangent, float4 storedTangent)
+{
+    return cross(normal, tangent) * (storedTangent.w > 0.5f ? 1.0f : -1.0f);
+}
+
 //float GetLinDepth(float4 worldPosition)
 //{
 //    float logDepth = GetLogDepth(worldPosition);